@@ -7,18 +7,57 @@ typedef enum DbdCliInstanceCommand_t {
     DBD_INSTANCE_COMMAND_HELP, // dbdconf help | dbdconf <gvdb_file>? COMMAND help
     DBD_INSTANCE_COMMAND_DUMP, // dbdconf <gvdb_file> dump <dir> | dbdconf dump <gvdb_file> <dir>
     DBD_INSTANCE_COMMAND_LIST, // dbdconf <gvdb_file> list <dir> | dbdconf list <gvdb_file> <dir>
-    DBD_INSTANCE_COMMAND_READ, // dbdconf <gvdb_file> read <key> | dbdconf read <gvdb_file> <key>
+    DBD_INSTANCE_COMMAND_READ, // dbdconf <gvdb_file> read [--raw] <key> | dbdconf read <gvdb_file> [--raw] <key>
+    DBD_INSTANCE_COMMAND_FIND, // dbdconf <gvdb_file> find [options] <pattern> | dbdconf find <gvdb_file> [options] <pattern>
+    DBD_INSTANCE_COMMAND_WATCH, // dbdconf <gvdb_file> watch | dbdconf watch <gvdb_file>
+    DBD_INSTANCE_COMMAND_DIFF, // dbdconf <gvdb_file> diff <gvdb_file> | dbdconf diff <gvdb_file> <gvdb_file>
+    DBD_INSTANCE_COMMAND_SCAN, // dbdconf scan [options] <gvdb_file|glob>...
+    DBD_INSTANCE_COMMAND_SERVE, // dbdconf serve
+    DBD_INSTANCE_COMMAND_COMPLETE, // dbdconf <gvdb_file> complete <partial> | dbdconf complete <gvdb_file> <partial>
 } DbdCliInstanceCommand;
 
+typedef enum DbdCliFindMode_t {
+    DBD_FIND_MODE_PREFIX = 0, // --prefix (default)
+    DBD_FIND_MODE_GLOB, // --glob
+    DBD_FIND_MODE_REGEX, // --regex
+} DbdCliFindMode;
+
+typedef enum DbdCliFormat_t {
+    DBD_FORMAT_DEFAULT = 0, // keyfile-like dump, plain list and value
+    DBD_FORMAT_GVARIANT_TEXT, // --format=gvariant-text
+    DBD_FORMAT_JSONL, // --format=jsonl
+    DBD_FORMAT_NUL, // --format=nul
+} DbdCliFormat;
+
+typedef enum DbdCliScanQuery_t {
+    DBD_SCAN_QUERY_STATS = 0, // --stats (default)
+    DBD_SCAN_QUERY_READ, // --read=KEY
+    DBD_SCAN_QUERY_FIND, // --find=PATTERN
+} DbdCliScanQuery;
+
 typedef struct DbdCliInstance_t {
     DbdCliInstanceCommand command;
     const gchar *gvdb_file;
+    // Key/dir path, find pattern, or second GVDB file for diff.
     const gchar *path;
     // For future(write support).
     const gchar *value;
+    // Read option: write serialized value instead of text.
+    gboolean read_raw;
+    // Output format of read, list and dump.
+    DbdCliFormat format;
+    // Find options.
+    DbdCliFindMode find_mode;
+    const gchar *find_type;
+    const gchar *find_value;
+    // Scan options (find options are shared with find), paths and globs of scanned files.
+    DbdCliScanQuery scan_query;
+    guint scan_jobs;
+    GPtrArray *scan_files;
 } DbdCliInstance;
 
 DbdCliInstance* dbd_parse_args(int argc, const char** argv);
+const char *dbd_get_help_for(DbdCliInstanceCommand command);
 void dbd_free_args(DbdCliInstance* instance);
 
 #endif // DBDCONF_CLI_H
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef DBDCONF_COMPLETE_H
+#define DBDCONF_COMPLETE_H
+#include <cli.h>
+#include <svdb.h>
+
+// Completions of partial key/dir path (one full path per line, dirs end with '/').
+GString *dbd_complete(SvdbFile *file, const gchar *partial, GError **error);
+
+// Print completions of instance path (for shell completion).
+int dbd_complete_path(DbdCliInstance *instance);
+
+#endif // DBDCONF_COMPLETE_H
@@ -0,0 +1,9 @@
+#ifndef DBDCONF_FORMAT_H
+#define DBDCONF_FORMAT_H
+#include <cli.h>
+
+// Print read, list or dump result as machine-readable records (one per key, see svdb_record_append),
+// streamed straight from file lookups and walk.
+int dbd_print_records(DbdCliInstance *instance);
+
+#endif // DBDCONF_FORMAT_H
@@ -0,0 +1,8 @@
+#ifndef DBDCONF_SCAN_H
+#define DBDCONF_SCAN_H
+#include <cli.h>
+
+// Run read, find or stats query over many GVDB files (paths and globs) on thread pool, print results tagged by file.
+int dbd_scan(DbdCliInstance *instance);
+
+#endif // DBDCONF_SCAN_H
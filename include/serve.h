@@ -0,0 +1,15 @@
+#ifndef DBDCONF_SERVE_H
+#define DBDCONF_SERVE_H
+#include <cli.h>
+
+// Socket path of daemon: $DBDCONF_SOCKET, or $XDG_RUNTIME_DIR/dbdconf.sock.
+gchar *dbd_serve_socket_path(void);
+
+// Keep GVDB files mapped and parsed, and answer read/list/dump/complete requests on Unix socket (until SIGINT/SIGTERM).
+int dbd_serve(DbdCliInstance *instance);
+
+// Forward read/list/dump/complete request to running daemon and print its output.
+// Return FALSE, if there is no daemon (or it can't answer), so command must be run locally.
+gboolean dbd_serve_forward(DbdCliInstance *instance, int *status);
+
+#endif // DBDCONF_SERVE_H
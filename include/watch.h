@@ -0,0 +1,13 @@
+#ifndef DBDCONF_WATCH_H
+#define DBDCONF_WATCH_H
+#include <cli.h>
+#include <svdb.h>
+
+// Print key difference (see SvdbDiffFunc) as tab-separated line.
+gboolean dbd_print_change(const gchar *key, SvdbDiffKind kind, GVariant *old_value, GVariant *new_value,
+                          gpointer user_data);
+
+// Watch GVDB file and print added, removed and changed keys on every change (until SIGINT/SIGTERM).
+int dbd_watch(DbdCliInstance *instance);
+
+#endif // DBDCONF_WATCH_H
@@ -18,9 +18,15 @@
 /// @brief Get type function for GIR and Typelib.
 GType svdb_table_get_type(void);
 
+/// @brief Get type function for GIR and Typelib.
+GType svdb_file_get_type(void);
+
 /// @brief Item of GVDB table.
 typedef struct SvdbTableItem_t SvdbTableItem;
 
+/// @brief Read-only GVDB file, values are looked up directly in file hash tables (without parsing whole file).
+typedef struct SvdbFile_t SvdbFile;
+
 /// @brief List element of List Item in DVDB table.
 typedef struct SvdbListElement_t {
     gchar *key;
@@ -40,10 +46,143 @@ typedef enum SvdbItemType {
 } SvdbItemType;
 
 
+/// @brief Iterator over table or list elements. Allocated on stack, doesn't allocate memory.
+typedef struct SvdbIter_t {
+    /*< private >*/
+    const SvdbTableItem *item;
+    GHashTableIter table_iter;
+    gsize index;
+} SvdbIter;
+
+/// @brief Callback for svdb_item_foreach.
+/// @param key - element key (borrowed).
+/// @param value - element item (borrowed).
+/// @param user_data - user data.
+/// @return TRUE to continue, FALSE to stop.
+typedef gboolean (*SvdbForeachFunc)(const gchar *key, SvdbTableItem *value, gpointer user_data);
+
 /// @brief Create new table item.
 /// @return new table item.
 SvdbTableItem *svdb_table_new(void);
 
+/// @brief Bulk builder of dconf tree (root table with "/" list, dirs are nested lists).
+/// Items are appended without ancestor walks, and child counters are computed once in svdb_tree_builder_finish.
+typedef struct SvdbTreeBuilder_t SvdbTreeBuilder;
+
+/// @brief Create new tree builder.
+/// @return new builder (free with svdb_tree_builder_finish or svdb_tree_builder_free).
+SvdbTreeBuilder *svdb_tree_builder_new(void);
+
+/// @brief Add value into tree. Parent dirs are created if needed, value of already added key is replaced.
+/// @param builder - current builder.
+/// @param path - key path (must start with '/' and doesn't end with '/').
+/// @param value - key value (floating reference is sunk).
+/// @param error - set value to error, if path is invalid.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_tree_builder_add(SvdbTreeBuilder *builder, const gchar *path, GVariant *value, GError **error);
+
+/// @brief Finish building and free builder.
+/// @param builder - current builder.
+/// @return built root table (free with svdb_item_unref).
+SvdbTableItem *svdb_tree_builder_finish(SvdbTreeBuilder *builder);
+
+/// @brief Free builder with built tree.
+/// @param builder - current builder.
+void svdb_tree_builder_free(SvdbTreeBuilder *builder);
+
+/// @brief Freeze tree in place: it can't be changed after it (mutating functions return FALSE), and it can be read
+/// from many threads. Frozen tree is a snapshot for svdb_tree_set.
+/// @param table - root table (item without parent).
+/// @return table (new reference), or NULL if table isn't root table.
+SvdbTableItem *svdb_tree_freeze(SvdbTableItem *table);
+
+/// @brief Check if item is a part of frozen tree.
+/// @param item - current item.
+/// @return TRUE if item is frozen, else FALSE.
+gboolean svdb_item_is_frozen(const SvdbTableItem *item);
+
+/// @brief Create new snapshot with changed key. Only lists on key path are copied, all other subtrees are shared
+/// with old snapshot, which stays valid and unchanged.
+/// @param snapshot - frozen root table (see svdb_tree_freeze).
+/// @param path - key path (must start with '/' and doesn't end with '/').
+/// @param value - new key value (floating reference is sunk), or NULL to remove key.
+/// @param error - set value to error, if snapshot isn't frozen, path is invalid or some dir on path isn't list.
+/// @return new frozen root table (free with svdb_item_unref), or NULL.
+SvdbTableItem *svdb_tree_set(const SvdbTableItem *snapshot, const gchar *path, GVariant *value, GError **error);
+
+/// @brief Convert whole subtree into one GVariant (e.g. to get it through language bindings in one call).
+/// Variant item is `v` (its value), table is `a{sv}` (sorted by key), list is `a(sv)` (in list order), values of
+/// table and list elements are variants of child items.
+/// @param item - current item.
+/// @return new variant (free with g_variant_unref), or NULL if item is NULL or has no type.
+GVariant *svdb_item_to_variant(const SvdbTableItem *item);
+
+/// @brief Create subtree from GVariant of svdb_item_to_variant format.
+/// @param variant - subtree variant (floating reference is sunk).
+/// @param error - set value to error, if variant has invalid type, duplicate keys or too deep nesting.
+/// @return new item (free with svdb_item_unref), or NULL.
+SvdbTableItem *svdb_item_from_variant(GVariant *variant, GError **error);
+
+/// @brief Batch of changes of dconf tree (root table with "/" list, dirs are nested lists), which is applied
+/// atomically. Ops are grouped by dir, and every affected list is changed in one pass with hash lookups.
+typedef struct SvdbTransaction_t SvdbTransaction;
+
+/// @brief Create new transaction.
+/// @param table - changed root table.
+/// @return new transaction (free with svdb_transaction_free), or NULL if table isn't table.
+SvdbTransaction *svdb_transaction_new(SvdbTableItem *table);
+
+/// @brief Queue setting of key value (missing dirs are created on commit).
+/// @param transaction - current transaction.
+/// @param path - key path (must start with '/' and doesn't end with '/').
+/// @param value - key value (floating reference is sunk).
+/// @param error - set value to error, if path is invalid.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_transaction_set(SvdbTransaction *transaction, const gchar *path, GVariant *value, GError **error);
+
+/// @brief Queue removing of key (missing key is ignored).
+/// @param transaction - current transaction.
+/// @param path - key path (must start with '/' and doesn't end with '/').
+/// @param error - set value to error, if path is invalid.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_transaction_unset(SvdbTransaction *transaction, const gchar *path, GError **error);
+
+/// @brief Queue removing of dir with all its content (overrides earlier queued ops inside of dir).
+/// @param transaction - current transaction.
+/// @param path - dir path (must start and end with '/', and isn't "/").
+/// @param error - set value to error, if path is invalid.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_transaction_remove(SvdbTransaction *transaction, const gchar *path, GError **error);
+
+/// @brief Apply all queued ops. Ops are checked before any change, so commit rejected by check (non-list item on
+/// path of dir) doesn't change tree. If applying fails after check (internal error), dirs applied before stay changed.
+/// Transaction is empty after successful commit, failed one keeps all ops (they are idempotent, so commit can be
+/// retried, or ops can be dropped by rollback).
+/// @param transaction - current transaction.
+/// @param error - set value to error, if some dir of ops isn't list in tree.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_transaction_commit(SvdbTransaction *transaction, GError **error);
+
+/// @brief Drop all queued ops.
+/// @param transaction - current transaction.
+void svdb_transaction_rollback(SvdbTransaction *transaction);
+
+/// @brief Free transaction (queued ops aren't applied).
+/// @param transaction - current transaction.
+void svdb_transaction_free(SvdbTransaction *transaction);
+
+/// @brief Access pattern hints for mapped GVDB files.
+typedef enum SvdbLoadFlags {
+    SVDB_LOAD_NONE = 0,
+    /// @brief File is read once from start to end (full parse or dump), kernel reads ahead aggressively.
+    SVDB_LOAD_SEQUENTIAL = 1 << 0,
+    /// @brief File is used for point lookups: readahead is disabled, and only hash table index (bloom filter,
+    /// buckets and hash items) of each probed table is read in ahead.
+    SVDB_LOAD_RANDOM = 1 << 1,
+    /// @brief Read whole file into page cache on open (for hot databases), so lookups never fault on it.
+    SVDB_LOAD_POPULATE = 1 << 2,
+} SvdbLoadFlags;
+
 /// @brief Create new table item and then load into it GVDB from file.
 /// @param filename GVDB layer file path.
 /// @param trusted is trusted GVariant parse.
@@ -51,6 +190,32 @@ SvdbTableItem *svdb_table_new(void);
 /// @return new table item, or NULL.
 SvdbTableItem *svdb_table_read_from_file(const gchar *filename, gboolean trusted, GError **error);
 
+/// @brief Create new table item and then load into it GVDB from file, mapped with given access hints
+/// (svdb_table_read_from_file uses SVDB_LOAD_SEQUENTIAL).
+/// @param filename GVDB layer file path.
+/// @param trusted is trusted GVariant parse.
+/// @param flags - access pattern hints.
+/// @param error handler.
+/// @return new table item, or NULL.
+SvdbTableItem *svdb_table_read_from_file_full(const gchar *filename, gboolean trusted, SvdbLoadFlags flags,
+                                              GError **error);
+
+/// @brief Load GVDB file into new table in worker thread.
+/// @param filename GVDB layer file path.
+/// @param trusted is trusted GVariant parse.
+/// @param io_priority - priority of request (G_PRIORITY_DEFAULT, etc.).
+/// @param cancellable - cancellable object, or NULL. It is checked for every parsed table item and list element.
+/// @param callback - callback, which is called in thread-default main context of caller.
+/// @param user_data - data for callback.
+void svdb_table_read_from_file_async(const gchar *filename, gboolean trusted, gint io_priority,
+                                     GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+
+/// @brief Finish loading, started by svdb_table_read_from_file_async.
+/// @param result - result passed to callback.
+/// @param error handler(G_IO_ERROR_CANCELLED, if load was cancelled).
+/// @return new table item, or NULL.
+SvdbTableItem *svdb_table_read_from_file_finish(GAsyncResult *result, GError **error);
+
 /// @brief Create new table item and then load into it GVDB from bytes.
 /// @param data GVDB layer bytes.
 /// @param trusted is trusted GVariant parse.
@@ -58,6 +223,244 @@ SvdbTableItem *svdb_table_read_from_file(const gchar *filename, gboolean trusted
 /// @return new table item, or NULL.
 SvdbTableItem *svdb_table_read_from_bytes(GBytes *bytes, gboolean trusted, GError **error);
 
+/// @brief Create new table item and then load into it GVDB from file, verifying file content only once.
+/// First load fully verifies offsets, alignment, key bounds and variant normal form, and remembers file identity and
+/// content hash in cache. Later loads of same content are parsed in trusted mode.
+/// @param filename GVDB layer file path.
+/// @param cache_file verification cache file path, or NULL (`$XDG_CACHE_HOME/dbdconf/verified`).
+/// @param error handler.
+/// @return new table item, or NULL (if file is corrupted).
+SvdbTableItem *svdb_table_read_from_file_cached(const gchar *filename, const gchar *cache_file, GError **error);
+
+/// @brief Verify GVDB bytes: all offsets, alignment, key bounds and normal form of every value.
+/// @param bytes GVDB layer bytes.
+/// @param error handler.
+/// @return TRUE if bytes can be safely parsed in trusted mode, else FALSE.
+gboolean svdb_verify_bytes(GBytes *bytes, GError **error);
+
+/// @brief Open GVDB file for lookups.
+/// @param filename GVDB layer file path.
+/// @param trusted is trusted GVariant parse.
+/// @param error handler.
+/// @return new file, or NULL.
+SvdbFile *svdb_file_new(const gchar *filename, gboolean trusted, GError **error);
+
+/// @brief Open GVDB file for lookups, mapped with given access hints (svdb_file_new uses SVDB_LOAD_RANDOM).
+/// @param filename GVDB layer file path.
+/// @param trusted is trusted GVariant parse.
+/// @param flags - access pattern hints.
+/// @param error handler.
+/// @return new file, or NULL.
+SvdbFile *svdb_file_new_full(const gchar *filename, gboolean trusted, SvdbLoadFlags flags, GError **error);
+
+/// @brief Open GVDB bytes for lookups.
+/// @param bytes GVDB layer bytes (referenced by file and by returned values).
+/// @param trusted is trusted GVariant parse.
+/// @param error handler.
+/// @return new file, or NULL.
+SvdbFile *svdb_file_new_from_bytes(GBytes *bytes, gboolean trusted, GError **error);
+
+/// @brief Increase refcounter for file.
+/// @param file - current file.
+/// @return current file.
+SvdbFile *svdb_file_ref(SvdbFile *file);
+
+/// @brief Decrease refcounter for file.
+/// @param file - current file.
+void svdb_file_unref(SvdbFile *file);
+
+/// @brief Read value by key from file root table.
+/// @param file - current file.
+/// @param key - full key name (for dconf layer it's path, like `/org/gnome/key`).
+/// @param error - set value to error, if file is corrupted.
+/// @return value (zero-copy slice of file, free with g_variant_unref), or NULL if key isn't value.
+GVariant *svdb_file_read(SvdbFile *file, const gchar *key, GError **error);
+
+/// @brief Read serialized value by key from file root table, without decoding or printing of value.
+/// Bytes are serialized GVariant of type `v` (value bytes, zero byte and type string) in host byte order,
+/// so they can be loaded by g_variant_new_from_bytes(G_VARIANT_TYPE_VARIANT, bytes, FALSE).
+/// @param file - current file.
+/// @param key - full key name (for dconf layer it's path, like `/org/gnome/key`).
+/// @param error - set value to error, if file is corrupted.
+/// @return bytes (zero-copy slice of file, unless file is byteswapped), or NULL if key isn't value.
+GBytes *svdb_file_read_raw(SvdbFile *file, const gchar *key, GError **error);
+
+/// @brief Print value like g_variant_print_string (output is byte-identical), right into string.
+/// Common dconf types (b, i, u, d, s, as) are printed without temporary strings, others by g_variant_print_string.
+/// @param value - current value.
+/// @param string - output buffer (or NULL, then new one is created).
+/// @param type_annotate - add type annotations, where type can't be inferred from text.
+/// @return output buffer.
+GString *svdb_variant_print_string(GVariant *value, GString *string, gboolean type_annotate);
+
+/// @brief Print value like g_variant_print (see svdb_variant_print_string).
+/// @param value - current value.
+/// @param type_annotate - add type annotations, where type can't be inferred from text.
+/// @return text (free with g_free).
+gchar *svdb_variant_print(GVariant *value, gboolean type_annotate);
+
+/// @brief Machine-readable record formats (one record per key, see svdb_record_append).
+typedef enum SvdbRecordFormat {
+    /// @brief `PATH<TAB>TYPE<TAB>VALUE<LF>`.
+    SVDB_RECORD_GVARIANT_TEXT = 0,
+    /// @brief JSON object per line: `{"path":PATH,"type":TYPE,"value":VALUE}` (VALUE is JSON string).
+    SVDB_RECORD_JSONL = 1,
+    /// @brief `PATH<NUL>TYPE<NUL>VALUE<NUL>`.
+    SVDB_RECORD_NUL = 2,
+} SvdbRecordFormat;
+
+/// @brief Append record of key to buffer. Value is GVariant text (see g_variant_print, without type annotations),
+/// it's printed right into buffer. Dir record (without value) has empty type and value (null in JSON).
+/// @param buffer - output buffer.
+/// @param format - record format.
+/// @param path - full key or dir path.
+/// @param value - key value, or NULL for dir.
+void svdb_record_append(GString *buffer, SvdbRecordFormat format, const gchar *path, GVariant *value);
+
+/// @brief List keys of dir children by hashed lookup of dir, without walking of other items.
+/// @param file - current file.
+/// @param dir - full dir name (for dconf layer it's path, like `/org/gnome/`).
+/// @param length - count of keys, or NULL.
+/// @param error - set value to error, if file is corrupted.
+/// @return sorted keys (dir keys end with '/', free with g_strfreev), or NULL if dir isn't list.
+gchar **svdb_file_list(SvdbFile *file, const gchar *dir, gsize *length, GError **error);
+
+/// @brief Value of file item, decoded only on request (see svdb_file_value_get_variant).
+typedef struct SvdbFileValue_t SvdbFileValue;
+
+/// @brief Event of file walk.
+typedef enum SvdbVisitEvent {
+    /// @brief Enter hash table (root table first, then nested ones). Names of nested table items start from empty.
+    SVDB_VISIT_ENTER_TABLE = 0,
+    /// @brief Enter list (dir).
+    SVDB_VISIT_ENTER_LIST = 1,
+    /// @brief Value.
+    SVDB_VISIT_VALUE = 2,
+    /// @brief Leave last entered table or list.
+    SVDB_VISIT_LEAVE = 3,
+} SvdbVisitEvent;
+
+/// @brief Result of visit callback.
+typedef enum SvdbVisitResult {
+    /// @brief Continue walk (and enter table or list).
+    SVDB_VISIT_CONTINUE = 0,
+    /// @brief Don't enter table or list (there is no LEAVE event for it).
+    SVDB_VISIT_SKIP = 1,
+    /// @brief Stop walk.
+    SVDB_VISIT_STOP = 2,
+} SvdbVisitResult;
+
+/// @brief Callback of file walk.
+/// @param event - walk event.
+/// @param name - full name of item in its table (borrowed, valid only during call), NULL for LEAVE.
+/// @param key - own key of item (suffix of name), NULL for LEAVE.
+/// @param value - value for VALUE event (valid only during call), else NULL.
+/// @param user_data - user data.
+/// @return what to do next.
+typedef SvdbVisitResult (*SvdbVisitFunc)(SvdbVisitEvent event, const gchar *name, const gchar *key,
+                                         SvdbFileValue *value, gpointer user_data);
+
+/// @brief Walk file directly over its hash tables, without building of items tree.
+/// Walk keeps only explicit stack and current name, so memory doesn't depend on file size.
+/// @param file - current file.
+/// @param func - callback.
+/// @param user_data - user data for callback.
+/// @param error - set value to error, if file is corrupted.
+/// @return TRUE if successful (or stopped by callback), else FALSE.
+gboolean svdb_file_visit(SvdbFile *file, SvdbVisitFunc func, gpointer user_data, GError **error);
+
+/// @brief Decode value (once, on first call).
+/// @param value - current value.
+/// @return value (borrowed, valid only during visit callback), or NULL if file is corrupted.
+GVariant *svdb_file_value_get_variant(SvdbFileValue *value);
+
+/// @brief Pattern syntax of svdb_file_find.
+typedef enum SvdbFindMode {
+    /// @brief Key starts with pattern.
+    SVDB_FIND_PREFIX = 0,
+    /// @brief Key matches glob pattern ('*' - any string, including '/'; '?' - any character).
+    SVDB_FIND_GLOB = 1,
+    /// @brief Key contains match of regular expression (GRegex syntax).
+    SVDB_FIND_REGEX = 2,
+} SvdbFindMode;
+
+/// @brief Callback for found value.
+/// @param key - full key name (valid only during call).
+/// @param value - value (borrowed).
+/// @param user_data - user data.
+/// @return TRUE to continue search, FALSE to stop.
+typedef gboolean (*SvdbFindFunc)(const gchar *key, GVariant *value, gpointer user_data);
+
+/// @brief Find values by key pattern (and optionally value type or value) in single walk over file (see
+/// svdb_file_visit). Only root table is searched.
+/// Subtrees, in which no key can match prefix or glob pattern, are skipped (regular expressions are tested on every
+/// key). Values are decoded only for matched keys.
+/// @param file - current file.
+/// @param pattern - key pattern (NULL <=> every key).
+/// @param mode - pattern syntax.
+/// @param type - value type filter, or NULL.
+/// @param value - value filter, or NULL.
+/// @param func - callback, called for every found value.
+/// @param user_data - user data for callback.
+/// @param error - set value to error, if pattern is invalid or file is corrupted.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_file_find(SvdbFile *file, const gchar *pattern, SvdbFindMode mode, const GVariantType *type,
+                        GVariant *value, SvdbFindFunc func, gpointer user_data, GError **error);
+
+/// @brief Kind of difference between two files.
+typedef enum SvdbDiffKind {
+    /// @brief Key is present only in new file.
+    SVDB_DIFF_ADDED = 1,
+    /// @brief Key is present only in old file.
+    SVDB_DIFF_REMOVED = 2,
+    /// @brief Key is present in both files with different values.
+    SVDB_DIFF_CHANGED = 3,
+} SvdbDiffKind;
+
+/// @brief Callback for changed key.
+/// @param key - full key name (valid only during call).
+/// @param kind - kind of change.
+/// @param old_value - value in old file (borrowed), or NULL if added.
+/// @param new_value - value in new file (borrowed), or NULL if removed.
+/// @param user_data - user data.
+/// @return TRUE to continue, FALSE to stop.
+typedef gboolean (*SvdbDiffFunc)(const gchar *key, SvdbDiffKind kind, GVariant *old_value, GVariant *new_value,
+                                 gpointer user_data);
+
+/// @brief Compare values of two files, reporting only added, removed and changed keys.
+/// Removed/added dirs are reported without lookups, equal values are compared without decoding, dirs with equal
+/// content digests (computed once and cached in file) are skipped.
+/// @param old_file - old file, or NULL (empty).
+/// @param new_file - new file, or NULL (empty).
+/// @param func - callback, called for every difference.
+/// @param user_data - user data for callback.
+/// @param error - set value to error, if file is corrupted or has nested tables (they are not supported).
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_file_diff(SvdbFile *old_file, SvdbFile *new_file, SvdbDiffFunc func, gpointer user_data,
+                        GError **error);
+
+/// @brief Key difference between two files.
+typedef struct SvdbDiffEntry_t {
+    /// @brief Full key name.
+    gchar *key;
+    SvdbDiffKind kind;
+    /// @brief Value in old file, or NULL if added.
+    GVariant *old_value;
+    /// @brief Value in new file, or NULL if removed.
+    GVariant *new_value;
+} SvdbDiffEntry;
+
+/// @brief Free diff entry.
+/// @param entry - current entry.
+void svdb_diff_entry_free(SvdbDiffEntry *entry);
+
+/// @brief Compare two files (see svdb_file_diff).
+/// @param old_file - old file, or NULL (empty).
+/// @param new_file - new file, or NULL (empty).
+/// @param error - set value to error, if file is corrupted.
+/// @return array of SvdbDiffEntry sorted by key (free with g_ptr_array_unref), or NULL.
+GPtrArray *svdb_diff(SvdbFile *old_file, SvdbFile *new_file, GError **error);
+
 /// @brief Add/set table key to value
 /// @param table - current table. If table is't table or NULL, then do nothing.
 /// @param key - key, for set.
@@ -84,20 +487,166 @@ gboolean svdb_table_unset(SvdbTableItem *table, const gchar *key);
 /// @return if successful return TRUE, else FALSE.
 gboolean svdb_table_write_to_file(SvdbTableItem *table, const gchar *filename, gboolean byteswap, GError **error);
 
-/// @brief Write table into GVDB bytes.
+/// @brief Write table into GVDB file in worker thread. File is replaced atomically, so cancelled or failed write
+/// keeps old file. Table is referenced, and it must not be changed (or read by other threads, unless it is frozen)
+/// until callback is called.
+/// @param filename GVDB layer file path(create, if does't exist).
+/// @param byteswap - byteswap GVariant values.
+/// @param io_priority - priority of request (G_PRIORITY_DEFAULT, etc.).
+/// @param cancellable - cancellable object, or NULL. It is checked for every written table item and list element.
+/// @param callback - callback, which is called in thread-default main context of caller.
+/// @param user_data - data for callback.
+void svdb_table_write_to_file_async(SvdbTableItem *table, const gchar *filename, gboolean byteswap, gint io_priority,
+                                    GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+
+/// @brief Finish writing, started by svdb_table_write_to_file_async.
+/// @param result - result passed to callback.
+/// @param error handler(G_IO_ERROR_CANCELLED, if write was cancelled).
+/// @return if successful return TRUE, else FALSE.
+gboolean svdb_table_write_to_file_finish(GAsyncResult *result, GError **error);
+
+/// @brief Write table into GVDB bytes. Items are written in key order, so equal tables give byte-identical output.
+/// Equal keys and values are stored once (see SVDB_WRITE_DEDUP).
 /// @param byteswap - byteswap GVariant values.
 /// @param error handler
 /// @return if successful return new GBytes* with GVDB, else NULL.
 GBytes *svdb_table_get_raw(SvdbTableItem *table, gboolean byteswap, GError **error);
 
+/// @brief GVDB writer options.
+typedef enum SvdbWriteFlags {
+    SVDB_WRITE_NONE = 0,
+    /// @brief Store every distinct key and normal form value once, all items point to the same bytes.
+    SVDB_WRITE_DEDUP = 1 << 0,
+    /// @brief Write every table breadth-first: hash table (header, buckets, items), then for every dir its elements
+    /// with keys and small values of its children, then large values, then nested tables (large ones are page-aligned).
+    /// Lookups under one dir touch one or two pages. Output is still deterministic (see svdb_table_get_raw_profiled).
+    SVDB_WRITE_LOCALITY = 1 << 1,
+} SvdbWriteFlags;
+
+/// @brief GVDB writer statistics.
+typedef struct SvdbWriteStats_t {
+    /// @brief Size of written file.
+    gsize size;
+    /// @brief Count of written keys, and count of stored (distinct) ones.
+    gsize n_keys;
+    gsize n_unique_keys;
+    /// @brief Count of written values, and count of stored (distinct) ones.
+    gsize n_values;
+    gsize n_unique_values;
+    /// @brief Bytes of keys and values, which aren't stored thanks to deduplication.
+    gsize saved_bytes;
+} SvdbWriteStats;
+
+/// @brief Write table into GVDB bytes with options.
+/// @param byteswap - byteswap GVariant values.
+/// @param flags - writer options.
+/// @param stats - pointer for return writer statistics (or NULL).
+/// @param error handler
+/// @return if successful return new GBytes* with GVDB, else NULL.
+GBytes *svdb_table_get_raw_full(SvdbTableItem *table, gboolean byteswap, SvdbWriteFlags flags,
+                                SvdbWriteStats *stats, GError **error);
+
+/// @brief Write table into GVDB bytes with locality layout (SVDB_WRITE_LOCALITY), ordered by access profile:
+/// dirs with profile paths (and their parent dirs) are written first, in order of profile, others breadth-first.
+/// @param byteswap - byteswap GVariant values.
+/// @param flags - writer options (SVDB_WRITE_LOCALITY is implied).
+/// @param profile - NULL-terminated hot key and dir paths (like `/org/gnome/desktop/interface/`), hottest first,
+/// or NULL.
+/// @param stats - pointer for return writer statistics (or NULL).
+/// @param error handler
+/// @return if successful return new GBytes* with GVDB, else NULL.
+GBytes *svdb_table_get_raw_profiled(SvdbTableItem *table, gboolean byteswap, SvdbWriteFlags flags,
+                                    const gchar *const *profile, SvdbWriteStats *stats, GError **error);
+
+/// @brief Copy-on-write overlay over GVDB file (dconf layer): changes are kept in small in-memory delta, reads and
+/// writes use mapped base file directly, so base file isn't parsed into items.
+typedef struct SvdbOverlay_t SvdbOverlay;
+
+/// @brief Create new overlay.
+/// @param base - base file, or NULL (empty).
+/// @return new overlay (free with svdb_overlay_free).
+SvdbOverlay *svdb_overlay_new(SvdbFile *base);
+
+/// @brief Free overlay (unwritten changes are dropped).
+/// @param overlay - current overlay.
+void svdb_overlay_free(SvdbOverlay *overlay);
+
+/// @brief Set key value (missing dirs are created on write).
+/// @param overlay - current overlay.
+/// @param path - key path (must start with '/' and doesn't end with '/').
+/// @param value - key value (floating reference is sunk).
+/// @param error - set value to error, if path is invalid or some dir on path isn't list in base file.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_overlay_set(SvdbOverlay *overlay, const gchar *path, GVariant *value, GError **error);
+
+/// @brief Remove key (missing key is ignored).
+/// @param overlay - current overlay.
+/// @param path - key path (must start with '/' and doesn't end with '/').
+/// @param error - set value to error, if path is invalid or some dir on path isn't list in base file.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_overlay_unset(SvdbOverlay *overlay, const gchar *path, GError **error);
+
+/// @brief Read key value: changed value, or value of base file (see svdb_file_read).
+/// @param overlay - current overlay.
+/// @param path - full key name.
+/// @param error - set value to error, if base file is corrupted.
+/// @return value (free with g_variant_unref), or NULL if key isn't value or is removed.
+GVariant *svdb_overlay_read(SvdbOverlay *overlay, const gchar *path, GError **error);
+
+/// @brief Write base file merged with changes into GVDB bytes. Base file is walked list by list, and keys and
+/// values of unchanged items are copied as is (without decoding), so only changed dirs are looked up.
+/// Output is the same, as svdb_table_get_raw_full of merged tree gives.
+/// @param overlay - current overlay.
+/// @param byteswap - byteswap GVariant values.
+/// @param flags - writer options (SVDB_WRITE_LOCALITY is ignored).
+/// @param stats - pointer for return writer statistics (or NULL).
+/// @param error - set value to error, if base file is corrupted or contains nested tables.
+/// @return new GBytes with GVDB, or NULL.
+GBytes *svdb_overlay_get_raw(SvdbOverlay *overlay, gboolean byteswap, SvdbWriteFlags flags, SvdbWriteStats *stats,
+                             GError **error);
+
+/// @brief Write base file merged with changes into file (file is replaced, so it can be the base file).
+/// @param overlay - current overlay.
+/// @param filename - GVDB file path.
+/// @param byteswap - byteswap GVariant values.
+/// @param error handler.
+/// @return TRUE if successful, else FALSE.
+gboolean svdb_overlay_write_to_file(SvdbOverlay *overlay, const gchar *filename, gboolean byteswap,
+                                    GError **error);
+
 
 /// @brief Return table child items.
 /// @param table - table current path(or NULL).
 /// @param size - pointer for return size(or NULL).
-/// @return Array of strings with child names, or NULL(if no child is present or table isn't table :) ).
+/// @return Array of strings with child names sorted by key, or NULL(if no child is present or table isn't table :) ).
 /// Value must be freed with `g_strfreev`
 gchar **svdb_table_list_child(const SvdbTableItem *table, gsize *size, GError **error);
 
+/// @brief Initialize iterator over table or list elements. Lists are iterated in their order, tables in order of
+/// hash table (same, until table is modified). Item must not be modified during iteration.
+/// @param iter - iterator (usually on stack).
+/// @param item - table or list (for other items iterator is empty).
+void svdb_iter_init(SvdbIter *iter, const SvdbTableItem *item);
+
+/// @brief Get next element.
+/// @param iter - initialized iterator.
+/// @param key - pointer for borrowed key (or NULL).
+/// @param value - pointer for borrowed item (or NULL).
+/// @return FALSE if there are no more elements, else TRUE.
+gboolean svdb_iter_next(SvdbIter *iter, const gchar **key, SvdbTableItem **value);
+
+/// @brief Call function for every element of table or list (see svdb_iter_init).
+/// @param item - table or list.
+/// @param func - callback.
+/// @param user_data - user data for callback.
+/// @return count of visited elements.
+gsize svdb_item_foreach(const SvdbTableItem *item, SvdbForeachFunc func, gpointer user_data);
+
+/// @brief Get count of table or list elements.
+/// @param item - current item.
+/// @return count of elements (0 for other items).
+gsize svdb_item_get_length(const SvdbTableItem *item);
+
 /// @brief Create new empty item.
 /// @return New empty item (SVDB_TYPE_NONE).
 SvdbTableItem *svdb_item_new();
@@ -148,7 +697,7 @@ gboolean svdb_item_list_remove_element(SvdbTableItem *item, const gchar *element
 /// @param item - current item.
 /// @param elements - elements keys.
 /// @param nelements - elements keys count.
-/// @param exist_cancel - if TRUE even one key is missing, the operation will be canceled. (+O(n*m) overhead, n - list count, m - elements count)
+/// @param exist_cancel - if TRUE even one key is missing, the operation will be canceled (+O(n) overhead, n - list count).
 /// @return if successful return current item, or NULL.
 gboolean svdb_item_list_remove_elements(SvdbTableItem *item, const gchar **elements, gsize nelements,
                                         gboolean exist_cancel);
@@ -184,16 +733,29 @@ SvdbItemType svdb_item_get_type(const SvdbTableItem *item);
 /// @param item - current item.
 /// @param path - table current path(or NULL)(Must begin and end with '/', or be "/")(no validations).
 /// @param valueMode - true => dump like it value, false => dump like table(if item type is table).
-/// @return Pretty output string.
+/// @return Pretty output string (children are sorted by key, so equal items give equal output).
 GString *svdb_item_dump(const SvdbTableItem *item, const gchar *path, gboolean valueMode);
 
+/// @brief Get content hash of item subtree (types, keys and values, but not order of elements).
+/// Hash is computed once and cached in items, any change of subtree invalidates it along parent chain.
+/// @param item - current item.
+/// @return hex string (free with g_free), or NULL.
+gchar *svdb_item_get_content_hash(const SvdbTableItem *item);
+
+/// @brief Check if items have equal content (by content hashes, see svdb_item_get_content_hash).
+/// @param item - current item.
+/// @param other - other item.
+/// @return TRUE if content is equal, else FALSE.
+gboolean svdb_item_equal(const SvdbTableItem *item, const SvdbTableItem *other);
+
 /// @brief Get item from list by name.
 /// @param list - current list.
 /// @param key - element path.
 /// @return child SvdbTableItem (free with svdb_item_unref) or NULL.
 SvdbTableItem *svdb_item_list_get_element(const SvdbTableItem *list, const gchar *key);
 
-/// @brief Increase refcounter for current item.
+/// @brief Increase refcounter for current item (refcounter is atomic, so shared frozen items can be referenced from
+/// many threads).
 /// @param item - current item.
 /// @return current item.
 SvdbTableItem *svdb_item_ref(const SvdbTableItem *item);
@@ -221,7 +783,7 @@ GString *svdb_dump_path(const SvdbTableItem *table, const gchar *path, GError **
 /// @param table - root table for path context.
 /// @param path - path in root table (must start and end with '/').
 /// @param error - set value to error, if error occurred.
-/// @return dump of child table elements, or NULL.
+/// @return dump of child table elements (sorted by key), or NULL.
 GString *svdb_list_path(const SvdbTableItem *table, const gchar *path, GError **error);
 
 /// @brief Dump variant value in table by path.
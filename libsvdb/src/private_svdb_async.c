@@ -0,0 +1,140 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_ASYNC
+#include "private_svdb_parse.c"
+#include "private_svdb_export.c"
+#define LIBSVDB_PRIVATE_SVDB_ASYNC
+
+typedef struct SvdbReadTask_t
+{
+    gchar *filename;
+    gboolean trusted;
+} SvdbReadTask;
+
+typedef struct SvdbWriteTask_t
+{
+    /// @brief Referenced table, it must not be changed until task is finished.
+    SvdbTableItem *table;
+    gchar *filename;
+    gboolean byteswap;
+} SvdbWriteTask;
+
+static void svdb_read_task_free(SvdbReadTask *data) {
+    g_free(data->filename);
+    g_slice_free(SvdbReadTask, data);
+}
+
+static void svdb_write_task_free(SvdbWriteTask *data) {
+    svdb_item_unref(data->table);
+    g_free(data->filename);
+    g_slice_free(SvdbWriteTask, data);
+}
+
+static void svdb_read_task_run(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    SvdbReadTask *data = task_data;
+    SvdbTableItem *table;
+    GError *error = NULL;
+
+    table = svdb_parse_file(data->filename, data->trusted, SVDB_LOAD_SEQUENTIAL, cancellable, &error);
+    if (!table) {
+        if (!error) {
+            g_set_error(&error, SVDB_ERROR, 0, "%s: corrupted gvdb file(invalid root table)", data->filename);
+        }
+        g_task_return_error(task, error);
+        return;
+    }
+
+    g_task_return_pointer(task, table, (GDestroyNotify) &svdb_item_unref);
+}
+
+static void svdb_write_task_run(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    SvdbWriteTask *data = task_data;
+    GError *error = NULL;
+    GBytes *content;
+    GFile *file;
+    gboolean status;
+
+    content = svdb_gvdbbuilder_write_table(data->table, data->byteswap, SVDB_WRITE_DEDUP, NULL, NULL, cancellable,
+                                           &error);
+    if (!content) {
+        g_task_return_error(task, error);
+        return;
+    }
+
+    // Content is written into temporary file, which replaces target one, so readers never see partial file.
+    file = g_file_new_for_path(data->filename);
+    status = g_file_replace_contents(file, g_bytes_get_data(content, NULL), g_bytes_get_size(content), NULL, FALSE,
+                                     G_FILE_CREATE_NONE, NULL, cancellable, &error);
+    g_object_unref(file);
+    g_bytes_unref(content);
+
+    if (!status) {
+        g_task_return_error(task, error);
+        return;
+    }
+
+    g_task_return_boolean(task, TRUE);
+}
+
+void svdb_table_read_from_file_async(const gchar *filename, gboolean trusted, gint io_priority,
+                                     GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data) {
+    SvdbReadTask *data;
+    GTask *task;
+
+    task = g_task_new(NULL, cancellable, callback, user_data);
+    g_task_set_source_tag(task, svdb_table_read_from_file_async);
+    g_task_set_priority(task, io_priority);
+
+    if (!filename) {
+        g_task_return_new_error(task, SVDB_ERROR, 0, "filename is NULL");
+        g_object_unref(task);
+        return;
+    }
+
+    data = g_slice_new0(SvdbReadTask);
+    data->filename = g_strdup(filename);
+    data->trusted = trusted;
+    g_task_set_task_data(task, data, (GDestroyNotify) &svdb_read_task_free);
+
+    g_task_run_in_thread(task, svdb_read_task_run);
+    g_object_unref(task);
+}
+
+SvdbTableItem *svdb_table_read_from_file_finish(GAsyncResult *result, GError **error) {
+    if (!g_task_is_valid(result, NULL)) {
+        return NULL;
+    }
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+void svdb_table_write_to_file_async(SvdbTableItem *table, const gchar *filename, gboolean byteswap, gint io_priority,
+                                    GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data) {
+    SvdbWriteTask *data;
+    GTask *task;
+
+    task = g_task_new(NULL, cancellable, callback, user_data);
+    g_task_set_source_tag(task, svdb_table_write_to_file_async);
+    g_task_set_priority(task, io_priority);
+
+    if (!table || table->type != SVDB_TYPE_TABLE || !filename) {
+        g_task_return_new_error(task, SVDB_ERROR, 0, "invalid table or filename");
+        g_object_unref(task);
+        return;
+    }
+
+    data = g_slice_new0(SvdbWriteTask);
+    data->table = svdb_item_ref(table);
+    data->filename = g_strdup(filename);
+    data->byteswap = byteswap;
+    g_task_set_task_data(task, data, (GDestroyNotify) &svdb_write_task_free);
+
+    g_task_run_in_thread(task, svdb_write_task_run);
+    g_object_unref(task);
+}
+
+gboolean svdb_table_write_to_file_finish(GAsyncResult *result, GError **error) {
+    if (!g_task_is_valid(result, NULL)) {
+        return FALSE;
+    }
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_ASYNC
@@ -0,0 +1,163 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_BUILDER
+#include "private_svdb_common.c"
+#define LIBSVDB_PRIVATE_SVDB_BUILDER
+
+struct SvdbTreeBuilder_t
+{
+    /// @brief Built root table.
+    SvdbTableItem *root;
+    /// @brief Dirs of added keys (with leading and trailing '/'), path => list item (borrowed).
+    GHashTable *dirs;
+    /// @brief Added keys, path => variant item (borrowed).
+    GHashTable *keys;
+    /// @brief Created lists in creation order, so every list is placed after its parent.
+    GPtrArray *lists;
+};
+
+/// @brief Append item into list without ancestor walk (childs are computed in svdb_tree_builder_finish).
+static void svdb_tree_builder_attach(SvdbTableItem *list, const gchar *key, gsize key_length,
+                                     SvdbTableItem *item) {
+    svdb_item_list_reserve(list, list->length + 1);
+    list->list[list->length].key = g_strndup(key, key_length);
+    list->list[list->length].item = item;
+    ++list->length;
+    item->parent = list;
+}
+
+/// @brief Get list of dir, creating it and missing parent dirs.
+/// @param dir - dir path (starts and ends with '/').
+/// @param length - length of dir path.
+static SvdbTableItem *svdb_tree_builder_get_dir(SvdbTreeBuilder *builder, const gchar *dir, gsize length) {
+    SvdbTableItem *parent, *list;
+    gchar *path = g_strndup(dir, length);
+    gsize parent_length;
+
+    list = g_hash_table_lookup(builder->dirs, path);
+    if (list) {
+        g_free(path);
+        return list;
+    }
+
+    // "/" always exists, so parent dir is not empty.
+    parent_length = length - 1;
+    while (dir[parent_length - 1] != '/') {
+        --parent_length;
+    }
+    parent = svdb_tree_builder_get_dir(builder, dir, parent_length);
+
+    list = svdb_item_new();
+    list->type = SVDB_TYPE_LIST;
+    svdb_tree_builder_attach(parent, dir + parent_length, length - parent_length, list);
+
+    g_ptr_array_add(builder->lists, list);
+    g_hash_table_insert(builder->dirs, path, list);
+    return list;
+}
+
+SvdbTreeBuilder *svdb_tree_builder_new(void) {
+    SvdbTreeBuilder *builder = g_new0(SvdbTreeBuilder, 1);
+    SvdbTableItem *list = svdb_item_new();
+
+    builder->root = svdb_table_new();
+    builder->dirs = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free, NULL);
+    builder->keys = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free, NULL);
+    builder->lists = g_ptr_array_new();
+
+    list->type = SVDB_TYPE_LIST;
+    list->parent = builder->root;
+    g_hash_table_insert(builder->root->table, g_strdup("/"), list);
+    g_hash_table_insert(builder->dirs, g_strdup("/"), list);
+    g_ptr_array_add(builder->lists, list);
+
+    return builder;
+}
+
+gboolean svdb_tree_builder_add(SvdbTreeBuilder *builder, const gchar *path, GVariant *value, GError **error) {
+    SvdbTableItem *item, *dir;
+    const gchar *key;
+    gsize length;
+
+    if (!builder || !path || !value) {
+        return FALSE;
+    }
+
+    length = strlen(path);
+
+    if (path[0] != '/' || path[length - 1] == '/' || strstr(path, "//")) {
+        g_set_error(error, SVDB_ERROR, 0, "invalid key path(%s)", path);
+        return FALSE;
+    }
+
+    item = g_hash_table_lookup(builder->keys, path);
+
+    // Last value of key wins, like in svdb_item_list_append_value.
+    if (item) {
+        g_variant_unref(item->variant);
+        item->variant = g_variant_ref_sink(value);
+        return TRUE;
+    }
+
+    key = strrchr(path, '/') + 1;
+    dir = svdb_tree_builder_get_dir(builder, path, key - path);
+
+    item = svdb_item_new();
+    item->type = SVDB_TYPE_VARIANT;
+    item->variant = g_variant_ref_sink(value);
+    svdb_tree_builder_attach(dir, key, path + length - key, item);
+
+    g_hash_table_insert(builder->keys, g_strndup(path, length), item);
+    return TRUE;
+}
+
+/// @brief Compute childs of all lists and root table in one pass.
+static void svdb_tree_builder_count_childs(SvdbTreeBuilder *builder) {
+    SvdbTableItem *list;
+
+    // Children lists are created after their parents, so reverse order is a bottom-up pass.
+    for (guint i = builder->lists->len; i > 0; --i) {
+        list = g_ptr_array_index(builder->lists, i - 1);
+
+        list->childs = 0;
+        for (gsize j = 0; j < list->length; ++j) {
+            list->childs += list->list[j].item->childs + 1;
+        }
+    }
+
+    // The first list is "/", the only item of root table.
+    list = g_ptr_array_index(builder->lists, 0);
+    builder->root->childs = list->childs + 1;
+}
+
+SvdbTableItem *svdb_tree_builder_finish(SvdbTreeBuilder *builder) {
+    SvdbTableItem *root;
+
+    if (!builder) {
+        return NULL;
+    }
+
+    svdb_tree_builder_count_childs(builder);
+
+    root = builder->root;
+    builder->root = NULL;
+    svdb_tree_builder_free(builder);
+    return root;
+}
+
+void svdb_tree_builder_free(SvdbTreeBuilder *builder) {
+    if (!builder) {
+        return;
+    }
+
+    if (builder->root) {
+        // Consistent counters, so detaching items on free doesn't underflow them.
+        svdb_tree_builder_count_childs(builder);
+        svdb_item_unref(builder->root);
+    }
+
+    g_hash_table_unref(builder->dirs);
+    g_hash_table_unref(builder->keys);
+    g_ptr_array_unref(builder->lists);
+    g_free(builder);
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_BUILDER
@@ -73,14 +73,28 @@ static inline guint16 guint16_from_le (guint16_le value) {
 
 #endif
 
+/// @brief Size of item content hash (truncated SHA-256).
+#define SVDB_CONTENT_HASH_SIZE 16
+
 struct SvdbTableItem_t
 {
     /// @brief Pointer to parent table/list(non-variant, and non-none).
     SvdbTableItem *parent;
     /// @brief Current type of item.
     SvdbItemType type;
-    /// @brief Thread-unsafe refcounter.
-    grefcount refcount;
+    /// @brief Atomic refcounter (subtrees of frozen trees are shared between snapshots and threads).
+    gatomicrefcount refcount;
+    /// @brief Item is a part of frozen (immutable) tree, see svdb_tree_freeze. Frozen items have no parent.
+    gboolean frozen;
+    /// @brief Variant is stored in foreign byte order, and will be swapped on first access.
+    gboolean byteswapped;
+    /// @brief Swapped (native) copy of foreign variant, published atomically on first access (see
+    /// svdb_item_peek_variant). Stored variant isn't changed, so readers never see freed value.
+    GVariant *swapped;
+    /// @brief Content hash is computed and actual. Valid hash of item means valid hashes of whole subtree.
+    gboolean content_hash_valid;
+    /// @brief Lazily computed Merkle hash of subtree content (see svdb_item_content_hash).
+    guint8 content_hash[SVDB_CONTENT_HASH_SIZE];
     /// @brief One depth child count. If table => count of all child(non-recursive) + list length of
     /// child lists(recursive). If List => list length. If Variant => 0).
     guint32 childs;
@@ -94,6 +108,8 @@ struct SvdbTableItem_t
         {
             SvdbListElement *list;
             gsize length;
+            /// @brief Allocated count of list elements (see svdb_item_list_reserve).
+            gsize capacity;
         };
     };
 };
@@ -109,16 +125,19 @@ typedef struct SVDBTableHeader_t
     guint32 n_hash_items;
 } SVDBTableHeader;
 
-static guint32 svdb_hash(const gchar *key, guint32 *key_length)
+/// @brief Initial value of GVDB (djb) key hash.
+#define SVDB_HASH_INITIAL 5381
+
+/// @brief Continue GVDB hash of parent key with child key. GVDB hashes full item name (name of all parents + key).
+static guint32 svdb_hash_append(guint32 hash_value, const gchar *key, guint32 *key_length)
 {
     if (!key || !*key) {
         if (key_length) {
             *key_length = 0;
         }
-        return 5381;
+        return hash_value;
     }
 
-    guint32 hash_value = 5381;
     guint32 length;
 
     for (length = 0; key[length]; ++length) {
@@ -132,6 +151,11 @@ static guint32 svdb_hash(const gchar *key, guint32 *key_length)
     return hash_value;
 }
 
+static guint32 svdb_hash(const gchar *key, guint32 *key_length)
+{
+    return svdb_hash_append(SVDB_HASH_INITIAL, key, key_length);
+}
+
 static gchar svdb_item_type_to_char(SvdbItemType type)
 {
     switch (type) {
@@ -157,8 +181,20 @@ static SvdbItemType svdb_item_char_to_type(gchar character)
     return SVDB_TYPE_NONE;
 }
 
+/// @brief Invalidate content hash of item and of all its ancestors (call on every change of subtree).
+static void svdb_item_invalidate_content_hash(SvdbTableItem *item)
+{
+    // If item hash is already invalid, then hashes of all ancestors are invalid too.
+    while (item && item->content_hash_valid) {
+        item->content_hash_valid = FALSE;
+        item = item->parent;
+    }
+}
+
 static void svdb_dettach(SvdbTableItem *item)
 {
+    svdb_item_invalidate_content_hash(item->parent);
+
     guint32 length = item->childs + 1;
 
     SvdbTableItem *parent = item->parent;
@@ -183,9 +219,16 @@ static void svdb_item_clear_unref_dettach(SvdbTableItem *item)
 
 static void svdb_item_clear(SvdbTableItem *item)
 {
+    svdb_item_invalidate_content_hash(item);
+
     switch (item->type) {
     case SVDB_TYPE_VARIANT:
         g_variant_unref(item->variant);
+        if (item->swapped) {
+            g_variant_unref(item->swapped);
+            item->swapped = NULL;
+        }
+        item->byteswapped = FALSE;
         break;
     case SVDB_TYPE_TABLE:
         g_hash_table_unref(item->table);
@@ -196,11 +239,14 @@ static void svdb_item_clear(SvdbTableItem *item)
             svdb_item_unref(item->list[i - 1].item);
             g_free(item->list[i - 1].key);
         }
-        g_free_sized(item->list, sizeof *(item->list) * item->length);
+        g_free_sized(item->list, sizeof *(item->list) * item->capacity);
         break;
     }
 
     item->type = SVDB_TYPE_NONE;
+    item->list = NULL;
+    item->length = 0;
+    item->capacity = 0;
     guint32 old = item->childs;
     item->childs = 0;
     
@@ -216,6 +262,179 @@ static void svdb_item_clear(SvdbTableItem *item)
     }
 }
 
+/// @brief Get variant of item in native byte order (borrowed), lazy byteswapping foreign value.
+/// Safe for concurrent readers: swapped copy is published once by compare-and-exchange, the loser drops its copy.
+static GVariant *svdb_item_peek_variant(const SvdbTableItem *item)
+{
+    if G_UNLIKELY(item->byteswapped) {
+        SvdbTableItem *mutable_item = (SvdbTableItem *) item;
+        GVariant *swapped = g_atomic_pointer_get(&mutable_item->swapped);
+
+        if (!swapped) {
+            swapped = g_variant_byteswap(item->variant);
+
+            if (!g_atomic_pointer_compare_and_exchange(&mutable_item->swapped, NULL, swapped)) {
+                g_variant_unref(swapped);
+                swapped = g_atomic_pointer_get(&mutable_item->swapped);
+            }
+        }
+        return swapped;
+    }
+    return item->variant;
+}
+
+/// @brief Reserve place for at least length elements in list. Capacity grows geometrically, so n appends cost
+/// O(n) copies in total.
+static void svdb_item_list_reserve(SvdbTableItem *item, gsize length)
+{
+    gsize capacity;
+
+    if (length <= item->capacity) {
+        return;
+    }
+
+    capacity = MAX(length, MAX(item->capacity * 2, 4));
+    item->list = g_realloc_n(item->list, capacity, sizeof *item->list);
+    item->capacity = capacity;
+}
+
+static int svdb_list_element_compare(const void *a, const void *b)
+{
+    return strcmp(((const SvdbListElement *) a)->key, ((const SvdbListElement *) b)->key);
+}
+
+/// @brief Get children of table or list sorted by key, so output doesn't depend on GHashTable order.
+/// Keys and items are borrowed.
+/// @return array, which must be freed with `g_free`, or NULL if item has no children.
+static SvdbListElement *svdb_item_sorted_children(const SvdbTableItem *item, gsize *length)
+{
+    SvdbListElement *children = NULL;
+    gsize count = 0;
+
+    switch (item->type) {
+    case SVDB_TYPE_TABLE: {
+        GHashTableIter iter;
+        gpointer key, value;
+
+        count = g_hash_table_size(item->table);
+        if (!count) {
+            break;
+        }
+
+        children = g_new(SvdbListElement, count);
+        count = 0;
+
+        g_hash_table_iter_init(&iter, item->table);
+        while (g_hash_table_iter_next(&iter, &key, &value)) {
+            children[count].key = key;
+            children[count].item = value;
+            ++count;
+        }
+        break;
+    }
+    case SVDB_TYPE_LIST:
+        count = item->length;
+        if (count) {
+            children = g_memdup2(item->list, count * sizeof *item->list);
+        }
+        break;
+    default:
+        break;
+    }
+
+    *length = count;
+
+    if (!count) {
+        return NULL;
+    }
+
+    // Keys are unique, so unstable sort gives the same order every time.
+    qsort(children, count, sizeof *children, svdb_list_element_compare);
+    return children;
+}
+
+static const guint8 *svdb_item_content_hash(const SvdbTableItem *item);
+
+/// @brief Add hash of child element into order-independent sum of children hashes.
+static void svdb_content_hash_add_element(guint64 *sum, GChecksum *checksum, const gchar *key,
+                                          const SvdbTableItem *item)
+{
+    guint8 buffer[32];
+    gsize length = sizeof buffer;
+    guint64 words[SVDB_CONTENT_HASH_SIZE / sizeof(guint64)];
+
+    g_checksum_reset(checksum);
+    g_checksum_update(checksum, (const guchar *) key, strlen(key) + 1);
+    g_checksum_update(checksum, svdb_item_content_hash(item), SVDB_CONTENT_HASH_SIZE);
+    g_checksum_get_digest(checksum, buffer, &length);
+    memcpy(words, buffer, sizeof words);
+
+    for (gsize i = 0; i < G_N_ELEMENTS(words); ++i) {
+        sum[i] += words[i];
+    }
+}
+
+/// @brief Get Merkle hash of item content (type, values and keys of whole subtree), computing it if needed.
+/// Order of table and list elements doesn't matter.
+static const guint8 *svdb_item_content_hash(const SvdbTableItem *item)
+{
+    SvdbTableItem *mutable_item = (SvdbTableItem *) item;
+    guint64 sum[SVDB_CONTENT_HASH_SIZE / sizeof(guint64)] = {0};
+    gchar type = svdb_item_type_to_char(item->type);
+    guint8 buffer[32];
+    gsize length = sizeof buffer;
+    GChecksum *checksum;
+
+    if (item->content_hash_valid) {
+        return item->content_hash;
+    }
+
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+
+    switch (item->type) {
+    case SVDB_TYPE_LIST:
+        for (gsize i = 0; i < item->length; ++i) {
+            svdb_content_hash_add_element(sum, checksum, item->list[i].key, item->list[i].item);
+        }
+        break;
+    case SVDB_TYPE_TABLE: {
+        GHashTableIter iter;
+        const gchar *key;
+        const SvdbTableItem *value;
+
+        g_hash_table_iter_init(&iter, item->table);
+        while (g_hash_table_iter_next(&iter, (gpointer *) &key, (gpointer *) &value)) {
+            svdb_content_hash_add_element(sum, checksum, key, value);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    g_checksum_reset(checksum);
+    g_checksum_update(checksum, (const guchar *) &type, 1);
+
+    if (item->type == SVDB_TYPE_VARIANT) {
+        // Hash of native normal form, so byte order and serialization details don't matter.
+        GVariant *normal = g_variant_get_normal_form(svdb_item_peek_variant(item));
+        const gchar *type_string = g_variant_get_type_string(normal);
+
+        g_checksum_update(checksum, (const guchar *) type_string, strlen(type_string) + 1);
+        g_checksum_update(checksum, g_variant_get_data(normal), g_variant_get_size(normal));
+        g_variant_unref(normal);
+    } else {
+        g_checksum_update(checksum, (const guchar *) sum, sizeof sum);
+    }
+
+    g_checksum_get_digest(checksum, buffer, &length);
+    g_checksum_free(checksum);
+
+    memcpy(mutable_item->content_hash, buffer, SVDB_CONTENT_HASH_SIZE);
+    mutable_item->content_hash_valid = TRUE;
+    return item->content_hash;
+}
+
 static SvdbTableItem *svdb_item_set_table(SvdbTableItem *item, GHashTable *table)
 {
     if (!item) {
@@ -0,0 +1,357 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_DIFF
+#include "private_svdb_file.c"
+#define LIBSVDB_PRIVATE_SVDB_DIFF
+
+/// @brief Parent of item is missing in other file, so whole subtree is missing too.
+#define SVDB_DIFF_MISSING ((guint32) -3)
+
+/// @brief Digest of item subtree, cached in file. Order of list children doesn't matter.
+/// @return digest, or NULL if subtree can't be compared by digest.
+static const SvdbDigest *svdb_file_item_digest(SvdbFile *file, guint32 index, GChecksum *checksum) {
+    const SVDBTableHeader *header = &file->root;
+    const struct svdb_hash_item *item = header->hash_items + index;
+    guint64 children[2] = {0, 0};
+    guint8 buffer[32];
+    gsize buffer_length = sizeof buffer;
+    SvdbDigest *digest;
+    gconstpointer data;
+    gsize size;
+
+    if (!file->digests) {
+        file->digests = g_new0(SvdbDigest, header->n_hash_items);
+    }
+
+    digest = file->digests + index;
+
+    if (digest->state) {
+        return digest->state == 1 ? digest : NULL;
+    }
+
+    // Not comparable until computed, so corrupted parent cycles can't recurse forever.
+    digest->state = 2;
+
+    if G_UNLIKELY((guint64) guint32_from_le(item->key_start) + guint16_from_le(item->key_size) > file->size) {
+        return NULL;
+    }
+
+    switch (svdb_item_char_to_type(item->type)) {
+        case SVDB_TYPE_VARIANT:
+            data = svdb_table_dereference(file->data, file->size, item->value.pointer, 8, &size);
+            if G_UNLIKELY(!data) {
+                return NULL;
+            }
+            break;
+        case SVDB_TYPE_LIST: {
+            const guint32_le *indecies;
+            guint count;
+
+            if (!svdb_table_list_indecies_from_item(file->data, file->size, item, &indecies, &count)) {
+                return NULL;
+            }
+
+            for (guint i = 0; i < count; ++i) {
+                guint32 itemno = guint32_from_le(indecies[i]);
+                const SvdbDigest *child;
+
+                if (itemno >= header->n_hash_items || guint32_from_le(header->hash_items[itemno].parent) != index) {
+                    continue;
+                }
+                child = svdb_file_item_digest(file, itemno, checksum);
+                if (!child) {
+                    return NULL;
+                }
+                // Sum doesn't depend on children order.
+                children[0] += child->words[0];
+                children[1] += child->words[1];
+            }
+
+            data = children;
+            size = sizeof children;
+            break;
+        }
+        default:
+            return NULL;
+    }
+
+    g_checksum_reset(checksum);
+    g_checksum_update(checksum, (const guchar *) &item->type, 1);
+    // Same bytes in different byte order are different values.
+    g_checksum_update(checksum, (const guchar *) &file->byteswapped, sizeof file->byteswapped);
+    g_checksum_update(checksum, (const guchar *) &item->key_size, sizeof item->key_size);
+    g_checksum_update(checksum, (const guchar *) file->data + guint32_from_le(item->key_start),
+                      guint16_from_le(item->key_size));
+    g_checksum_update(checksum, data, size);
+    g_checksum_get_digest(checksum, buffer, &buffer_length);
+
+    memcpy(digest->words, buffer, sizeof digest->words);
+    digest->state = 1;
+    return digest;
+}
+
+typedef struct SvdbDiffer_t
+{
+    /// @brief Old and new files (NULL <=> empty file).
+    SvdbFile *files[2];
+    SvdbDiffFunc func;
+    gpointer user_data;
+    /// @brief Full name of current item.
+    GString *name;
+    /// @brief For subtree digests.
+    GChecksum *checksum;
+    gboolean stopped;
+} SvdbDiffer;
+
+static gboolean svdb_file_values_equal(const SvdbFile *file, const struct svdb_hash_item *item,
+                                       const SvdbFile *other_file, const struct svdb_hash_item *other_item,
+                                       GError **error) {
+    gconstpointer data, other_data;
+    gsize size, other_size;
+    GVariant *value, *other_value;
+    gboolean equal;
+
+    data = svdb_table_dereference(file->data, file->size, item->value.pointer, 8, &size);
+    other_data = svdb_table_dereference(other_file->data, other_file->size, other_item->value.pointer, 8,
+                                        &other_size);
+
+    if G_UNLIKELY(!data || !other_data) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+        return FALSE;
+    }
+
+    // Same bytes in same byte order are same value, it's the common case and needs no decoding.
+    if (file->byteswapped == other_file->byteswapped && size == other_size && memcmp(data, other_data, size) == 0) {
+        return TRUE;
+    }
+
+    value = svdb_file_item_get_value(file, item);
+    other_value = svdb_file_item_get_value(other_file, other_item);
+    equal = value && other_value && g_variant_equal(value, other_value);
+
+    if (value) {
+        g_variant_unref(value);
+    }
+    if (other_value) {
+        g_variant_unref(other_value);
+    }
+
+    return equal;
+}
+
+static gboolean svdb_differ_report(SvdbDiffer *differ, SvdbDiffKind kind, const SvdbFile *file,
+                                   const struct svdb_hash_item *item, const SvdbFile *other_file,
+                                   const struct svdb_hash_item *other_item, GError **error) {
+    GVariant *values[2] = {NULL, NULL};
+
+    values[0] = svdb_file_item_get_value(file, item);
+    if (other_item) {
+        values[1] = svdb_file_item_get_value(other_file, other_item);
+    }
+
+    if G_UNLIKELY(!values[0] || (other_item && !values[1])) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+    } else if (kind == SVDB_DIFF_ADDED) {
+        differ->stopped = !differ->func(differ->name->str, kind, NULL, values[0], differ->user_data);
+    } else {
+        differ->stopped = !differ->func(differ->name->str, kind, values[0], values[1], differ->user_data);
+    }
+
+    if (values[0]) {
+        g_variant_unref(values[0]);
+    }
+    if (values[1]) {
+        g_variant_unref(values[1]);
+    }
+
+    return !error || !*error;
+}
+
+/// @brief Compare subtree of item with other file.
+/// @param reverse - FALSE => walk old file (report removed and changed), TRUE => walk new file (report added).
+/// @param hash - hash of parent full name.
+/// @param other_parent - index of item parent in other file, (guint32) -1 for root, or SVDB_DIFF_MISSING.
+static gboolean svdb_differ_visit(SvdbDiffer *differ, gboolean reverse, guint32 index, guint32 hash,
+                                  guint32 other_parent, GError **error) {
+    SvdbFile *file = differ->files[reverse];
+    SvdbFile *other_file = differ->files[!reverse];
+    const struct svdb_hash_item *item = file->root.hash_items + index;
+    const struct svdb_hash_item *other_item = NULL;
+    guint32 start = guint32_from_le(item->key_start);
+    guint32 length = guint16_from_le(item->key_size);
+    gsize name_length = differ->name->len;
+    gboolean result = TRUE;
+
+    if G_UNLIKELY((guint64) start + length > file->size) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(key out of bounds)");
+        return FALSE;
+    }
+
+    g_string_append_len(differ->name, (const gchar *) file->data + start, length);
+    hash = svdb_hash_append(hash, differ->name->str + name_length, NULL);
+
+    // Items of missing subtree are not looked up, whole subtree is reported at once.
+    if (other_file && other_parent != SVDB_DIFF_MISSING) {
+        // Legacy hashes are hashes of own key, which is looked up relative to parent anyway.
+        guint32 other_hash = other_file->legacy_hashes ? svdb_hash(differ->name->str + name_length, NULL) : hash;
+
+        other_item = svdb_file_lookup_item(&other_file->root, other_file->data, other_file->size,
+                                           differ->name->str + name_length, length, other_hash, other_parent);
+        if (other_item && other_item->type != item->type) {
+            other_item = NULL;
+        }
+    }
+
+    switch (svdb_item_char_to_type(item->type)) {
+        case SVDB_TYPE_VARIANT:
+            if (!other_item) {
+                result = svdb_differ_report(differ, reverse ? SVDB_DIFF_ADDED : SVDB_DIFF_REMOVED, file, item,
+                                            NULL, NULL, error);
+            } else if (!reverse) {
+                GError *tmp_error = NULL;
+
+                if (!svdb_file_values_equal(file, item, other_file, other_item, &tmp_error)) {
+                    if (tmp_error) {
+                        g_propagate_error(error, tmp_error);
+                        result = FALSE;
+                    } else {
+                        result = svdb_differ_report(differ, SVDB_DIFF_CHANGED, file, item, other_file, other_item,
+                                                    error);
+                    }
+                }
+            }
+            break;
+        case SVDB_TYPE_LIST: {
+            const SVDBTableHeader *header = &file->root;
+            guint32 child_other_parent = other_item ? (guint32) (other_item - other_file->root.hash_items)
+                                                    : SVDB_DIFF_MISSING;
+            const guint32_le *indecies;
+            guint count;
+
+            if (!svdb_table_list_indecies_from_item(file->data, file->size, item, &indecies, &count)) {
+                g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(corrupted list)");
+                result = FALSE;
+                break;
+            }
+
+            // Equal subtrees are skipped without walking in both passes (digests are cached in files, so it's
+            // cheap to diff many files against the same one).
+            if (other_item) {
+                const SvdbDigest *digest = svdb_file_item_digest(file, index, differ->checksum);
+                const SvdbDigest *other_digest = svdb_file_item_digest(other_file, child_other_parent,
+                                                                       differ->checksum);
+
+                if (digest && other_digest && memcmp(digest->words, other_digest->words, sizeof digest->words) == 0) {
+                    break;
+                }
+            }
+
+            for (guint i = 0; i < count && result && !differ->stopped; ++i) {
+                guint32 itemno = guint32_from_le(indecies[i]);
+
+                if (itemno >= header->n_hash_items || guint32_from_le(header->hash_items[itemno].parent) != index) {
+                    continue;
+                }
+                result = svdb_differ_visit(differ, reverse, itemno, hash, child_other_parent, error);
+            }
+            break;
+        }
+        case SVDB_TYPE_TABLE:
+            // Nested table items are in own hash table, which isn't walked: error instead of silent skip.
+            g_set_error(error, SVDB_ERROR, 0, "unsupported item(nested table %s)", differ->name->str);
+            result = FALSE;
+            break;
+        default:
+            g_set_error(error, SVDB_ERROR, 0, "unsupported item(type '%c' of %s)", item->type, differ->name->str);
+            result = FALSE;
+            break;
+    }
+
+    g_string_truncate(differ->name, name_length);
+    return result;
+}
+
+gboolean svdb_file_diff(SvdbFile *old_file, SvdbFile *new_file, SvdbDiffFunc func, gpointer user_data,
+                        GError **error) {
+    SvdbDiffer differ = {{old_file, new_file}, func, user_data, NULL, NULL, FALSE};
+    gboolean result = TRUE;
+
+    if (!func) {
+        return FALSE;
+    }
+
+    // Unchanged content (e.g. file is rewritten by same data).
+    if (old_file == new_file || (old_file && new_file && old_file->size == new_file->size
+                                 && memcmp(old_file->data, new_file->data, old_file->size) == 0)) {
+        return TRUE;
+    }
+
+    differ.name = g_string_new(NULL);
+    differ.checksum = g_checksum_new(G_CHECKSUM_SHA256);
+
+    for (gint reverse = 0; reverse < 2 && result && !differ.stopped; ++reverse) {
+        SvdbFile *file = differ.files[reverse];
+
+        if (!file) {
+            continue;
+        }
+
+        for (guint32 i = 0; i < file->root.n_hash_items && result && !differ.stopped; ++i) {
+            if (guint32_from_le(file->root.hash_items[i].parent) != (guint32) -1) {
+                continue;
+            }
+            result = svdb_differ_visit(&differ, reverse, i, SVDB_HASH_INITIAL, (guint32) -1, error);
+        }
+    }
+
+    g_checksum_free(differ.checksum);
+    g_string_free(differ.name, TRUE);
+    return result;
+}
+
+static gboolean svdb_diff_collect(const gchar *key, SvdbDiffKind kind, GVariant *old_value, GVariant *new_value,
+                                  gpointer user_data) {
+    SvdbDiffEntry *entry = g_new0(SvdbDiffEntry, 1);
+
+    entry->key = g_strdup(key);
+    entry->kind = kind;
+    entry->old_value = old_value ? g_variant_ref(old_value) : NULL;
+    entry->new_value = new_value ? g_variant_ref(new_value) : NULL;
+    g_ptr_array_add(user_data, entry);
+
+    return TRUE;
+}
+
+static gint svdb_diff_entry_compare(gconstpointer a, gconstpointer b) {
+    const SvdbDiffEntry *entry_a = *(const SvdbDiffEntry **) a;
+    const SvdbDiffEntry *entry_b = *(const SvdbDiffEntry **) b;
+    gint result = strcmp(entry_a->key, entry_b->key);
+
+    return result ? result : (gint) entry_a->kind - (gint) entry_b->kind;
+}
+
+void svdb_diff_entry_free(SvdbDiffEntry *entry) {
+    if (!entry) {
+        return;
+    }
+    if (entry->old_value) {
+        g_variant_unref(entry->old_value);
+    }
+    if (entry->new_value) {
+        g_variant_unref(entry->new_value);
+    }
+    g_free(entry->key);
+    g_free(entry);
+}
+
+GPtrArray *svdb_diff(SvdbFile *old_file, SvdbFile *new_file, GError **error) {
+    GPtrArray *entries = g_ptr_array_new_with_free_func((GDestroyNotify) svdb_diff_entry_free);
+
+    if (!svdb_file_diff(old_file, new_file, svdb_diff_collect, entries, error)) {
+        g_ptr_array_unref(entries);
+        return NULL;
+    }
+
+    g_ptr_array_sort(entries, svdb_diff_entry_compare);
+    return entries;
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_DIFF
@@ -3,11 +3,50 @@
 #include "private_svdb_common.c"
 #define LIBSVDB_PRIVATE_SVDB_EXPORT
 
+/// @brief Page size of SVDB_WRITE_LOCALITY layout (fixed, so output doesn't depend on host).
+#define SVDB_LAYOUT_PAGE_SIZE 4096
+/// @brief Values up to this size are written next to their keys, larger ones after all dirs of table.
+#define SVDB_LAYOUT_SMALL_VALUE 256
+/// @brief Nested tables with hash table (buckets and items) of this size and more start on page boundary.
+#define SVDB_LAYOUT_LARGE_TABLE (SVDB_LAYOUT_PAGE_SIZE / 2)
+
 typedef struct GvdbBuilder_t {
     GQueue *chunks;
     gsize offset;
+    SvdbWriteFlags flags;
+    /// @brief Offsets of written keys (for SVDB_WRITE_DEDUP), key => offset.
+    GHashTable *strings;
+    /// @brief Pointers to written normal form values (for SVDB_WRITE_DEDUP), GBytes => struct svdb_pointer.
+    GHashTable *values;
+    SvdbWriteStats stats;
+    /// @brief Checked for every written list element and table item, or NULL.
+    GCancellable *cancellable;
+    /// @brief Deferred list contents, large values and nested tables of current table (for SVDB_WRITE_LOCALITY).
+    GQueue *pending_lists;
+    GQueue *pending_values;
+    GQueue *pending_tables;
+    /// @brief Access profile, dir path => rank + 1 (for SVDB_WRITE_LOCALITY), or NULL.
+    GHashTable *profile;
+    /// @brief Count of deferred lists, keeps breadth-first order of lists with equal rank.
+    guint64 sequence;
 } GvdbBuilder;
 
+/// @brief Deferred part of table (list content, large value or nested table), see SVDB_WRITE_LOCALITY.
+typedef struct BuilderPending_t {
+    SvdbTableItem *item;
+    /// @brief Hash item index and hash of list.
+    guint32 index;
+    guint32 hash;
+    /// @brief Full path of list in table (only if there is access profile).
+    gchar *path;
+    guint rank;
+    guint64 sequence;
+    /// @brief Value bytes.
+    GBytes *bytes;
+    /// @brief Pointer to fill (value or nested table).
+    struct svdb_pointer *pointer;
+} BuilderPending;
+
 typedef struct BuilderChunk_t {
     gpointer data;
     gsize size;
@@ -57,7 +96,7 @@ static gboolean svdb_bucketcounter_counter_table(BucketCounter *bucket_counter,
                                                  SvdbTableItem *item);
 
 static gboolean svdb_bucketcounter_counter_list(BucketCounter *bucket_counter,
-                                                SvdbTableItem *item) {
+                                                SvdbTableItem *item, guint32 hash) {
     if (!bucket_counter) {
         return FALSE;
     }
@@ -65,12 +104,13 @@ static gboolean svdb_bucketcounter_counter_list(BucketCounter *bucket_counter,
         return FALSE;
     }
     for (guint32 i = 0; i < item->length; ++i) {
-        svdb_bucketcounter_add(bucket_counter, svdb_hash(item->list[i].key, NULL));
+        guint32 child_hash = svdb_hash_append(hash, item->list[i].key, NULL);
+
+        svdb_bucketcounter_add(bucket_counter, child_hash);
         if (item->list[i].item->type == SVDB_TYPE_LIST) {
-            if (!svdb_bucketcounter_counter_list(bucket_counter, item->list[i].item)) {
+            if (!svdb_bucketcounter_counter_list(bucket_counter, item->list[i].item, child_hash)) {
                 return FALSE;
             }
-            break;
         }
     }
     return TRUE;
@@ -89,9 +129,11 @@ static gboolean svdb_bucketcounter_counter_table(BucketCounter *bucket_counter,
     g_hash_table_iter_init(&iter, item->table);
 
     while (g_hash_table_iter_next(&iter, (gpointer *) &key, (gpointer *) &value)) {
-        svdb_bucketcounter_add(bucket_counter, svdb_hash(key, NULL));
+        guint32 hash = svdb_hash(key, NULL);
+
+        svdb_bucketcounter_add(bucket_counter, hash);
         if (value->type == SVDB_TYPE_LIST) {
-            if (!svdb_bucketcounter_counter_list(bucket_counter, value)) {
+            if (!svdb_bucketcounter_counter_list(bucket_counter, value, hash)) {
                 return FALSE;
             }
         }
@@ -111,21 +153,120 @@ static guint32 svdb_bucketcounter_get_item_index(BucketCounter *counter, const g
     return index;
 }
 
-static GvdbBuilder *svdb_gvdbbuilder_new() {
+static GvdbBuilder *svdb_gvdbbuilder_new(SvdbWriteFlags flags) {
     GvdbBuilder *builder;
 
-    builder = g_slice_new(GvdbBuilder);
+    builder = g_slice_new0(GvdbBuilder);
     builder->chunks = g_queue_new();
     builder->offset = sizeof(struct svdb_header);
+    builder->flags = flags;
+
+    if (flags & SVDB_WRITE_LOCALITY) {
+        builder->pending_lists = g_queue_new();
+        builder->pending_values = g_queue_new();
+        builder->pending_tables = g_queue_new();
+    }
+
+    if (flags & SVDB_WRITE_DEDUP) {
+        builder->strings = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free, NULL);
+        builder->values = g_hash_table_new_full(&g_bytes_hash, &g_bytes_equal,
+                                                (GDestroyNotify) &g_bytes_unref, &g_free);
+    }
 
     return builder;
 }
 
+static void svdb_builderchunk_free(BuilderChunk *chunk) {
+    g_free(chunk->data);
+    g_slice_free(BuilderChunk, chunk);
+}
+
+static void svdb_builderpending_free(BuilderPending *pending) {
+    if (pending->bytes) {
+        g_bytes_unref(pending->bytes);
+    }
+    g_free(pending->path);
+    g_slice_free(BuilderPending, pending);
+}
+
+/// @brief Set access profile: every dir gets rank of first profile path in it, so ancestors of hot dirs are hot too.
+static void svdb_gvdbbuilder_set_profile(GvdbBuilder *builder, const gchar *const *profile) {
+    if (!profile || !*profile) {
+        return;
+    }
+
+    builder->profile = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free, NULL);
+
+    for (guint rank = 0; profile[rank]; ++rank) {
+        const gchar *path = profile[rank];
+
+        for (const gchar *slash = strchr(path, '/'); slash; slash = strchr(slash + 1, '/')) {
+            gchar *dir = g_strndup(path, slash - path + 1);
+
+            if (!g_hash_table_contains(builder->profile, dir)) {
+                g_hash_table_insert(builder->profile, dir, GUINT_TO_POINTER(rank + 1));
+            } else {
+                g_free(dir);
+            }
+        }
+    }
+}
+
+static gint svdb_builderpending_compare(gconstpointer a, gconstpointer b, gpointer user_data) {
+    const BuilderPending *first = a, *second = b;
+
+    if (first->rank != second->rank) {
+        return first->rank < second->rank ? -1 : 1;
+    }
+    return first->sequence < second->sequence ? -1 : first->sequence > second->sequence;
+}
+
+/// @brief Defer list content: lists are written breadth-first, dirs from access profile go first.
+static void svdb_gvdbbuilder_defer_list(GvdbBuilder *builder, SvdbTableItem *list, guint32 index, guint32 hash,
+                                        const gchar *path) {
+    BuilderPending *pending = g_slice_new0(BuilderPending);
+    gpointer rank = NULL;
+
+    pending->item = list;
+    pending->index = index;
+    pending->hash = hash;
+    pending->sequence = builder->sequence++;
+
+    if (builder->profile && path) {
+        rank = g_hash_table_lookup(builder->profile, path);
+        pending->path = g_strdup(path);
+    }
+
+    if (rank) {
+        pending->rank = GPOINTER_TO_UINT(rank) - 1;
+        g_queue_insert_sorted(builder->pending_lists, pending, svdb_builderpending_compare, NULL);
+    } else {
+        // Other lists have max rank and growing sequence, so queue stays sorted.
+        pending->rank = G_MAXUINT;
+        g_queue_push_tail(builder->pending_lists, pending);
+    }
+}
+
 static void svdb_gvdbbuilder_free(GvdbBuilder *builder) {
     if (!builder) {
         return;
     }
-    g_queue_free(builder->chunks);
+    if (builder->strings) {
+        g_hash_table_unref(builder->strings);
+    }
+    if (builder->values) {
+        g_hash_table_unref(builder->values);
+    }
+    if (builder->profile) {
+        g_hash_table_unref(builder->profile);
+    }
+    if (builder->flags & SVDB_WRITE_LOCALITY) {
+        g_queue_free_full(builder->pending_lists, (GDestroyNotify) &svdb_builderpending_free);
+        g_queue_free_full(builder->pending_values, (GDestroyNotify) &svdb_builderpending_free);
+        g_queue_free_full(builder->pending_tables, (GDestroyNotify) &svdb_builderpending_free);
+    }
+    // Chunks are left only if writing failed (or was cancelled).
+    g_queue_free_full(builder->chunks, (GDestroyNotify) &svdb_builderchunk_free);
     g_slice_free(GvdbBuilder, builder);
 }
 
@@ -142,6 +283,23 @@ static void svdb_gvdbbuilder_add_string(GvdbBuilder *builder, const gchar *strin
         return;
     }
 
+    ++builder->stats.n_keys;
+
+    // Keys are not required to be disjoint, so equal keys can point to one copy.
+    if (builder->strings && length) {
+        gpointer offset;
+
+        if (g_hash_table_lookup_extended(builder->strings, string, NULL, &offset)) {
+            *start = guint32_to_le(GPOINTER_TO_UINT(offset));
+            *size = guint16_to_le(length);
+            builder->stats.saved_bytes += length;
+            return;
+        }
+        g_hash_table_insert(builder->strings, g_strndup(string, length), GUINT_TO_POINTER(builder->offset));
+    }
+
+    ++builder->stats.n_unique_keys;
+
     chunk = g_slice_new0(BuilderChunk);
     chunk->offset = builder->offset;
     if (length) {
@@ -179,24 +337,53 @@ static gpointer svdb_gvdbbuilder_allocate_chunk(GvdbBuilder *builder, guint alig
     return chunk->data;
 }
 
+/// @brief Write serialized value (normal form of 'v' variant) and point to it.
+/// @param bytes - value bytes (reference is taken).
+static void svdb_gvdbbuilder_add_value(GvdbBuilder *builder, GBytes *bytes, struct svdb_pointer *pointer) {
+    gsize size = g_bytes_get_size(bytes);
+    gpointer data;
+
+    ++builder->stats.n_values;
+
+    // Values in normal form are equal iff bytes are equal, so equal values can point to one copy.
+    if (builder->values) {
+        struct svdb_pointer *written = g_hash_table_lookup(builder->values, bytes);
+
+        if (written) {
+            *pointer = *written;
+            builder->stats.saved_bytes += size;
+            g_bytes_unref(bytes);
+            return;
+        }
+    }
+
+    data = svdb_gvdbbuilder_allocate_chunk(builder, 8, size, pointer);
+    if (data) {
+        memcpy(data, g_bytes_get_data(bytes, NULL), size);
+    }
+    ++builder->stats.n_unique_values;
+
+    if (builder->values) {
+        g_hash_table_insert(builder->values, bytes, g_memdup2(pointer, sizeof *pointer));
+    } else {
+        g_bytes_unref(bytes);
+    }
+}
+
 static guint32_le svdb_gvdbbuilder_add_variant(GvdbBuilder *builder, SvdbTableItem *item,
                                                gboolean byteswap, BucketCounter *counter, const guint32_le *buckets,
-                                               const gchar *key, guint32_le parent,
+                                               const gchar *key, guint32_le parent, guint32 parent_hash,
                                                struct svdb_hash_item *hash_item, GError **error) {
     GVariant *variant, *normal;
-    gpointer data;
     guint32 hash;
-    guint32 bucket;
-    guint32 bucket_index;
     guint32 index;
-    gsize size;
     GError *tmp_error = NULL;
 
     if (!builder || !item || item->type != SVDB_TYPE_VARIANT || !counter || !buckets || !hash_item) {
         return guint32_to_le(-1);
     }
 
-    hash = svdb_hash(key, NULL);
+    hash = svdb_hash_append(parent_hash, key, NULL);
     index = svdb_bucketcounter_get_item_index(counter, buckets, hash);
 
     if (hash_item[index].hash_value.value != 0) {
@@ -207,7 +394,8 @@ static guint32_le svdb_gvdbbuilder_add_variant(GvdbBuilder *builder, SvdbTableIt
     hash_item[index].parent = parent;
     hash_item[index].type = svdb_item_type_to_char(SVDB_TYPE_VARIANT);
 
-    if (byteswap) {
+    // Foreign value, that isn't swapped yet, can be written into foreign file as is.
+    if (byteswap != item->byteswapped) {
         normal = g_variant_byteswap(item->variant);
         variant = g_variant_new_variant(normal);
         g_variant_unref(normal);
@@ -227,9 +415,15 @@ static guint32_le svdb_gvdbbuilder_add_variant(GvdbBuilder *builder, SvdbTableIt
     normal = g_variant_get_normal_form(variant);
     g_variant_unref(variant);
 
-    size = g_variant_get_size(normal);
-    data = svdb_gvdbbuilder_allocate_chunk(builder, 8, size, &hash_item[index].value.pointer);
-    g_variant_store(normal, data);
+    if ((builder->flags & SVDB_WRITE_LOCALITY) && g_variant_get_size(normal) > SVDB_LAYOUT_SMALL_VALUE) {
+        BuilderPending *pending = g_slice_new0(BuilderPending);
+
+        pending->bytes = g_variant_get_data_as_bytes(normal);
+        pending->pointer = &hash_item[index].value.pointer;
+        g_queue_push_tail(builder->pending_values, pending);
+    } else {
+        svdb_gvdbbuilder_add_value(builder, g_variant_get_data_as_bytes(normal), &hash_item[index].value.pointer);
+    }
     g_variant_unref(normal);
     return guint32_to_le(index);
 }
@@ -237,17 +431,76 @@ static guint32_le svdb_gvdbbuilder_add_variant(GvdbBuilder *builder, SvdbTableIt
 static guint32_le svdb_gvdbbuilder_add_list(GvdbBuilder *builder, SvdbTableItem *list,
                                             gboolean byteswap,
                                             BucketCounter *counter, const guint32_le *buckets,
-                                            const gchar *key, guint32_le parent,
-                                            struct svdb_hash_item *hash_item, GError **error) {
+                                            const gchar *key, const gchar *path, guint32_le parent,
+                                            guint32 parent_hash, struct svdb_hash_item *hash_item, GError **error);
+
+/// @brief Write list elements (indexes of child items) and its children.
+/// @param path - full path of list in table (or NULL, if there is no access profile).
+static gboolean svdb_gvdbbuilder_add_list_content(GvdbBuilder *builder, SvdbTableItem *list, gboolean byteswap,
+                                                  BucketCounter *counter, const guint32_le *buckets,
+                                                  guint32 index, guint32 hash, const gchar *path,
+                                                  struct svdb_hash_item *hash_item, GError **error) {
+    guint32_le current_index = guint32_to_le(index);
+    guint32_le *list_content;
+    SvdbListElement *children;
+    gsize length;
+    GError *tmp_error = NULL;
+
+    list_content = svdb_gvdbbuilder_allocate_chunk(builder, 4, 4 * list->length,
+                                                   &hash_item[index].value.pointer);
+
+    // Elements are written in key order, so equal lists give equal bytes.
+    children = svdb_item_sorted_children(list, &length);
+
+    for (gsize i = 0; i < length; ++i) {
+        gchar *child_path = NULL;
+
+        if (g_cancellable_set_error_if_cancelled(builder->cancellable, &tmp_error)) {
+            g_propagate_error(error, tmp_error);
+            g_free(children);
+            return FALSE;
+        }
+
+        switch (children[i].item->type) {
+            case SVDB_TYPE_VARIANT:
+                list_content[i] = svdb_gvdbbuilder_add_variant(builder, children[i].item, byteswap, counter,
+                                                               buckets, children[i].key, current_index, hash, hash_item,
+                                                               &tmp_error);
+                break;
+            case SVDB_TYPE_LIST:
+                if (path) {
+                    child_path = g_strconcat(path, children[i].key, NULL);
+                }
+                list_content[i] = svdb_gvdbbuilder_add_list(builder, children[i].item, byteswap, counter,
+                                                            buckets, children[i].key, child_path, current_index, hash,
+                                                            hash_item, &tmp_error);
+                g_free(child_path);
+                break;
+        }
+        if (tmp_error) {
+            g_propagate_error(error, tmp_error);
+            g_free(children);
+            return FALSE;
+        }
+    }
+
+    g_free(children);
+    return TRUE;
+}
+
+/// @param path - full path of list in table (or NULL, if there is no access profile).
+static guint32_le svdb_gvdbbuilder_add_list(GvdbBuilder *builder, SvdbTableItem *list,
+                                            gboolean byteswap,
+                                            BucketCounter *counter, const guint32_le *buckets,
+                                            const gchar *key, const gchar *path, guint32_le parent,
+                                            guint32 parent_hash, struct svdb_hash_item *hash_item, GError **error) {
     if (!builder || !list || list->type != SVDB_TYPE_LIST || !counter || !buckets || !hash_item) {
         g_set_error_literal(error, SVDB_ERROR, 0, "internal error(trying add non-list item in add_list function)");
         return guint32_to_le(-1);
     }
 
-    guint32 hash = svdb_hash(key, NULL);
+    guint32 hash = svdb_hash_append(parent_hash, key, NULL);
     guint32 index = svdb_bucketcounter_get_item_index(counter, buckets, hash);
-    guint32_le current_index = guint32_to_le(index);
-    guint32_le *list_content;
     GError *tmp_error = NULL;
 
     if (hash_item[index].hash_value.value != 0) {
@@ -265,66 +518,42 @@ static guint32_le svdb_gvdbbuilder_add_list(GvdbBuilder *builder, SvdbTableItem
         return guint32_to_le(-1);
     }
 
-    list_content = svdb_gvdbbuilder_allocate_chunk(builder, 4, 4 * list->length,
-                                                   &hash_item[index].value.pointer);
+    // Key is written next to keys of siblings, content is written when all lists before it are done.
+    if (builder->flags & SVDB_WRITE_LOCALITY) {
+        svdb_gvdbbuilder_defer_list(builder, list, index, hash, path);
+        return guint32_to_le(index);
+    }
 
-    for (int i = 0; i < list->length; ++i) {
-        switch (list->list[i].item->type) {
-            case SVDB_TYPE_VARIANT:
-                list_content[i] = svdb_gvdbbuilder_add_variant(builder, list->list[i].item, byteswap, counter,
-                                                               buckets, list->list[i].key, current_index, hash_item,
-                                                               &tmp_error);
-                if (tmp_error) {
-                    g_propagate_error(error, tmp_error);
-                    return guint32_to_le(-1);
-                }
-                break;
-            case SVDB_TYPE_LIST:
-                list_content[i] = svdb_gvdbbuilder_add_list(builder, list->list[i].item, byteswap, counter,
-                                                            buckets, list->list[i].key, current_index, hash_item,
-                                                            &tmp_error);
-                if (tmp_error) {
-                    g_propagate_error(error, tmp_error);
-                    return guint32_to_le(-1);
-                }
-                break;
-        }
+    if (!svdb_gvdbbuilder_add_list_content(builder, list, byteswap, counter, buckets, index, hash, path, hash_item,
+                                           error)) {
+        return guint32_to_le(-1);
     }
-    return current_index;
+    return guint32_to_le(index);
 }
 
 static guint32_le svdb_gvdbbuilder_add_table(GvdbBuilder *builder, SvdbTableItem *table,
                                              gboolean byteswap,
                                              BucketCounter *counter, const guint32_le *buckets,
-                                             const gchar *key, guint32_le parent,
+                                             const gchar *key, guint32_le parent, guint32 parent_hash,
                                              struct svdb_hash_item *hash_item, GError **error);
 
-static gboolean svdb_gvdbbuilder_add_table_content(GvdbBuilder *builder, SvdbTableItem *table,
-                                                   gboolean byteswap, struct svdb_pointer *pointer, GError **error) {
-    if (!builder || !table || table->type != SVDB_TYPE_TABLE) {
-        g_set_error_literal(error, SVDB_ERROR, 0, "internal error(trying add non-table item in add_table function)");
-        return FALSE;
-    }
-
+/// @brief Allocate hash table (without bloom filter) and fill its buckets, items are filled by caller.
+/// @param n_items - count of items (and buckets).
+/// @param counter - counts of items hashes in buckets.
+static gboolean svdb_gvdbbuilder_add_hash_table(GvdbBuilder *builder, guint32 n_items, BucketCounter *counter,
+                                                struct svdb_pointer *pointer, guint32_le **buckets,
+                                                struct svdb_hash_item **items, GError **error) {
     guchar *data;
     guint32_le *bloom_filter, *hash_buckets;
     struct svdb_hash_item *hash_items;
-    BucketCounter *buckets_items = svdb_bucketcounter_new(table->childs);
-    GHashTableIter iter;
-    GError *tmp_error = NULL;
 
     const gsize bloom_shift = 5;
     const gsize n_bloom_words = 0;
     const guint32_le bloom_hdr = guint32_to_le(bloom_shift << 27 | n_bloom_words);
-    const guint32_le table_hdr = guint32_to_le(table->childs);
+    const guint32_le table_hdr = guint32_to_le(n_items);
 
     gsize size = sizeof bloom_hdr + sizeof table_hdr + n_bloom_words * sizeof(guint32_le)
-                 + table->childs * sizeof(guint32_le) + table->childs * sizeof(struct svdb_hash_item);
-
-    gchar *key;
-    SvdbTableItem *item;
-
-    svdb_bucketcounter_counter_table(buckets_items, table);
+                 + n_items * sizeof(guint32_le) + n_items * sizeof(struct svdb_hash_item);
 
     data = svdb_gvdbbuilder_allocate_chunk(builder, 4, size, pointer);
 
@@ -332,18 +561,18 @@ static gboolean svdb_gvdbbuilder_add_table_content(GvdbBuilder *builder, SvdbTab
     memcpy(chunk(sizeof bloom_hdr), &bloom_hdr, sizeof bloom_hdr);
     memcpy(chunk(sizeof table_hdr), &table_hdr, sizeof table_hdr);
     bloom_filter = (guint32_le *) chunk(n_bloom_words * sizeof(guint32_le));
-    hash_buckets = (guint32_le *) chunk(table->childs * sizeof(guint32_le));
-    hash_items = (struct svdb_hash_item *) chunk(table->childs * sizeof(struct svdb_hash_item));
+    hash_buckets = (guint32_le *) chunk(n_items * sizeof(guint32_le));
+    hash_items = (struct svdb_hash_item *) chunk(n_items * sizeof(struct svdb_hash_item));
     if (size != 0) {
         g_set_error(error, SVDB_ERROR, 0, "internal error(table header size calculation error)");
     }
 #undef chunk
 
-    memset(hash_buckets, 0, table->childs * sizeof(guint32_le));
-    memset(hash_items, 0, table->childs * sizeof(struct svdb_hash_item));
+    memset(hash_buckets, 0, n_items * sizeof(guint32_le));
+    memset(hash_items, 0, n_items * sizeof(struct svdb_hash_item));
 
-    for (int i = 1; i < table->childs; ++i) {
-        const guint32 tmp_bucket = svdb_bucketcounter_get(buckets_items, i - 1);
+    for (int i = 1; i < n_items; ++i) {
+        const guint32 tmp_bucket = svdb_bucketcounter_get(counter, i - 1);
 
         if (tmp_bucket == -1) {
             g_set_error_literal(error, SVDB_ERROR, 0,
@@ -355,42 +584,137 @@ static gboolean svdb_gvdbbuilder_add_table_content(GvdbBuilder *builder, SvdbTab
             guint32_from_le(hash_buckets[i - 1]) + tmp_bucket);
     }
 
+    *buckets = hash_buckets;
+    *items = hash_items;
+    return TRUE;
+}
+
+static gboolean svdb_gvdbbuilder_add_table_content(GvdbBuilder *builder, SvdbTableItem *table,
+                                                   gboolean byteswap, struct svdb_pointer *pointer, GError **error);
+
+/// @brief Write deferred parts of table (see SVDB_WRITE_LOCALITY): list contents with keys and small values of their
+/// children, then large values, then nested tables (large ones start on page boundary).
+static gboolean svdb_gvdbbuilder_add_pending(GvdbBuilder *builder, gboolean byteswap, BucketCounter *counter,
+                                             const guint32_le *buckets, struct svdb_hash_item *hash_items,
+                                             GError **error) {
+    BuilderPending *pending;
+    GQueue *tables;
+    gboolean result = TRUE;
+
+    while (result && (pending = g_queue_pop_head(builder->pending_lists))) {
+        result = svdb_gvdbbuilder_add_list_content(builder, pending->item, byteswap, counter, buckets, pending->index,
+                                                   pending->hash, pending->path, hash_items, error);
+        svdb_builderpending_free(pending);
+    }
+
+    while (result && (pending = g_queue_pop_head(builder->pending_values))) {
+        // Reference of bytes is taken by writer.
+        svdb_gvdbbuilder_add_value(builder, pending->bytes, pending->pointer);
+        pending->bytes = NULL;
+        svdb_builderpending_free(pending);
+    }
+
+    // Nested tables defer their own parts, so queue of this table is taken.
+    tables = builder->pending_tables;
+    builder->pending_tables = g_queue_new();
+
+    while (result && (pending = g_queue_pop_head(tables))) {
+        gsize hash_size = pending->item->childs * (sizeof(guint32_le) + sizeof(struct svdb_hash_item));
+
+        if (hash_size >= SVDB_LAYOUT_LARGE_TABLE) {
+            builder->offset += (guint64) (-builder->offset) & (SVDB_LAYOUT_PAGE_SIZE - 1);
+        }
+        result = svdb_gvdbbuilder_add_table_content(builder, pending->item, byteswap, pending->pointer, error);
+        svdb_builderpending_free(pending);
+    }
+
+    g_queue_free_full(tables, (GDestroyNotify) &svdb_builderpending_free);
+    return result;
+}
+
+static gboolean svdb_gvdbbuilder_add_table_content(GvdbBuilder *builder, SvdbTableItem *table,
+                                                   gboolean byteswap, struct svdb_pointer *pointer, GError **error) {
+    if (!builder || !table || table->type != SVDB_TYPE_TABLE) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "internal error(trying add non-table item in add_table function)");
+        return FALSE;
+    }
+
+    guint32_le *hash_buckets;
+    struct svdb_hash_item *hash_items;
+    BucketCounter *buckets_items = svdb_bucketcounter_new(table->childs);
+    SvdbListElement *children;
+    gsize length;
+    GError *tmp_error = NULL;
+
+    svdb_bucketcounter_counter_table(buckets_items, table);
+
+    if (!svdb_gvdbbuilder_add_hash_table(builder, table->childs, buckets_items, pointer, &hash_buckets, &hash_items,
+                                         error)) {
+        svdb_bucketcounter_free(buckets_items);
+        return FALSE;
+    }
+
     svdb_bucketcounter_free(buckets_items);
     buckets_items = svdb_bucketcounter_new(table->childs);
-    g_hash_table_iter_init(&iter, table->table);
 
-    while (g_hash_table_iter_next(&iter, (gpointer *) &key, (gpointer *) &item)) {
+    // Items are written in key order (not GHashTable one), so equal tables give equal bytes.
+    children = svdb_item_sorted_children(table, &length);
+
+    for (gsize i = 0; i < length; ++i) {
+        const gchar *key = children[i].key;
+        SvdbTableItem *item = children[i].item;
+
+        if (g_cancellable_set_error_if_cancelled(builder->cancellable, error)) {
+            svdb_bucketcounter_free(buckets_items);
+            g_free(children);
+            return FALSE;
+        }
+
         switch (item->type) {
             case SVDB_TYPE_LIST:
                 svdb_gvdbbuilder_add_list(builder, item, byteswap, buckets_items,
-                                          hash_buckets, key, guint32_to_le(-1), hash_items, &tmp_error);
+                                          hash_buckets, key, builder->profile ? key : NULL, guint32_to_le(-1),
+                                          SVDB_HASH_INITIAL, hash_items, &tmp_error);
                 if (tmp_error) {
                     g_propagate_error(error, tmp_error);
                     svdb_bucketcounter_free(buckets_items);
+                    g_free(children);
                     return FALSE;
                 }
                 break;
             case SVDB_TYPE_VARIANT:
                 svdb_gvdbbuilder_add_variant(builder, item, byteswap, buckets_items,
-                                             hash_buckets, key, guint32_to_le(-1), hash_items, &tmp_error);
+                                             hash_buckets, key, guint32_to_le(-1), SVDB_HASH_INITIAL, hash_items,
+                                             &tmp_error);
                 if (tmp_error) {
                     g_propagate_error(error, tmp_error);
                     svdb_bucketcounter_free(buckets_items);
+                    g_free(children);
                     return FALSE;
                 }
                 break;
             case SVDB_TYPE_TABLE:
                 svdb_gvdbbuilder_add_table(builder, item, byteswap, buckets_items,
-                                           hash_buckets, key, guint32_to_le(-1), hash_items, &tmp_error);
+                                           hash_buckets, key, guint32_to_le(-1), SVDB_HASH_INITIAL, hash_items,
+                                           &tmp_error);
                 if (tmp_error) {
                     g_propagate_error(error, tmp_error);
                     svdb_bucketcounter_free(buckets_items);
+                    g_free(children);
                     return FALSE;
                 }
                 break;
         }
     }
 
+    g_free(children);
+
+    if ((builder->flags & SVDB_WRITE_LOCALITY)
+        && !svdb_gvdbbuilder_add_pending(builder, byteswap, buckets_items, hash_buckets, hash_items, error)) {
+        svdb_bucketcounter_free(buckets_items);
+        return FALSE;
+    }
+
     svdb_bucketcounter_free(buckets_items);
     return TRUE;
 }
@@ -398,13 +722,13 @@ static gboolean svdb_gvdbbuilder_add_table_content(GvdbBuilder *builder, SvdbTab
 static guint32_le svdb_gvdbbuilder_add_table(GvdbBuilder *builder, SvdbTableItem *table,
                                              gboolean byteswap,
                                              BucketCounter *counter, const guint32_le *buckets,
-                                             const gchar *key, guint32_le parent,
+                                             const gchar *key, guint32_le parent, guint32 parent_hash,
                                              struct svdb_hash_item *hash_item, GError **error) {
     if (!builder || !table || table->type != SVDB_TYPE_TABLE || !counter || !buckets || !hash_item) {
         return guint32_to_le(-1);
     }
 
-    guint32 hash = svdb_hash(key, NULL);
+    guint32 hash = svdb_hash_append(parent_hash, key, NULL);
     guint32 index = svdb_bucketcounter_get_item_index(counter, buckets, hash);
     guint32_le current_index = guint32_to_le(index);
     GError *tmp_error = NULL;
@@ -424,6 +748,16 @@ static guint32_le svdb_gvdbbuilder_add_table(GvdbBuilder *builder, SvdbTableItem
         return guint32_to_le(-1);
     }
 
+    // Nested table is written after all dirs and values of this one.
+    if (builder->flags & SVDB_WRITE_LOCALITY) {
+        BuilderPending *pending = g_slice_new0(BuilderPending);
+
+        pending->item = table;
+        pending->pointer = &hash_item[index].value.pointer;
+        g_queue_push_tail(builder->pending_tables, pending);
+        return current_index;
+    }
+
     svdb_gvdbbuilder_add_table_content(builder, table, byteswap,
                                        &hash_item[index].value.pointer, &tmp_error);
     if (tmp_error) {
@@ -459,9 +793,7 @@ static GString *svdb_gvdbbuilder_serialize(GvdbBuilder *builder, gboolean bytesw
         BuilderChunk *chunk = g_queue_pop_head(builder->chunks);
 
         if (result->len != chunk->offset) {
-            gchar zero[8] = {
-                0,
-            };
+            gsize padding;
 
             if (chunk->offset < result->len) {
                 g_set_error_literal(error, SVDB_ERROR, 0,
@@ -470,23 +802,18 @@ static GString *svdb_gvdbbuilder_serialize(GvdbBuilder *builder, gboolean bytesw
                 g_slice_free(BuilderChunk, chunk);
                 goto error_exit;
             }
-            if ((chunk->offset - result->len) >= 8) {
+            // Chunks are aligned by 8 at most, but nested tables can start on page boundary (SVDB_WRITE_LOCALITY).
+            padding = chunk->offset - result->len;
+            if (padding >= ((builder->flags & SVDB_WRITE_LOCALITY) ? SVDB_LAYOUT_PAGE_SIZE : 8)) {
                 g_set_error_literal(error, SVDB_ERROR, 0,
-                                    "internal error(chunk offset greater than or equal to max align(8))");
+                                    "internal error(chunk offset greater than or equal to max align)");
                 g_free(chunk->data);
                 g_slice_free(BuilderChunk, chunk);
                 goto error_exit;
             }
 
-            g_string_append_len(result, zero, chunk->offset - result->len);
-
-            if (result->len != chunk->offset) {
-                g_set_error_literal(error, SVDB_ERROR, 0,
-                                    "internal error(chunk offset greater than or equal to max align(8))");
-                g_free(chunk->data);
-                g_slice_free(BuilderChunk, chunk);
-                goto error_exit;
-            }
+            g_string_set_size(result, chunk->offset);
+            memset(result->str + result->len - padding, 0, padding);
         }
 
         g_string_append_len(result, chunk->data, chunk->size);
@@ -506,7 +833,12 @@ error_exit:
     return NULL;
 }
 
-GBytes *svdb_table_get_raw(SvdbTableItem *table, gboolean byteswap, GError **error) {
+/// @brief Write table into GVDB bytes (see svdb_table_get_raw_full).
+/// @param profile - access profile for SVDB_WRITE_LOCALITY (see svdb_table_get_raw_profiled), or NULL.
+/// @param cancellable - checked while writing, or NULL.
+static GBytes *svdb_gvdbbuilder_write_table(SvdbTableItem *table, gboolean byteswap, SvdbWriteFlags flags,
+                                            const gchar *const *profile, SvdbWriteStats *stats,
+                                            GCancellable *cancellable, GError **error) {
     if (!table || table->type != SVDB_TYPE_TABLE) {
         return NULL;
     }
@@ -518,7 +850,11 @@ GBytes *svdb_table_get_raw(SvdbTableItem *table, gboolean byteswap, GError **err
     gsize str_len;
     GError *tmp_error = NULL;
 
-    builder = svdb_gvdbbuilder_new();
+    builder = svdb_gvdbbuilder_new(flags);
+    builder->cancellable = cancellable;
+    if (flags & SVDB_WRITE_LOCALITY) {
+        svdb_gvdbbuilder_set_profile(builder, profile);
+    }
     svdb_gvdbbuilder_add_table_content(builder, table, byteswap, &root, &tmp_error);
 
     if (tmp_error) {
@@ -539,10 +875,29 @@ GBytes *svdb_table_get_raw(SvdbTableItem *table, gboolean byteswap, GError **err
 
     res = g_bytes_new_take(g_string_free(str, FALSE), str_len);
 
+    if (stats) {
+        *stats = builder->stats;
+        stats->size = str_len;
+    }
+
     svdb_gvdbbuilder_free(builder);
     return res;
 }
 
+GBytes *svdb_table_get_raw_full(SvdbTableItem *table, gboolean byteswap, SvdbWriteFlags flags,
+                                SvdbWriteStats *stats, GError **error) {
+    return svdb_gvdbbuilder_write_table(table, byteswap, flags, NULL, stats, NULL, error);
+}
+
+GBytes *svdb_table_get_raw_profiled(SvdbTableItem *table, gboolean byteswap, SvdbWriteFlags flags,
+                                    const gchar *const *profile, SvdbWriteStats *stats, GError **error) {
+    return svdb_gvdbbuilder_write_table(table, byteswap, flags | SVDB_WRITE_LOCALITY, profile, stats, NULL, error);
+}
+
+GBytes *svdb_table_get_raw(SvdbTableItem *table, gboolean byteswap, GError **error) {
+    return svdb_table_get_raw_full(table, byteswap, SVDB_WRITE_DEDUP, NULL, error);
+}
+
 gboolean svdb_table_write_to_file(SvdbTableItem *table, const gchar *filename, gboolean byteswap,
                                   GError **error) {
     if (!table || table->type != SVDB_TYPE_TABLE || filename == NULL) {
@@ -0,0 +1,531 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_FILE
+#include "private_svdb_parse.c"
+#define LIBSVDB_PRIVATE_SVDB_FILE
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#include <immintrin.h>
+#define SVDB_FILE_SCAN_X86
+#endif
+
+/// @brief Start load of cache line, which will be read soon.
+#define SVDB_PREFETCH(address) __builtin_prefetch((address), 0, 1)
+
+/// @brief Lookup without parent check: key is full item name (name of all parents + key).
+#define SVDB_FILE_ANY_PARENT ((guint32) -2)
+
+/// @brief Content digest of item subtree (key, type and raw bytes of all values).
+typedef struct SvdbDigest_t
+{
+    guint64 words[2];
+    /// @brief 0 - not computed, 1 - computed, 2 - can't be computed (nested table or corrupted item).
+    guint8 state;
+} SvdbDigest;
+
+struct SvdbFile_t
+{
+    gatomicrefcount refcount;
+    /// @brief Whole GVDB file, values are slices of it.
+    GBytes *bytes;
+    gconstpointer data;
+    gsize size;
+    /// @brief Values are stored in foreign byte order.
+    gboolean byteswapped;
+    /// @brief Items have hashes of own key only, not of full name (files written by old svdb versions), so they are
+    /// looked up by walk from root items (see svdb_file_lookup_legacy).
+    gboolean legacy_hashes;
+    /// @brief Is trusted GVariant parse.
+    gboolean trusted;
+    /// @brief Access hints of mapping (see svdb_file_new_full).
+    SvdbLoadFlags flags;
+    /// @brief Root hash table of file.
+    SVDBTableHeader root;
+    /// @brief Lazily computed digests of root table items, or NULL (see svdb_file_item_digest).
+    SvdbDigest *digests;
+};
+
+static gboolean svdb_file_bloom_filter(const SVDBTableHeader *header, guint32 hash) {
+    guint32 word, mask;
+
+    if (header->n_bloom_words == 0) {
+        return TRUE;
+    }
+
+    word = (hash / 32) % header->n_bloom_words;
+    mask = 1u << (hash & 31);
+    mask |= 1u << ((hash >> header->bloom_shift) & 31);
+
+    return (guint32_from_le(header->bloom_words[word]) & mask) == mask;
+}
+
+/// @brief Scalar scan, see svdb_hash_items_scan.
+static guint32 svdb_hash_items_scan_scalar(const struct svdb_hash_item *items, guint32 begin, guint32 end,
+                                           guint32 hash) {
+    for (; begin < end; ++begin) {
+        if (guint32_from_le(items[begin].hash_value) == hash) {
+            break;
+        }
+    }
+    return begin;
+}
+
+#ifdef SVDB_FILE_SCAN_X86
+/// @brief SSE2 scan, compares 4 hashes per instruction (items are 24 bytes, so hashes are loaded one by one).
+static guint32 svdb_hash_items_scan_sse2(const struct svdb_hash_item *items, guint32 begin, guint32 end,
+                                         guint32 hash) {
+    const __m128i needle = _mm_set1_epi32((gint32) hash);
+
+    for (; begin + 4 <= end; begin += 4) {
+        const struct svdb_hash_item *chunk = items + begin;
+        __m128i values = _mm_setr_epi32((gint32) chunk[0].hash_value.value, (gint32) chunk[1].hash_value.value,
+                                        (gint32) chunk[2].hash_value.value, (gint32) chunk[3].hash_value.value);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(values, needle)));
+
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+
+    return svdb_hash_items_scan_scalar(items, begin, end, hash);
+}
+
+/// @brief AVX2 scan, gathers 8 hashes with stride of item size and compares them at once.
+__attribute__((target("avx2")))
+static guint32 svdb_hash_items_scan_avx2(const struct svdb_hash_item *items, guint32 begin, guint32 end,
+                                         guint32 hash) {
+    const gint stride = sizeof *items / sizeof(gint32);
+    const __m256i needle = _mm256_set1_epi32((gint32) hash);
+    const __m256i offsets = _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride,
+                                              4 * stride, 5 * stride, 6 * stride, 7 * stride);
+
+    for (; begin + 8 <= end; begin += 8) {
+        __m256i values = _mm256_i32gather_epi32((const int *) (items + begin), offsets, 4);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(values, needle)));
+
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+
+    return svdb_hash_items_scan_sse2(items, begin, end, hash);
+}
+#endif
+
+/// @brief Find first item in [begin, end) with given hash.
+/// @return index of item, or end if there is no such item.
+static guint32 svdb_hash_items_scan(const struct svdb_hash_item *items, guint32 begin, guint32 end, guint32 hash) {
+#ifdef SVDB_FILE_SCAN_X86
+    static gint has_avx2 = -1;
+
+    if G_UNLIKELY(has_avx2 < 0) {
+        __builtin_cpu_init();
+        has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+
+    if (end - begin >= 8 && has_avx2) {
+        return svdb_hash_items_scan_avx2(items, begin, end, hash);
+    }
+    return svdb_hash_items_scan_sse2(items, begin, end, hash);
+#else
+    return svdb_hash_items_scan_scalar(items, begin, end, hash);
+#endif
+}
+
+/// @brief Check item name. Key is full name, if expected_parent is SVDB_FILE_ANY_PARENT, else it is name relative
+/// to expected_parent item.
+static gboolean svdb_file_check_name(const SVDBTableHeader *header, gconstpointer data, gsize size,
+                                     const struct svdb_hash_item *item, const gchar *key, guint32 key_length,
+                                     guint32 expected_parent) {
+    // Bounded by items count, so corrupted parent cycles can't hang lookup.
+    for (guint32 depth = 0; depth < header->n_hash_items; ++depth) {
+        guint32 start = guint32_from_le(item->key_start);
+        guint32 length = guint16_from_le(item->key_size);
+        guint32 parent = guint32_from_le(item->parent);
+
+        if (expected_parent != SVDB_FILE_ANY_PARENT && parent != expected_parent) {
+            return FALSE;
+        }
+
+        if G_UNLIKELY((guint64) start + length > size) {
+            return FALSE;
+        }
+
+        if (length > key_length || memcmp((const gchar *) data + start, key + key_length - length, length) != 0) {
+            return FALSE;
+        }
+
+        key_length -= length;
+
+        if (expected_parent != SVDB_FILE_ANY_PARENT || parent == (guint32) -1) {
+            return key_length == 0;
+        }
+
+        if G_UNLIKELY(parent >= header->n_hash_items) {
+            return FALSE;
+        }
+
+        item = header->hash_items + parent;
+    }
+
+    return FALSE;
+}
+
+/// @brief Lookup item in hash table.
+/// @param hash - hash of full item name (see svdb_hash_append).
+/// @param expected_parent - index of parent item (key is name relative to it), or SVDB_FILE_ANY_PARENT.
+/// @return item or NULL.
+static const struct svdb_hash_item *svdb_file_lookup_item(const SVDBTableHeader *header, gconstpointer data,
+                                                          gsize size, const gchar *key, guint32 key_length,
+                                                          guint32 hash, guint32 expected_parent) {
+    guint32 bucket, itemno, lastno;
+
+    if (header->n_buckets == 0 || header->n_hash_items == 0) {
+        return NULL;
+    }
+
+    // Bucket load is started before bloom check, so both cache misses overlap.
+    bucket = hash % header->n_buckets;
+    SVDB_PREFETCH(header->hash_buckets + bucket);
+
+    if (!svdb_file_bloom_filter(header, hash)) {
+        return NULL;
+    }
+
+    itemno = guint32_from_le(header->hash_buckets[bucket]);
+
+    if (bucket == header->n_buckets - 1
+        || (lastno = guint32_from_le(header->hash_buckets[bucket + 1])) > header->n_hash_items) {
+        lastno = header->n_hash_items;
+    }
+
+    while (itemno < lastno) {
+        itemno = svdb_hash_items_scan(header->hash_items, itemno, lastno, hash);
+
+        if (itemno == lastno) {
+            break;
+        }
+
+        // Key bytes are touched only when hash is matched.
+        if (svdb_file_check_name(header, data, size, header->hash_items + itemno, key, key_length,
+                                 expected_parent)) {
+            return header->hash_items + itemno;
+        }
+        ++itemno;
+    }
+
+    return NULL;
+}
+
+/// @brief Lookup item of file with legacy hashes by full name. Own keys can have any length, so every prefix of name
+/// is looked up (by hash of it) among root items, and rest of name among children of found list, recursively.
+/// @param parent - index of list item, which children are looked up, or -1 for root items.
+static const struct svdb_hash_item *svdb_file_lookup_legacy(const SvdbFile *file, const gchar *key,
+                                                            guint32 key_length, guint32 parent) {
+    guint32 hash = SVDB_HASH_INITIAL;
+
+    for (guint32 length = 1; length <= key_length; ++length) {
+        const struct svdb_hash_item *item, *child;
+
+        hash = (hash * 33) + ((const signed char *) key)[length - 1];
+        item = svdb_file_lookup_item(&file->root, file->data, file->size, key, length, hash, parent);
+
+        if (!item) {
+            continue;
+        }
+        if (length == key_length) {
+            return item;
+        }
+        if (item->type == 'L') {
+            child = svdb_file_lookup_legacy(file, key + length, key_length - length,
+                                            (guint32) (item - file->root.hash_items));
+            if (child) {
+                return child;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief Lookup item of file by full name (parent keys + key).
+static const struct svdb_hash_item *svdb_file_find_item(const SvdbFile *file, const gchar *key) {
+    guint32 key_length;
+    guint32 hash = svdb_hash(key, &key_length);
+
+    if G_UNLIKELY(file->legacy_hashes) {
+        return svdb_file_lookup_legacy(file, key, key_length, (guint32) -1);
+    }
+    return svdb_file_lookup_item(&file->root, file->data, file->size, key, key_length, hash, SVDB_FILE_ANY_PARENT);
+}
+
+/// @brief Check, whether hashes of items are legacy ones (see SvdbFile.legacy_hashes). Both schemes give same hashes
+/// for root items, so first child item is checked.
+static gboolean svdb_file_has_legacy_hashes(const SVDBTableHeader *header, gconstpointer data, gsize size) {
+    for (guint32 i = 0; i < header->n_hash_items; ++i) {
+        const struct svdb_hash_item *item = header->hash_items + i;
+        guint32 start = guint32_from_le(item->key_start);
+        guint32 length = guint16_from_le(item->key_size);
+        guint32 hash = SVDB_HASH_INITIAL;
+
+        if (guint32_from_le(item->parent) == (guint32) -1) {
+            continue;
+        }
+        // Lookups in corrupted file fail in both schemes.
+        if G_UNLIKELY((guint64) start + length > size) {
+            return FALSE;
+        }
+
+        for (guint32 j = 0; j < length; ++j) {
+            hash = (hash * 33) + ((const signed char *) data)[start + j];
+        }
+        return guint32_from_le(item->hash_value) == hash;
+    }
+
+    return FALSE;
+}
+
+/// @brief Get value of variant item without copying, as slice of file bytes.
+static GVariant *svdb_file_item_get_value(const SvdbFile *file, const struct svdb_hash_item *item) {
+    GVariant *variant, *value;
+    gconstpointer data;
+    GBytes *bytes;
+    gsize size;
+
+    data = svdb_table_dereference(file->data, file->size, item->value.pointer, 8, &size);
+
+    if G_UNLIKELY(data == NULL) {
+        return NULL;
+    }
+
+    bytes = g_bytes_new_from_bytes(file->bytes, (const gchar *) data - (const gchar *) file->data, size);
+    variant = g_variant_new_from_bytes(G_VARIANT_TYPE_VARIANT, bytes, file->trusted);
+    value = g_variant_get_variant(variant);
+    g_variant_unref(variant);
+    g_bytes_unref(bytes);
+
+    if (file->byteswapped) {
+        GVariant *swapped = g_variant_byteswap(value);
+
+        g_variant_unref(value);
+        value = swapped;
+    }
+
+    return value;
+}
+
+SvdbFile *svdb_file_new_from_bytes(GBytes *bytes, gboolean trusted, GError **error) {
+    const struct svdb_header *header;
+    SvdbFile *file;
+    gboolean byteswapped;
+    gconstpointer data;
+    gsize size;
+
+    if (!bytes) {
+        return NULL;
+    }
+
+    data = g_bytes_get_data(bytes, &size);
+
+    if (!svdb_gvdb_header_check(data, size, &byteswapped)) {
+        g_set_error_literal(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "corrupted gvdb file(invalid gvdb header)");
+        return NULL;
+    }
+
+    header = data;
+    file = g_new0(SvdbFile, 1);
+
+    if (!svdb_parse_table_header(data, size, header->root, &file->root)) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid table header)");
+        g_free(file);
+        return NULL;
+    }
+
+    g_atomic_ref_count_init(&file->refcount);
+    file->bytes = g_bytes_ref(bytes);
+    file->data = data;
+    file->size = size;
+    file->byteswapped = byteswapped;
+    file->legacy_hashes = svdb_file_has_legacy_hashes(&file->root, data, size);
+    file->trusted = trusted;
+
+    return file;
+}
+
+SvdbFile *svdb_file_new_full(const gchar *filename, gboolean trusted, SvdbLoadFlags flags, GError **error) {
+    SvdbFile *file;
+    GBytes *bytes;
+
+    bytes = svdb_mmap_file(filename, flags, error);
+    if (!bytes) {
+        g_prefix_error(error, "%s: ", filename);
+        return NULL;
+    }
+
+    file = svdb_file_new_from_bytes(bytes, trusted, error);
+    g_bytes_unref(bytes);
+
+    if (file) {
+        file->flags = flags;
+        if (flags & SVDB_LOAD_RANDOM) {
+            svdb_mmap_prefetch_table(&file->root);
+        }
+    }
+
+    g_prefix_error(error, "%s: ", filename);
+
+    return file;
+}
+
+SvdbFile *svdb_file_new(const gchar *filename, gboolean trusted, GError **error) {
+    return svdb_file_new_full(filename, trusted, SVDB_LOAD_RANDOM, error);
+}
+
+SvdbFile *svdb_file_ref(SvdbFile *file) {
+    if (!file) {
+        return NULL;
+    }
+    g_atomic_ref_count_inc(&file->refcount);
+    return file;
+}
+
+void svdb_file_unref(SvdbFile *file) {
+    if (!file) {
+        return;
+    }
+    if (g_atomic_ref_count_dec(&file->refcount)) {
+        g_bytes_unref(file->bytes);
+        g_free(file->digests);
+        g_free(file);
+    }
+}
+
+GVariant *svdb_file_read(SvdbFile *file, const gchar *key, GError **error) {
+    const struct svdb_hash_item *item;
+    GVariant *value;
+
+    if (!file || !key) {
+        return NULL;
+    }
+
+    item = svdb_file_find_item(file, key);
+
+    if (!item || item->type != 'v') {
+        return NULL;
+    }
+
+    value = svdb_file_item_get_value(file, item);
+
+    if (!value) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+    }
+
+    return value;
+}
+
+GBytes *svdb_file_read_raw(SvdbFile *file, const gchar *key, GError **error) {
+    const struct svdb_hash_item *item;
+    GVariant *value, *variant;
+    gconstpointer data;
+    gsize size;
+    GBytes *bytes;
+
+    if (!file || !key) {
+        return NULL;
+    }
+
+    item = svdb_file_find_item(file, key);
+
+    if (!item || item->type != 'v') {
+        return NULL;
+    }
+
+    // Stored item is serialized variant already, so it's returned as is (without decoding of value).
+    if (!file->byteswapped) {
+        data = svdb_table_dereference(file->data, file->size, item->value.pointer, 8, &size);
+
+        if G_UNLIKELY(data == NULL) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+            return NULL;
+        }
+        return g_bytes_new_from_bytes(file->bytes, (const gchar *) data - (const gchar *) file->data, size);
+    }
+
+    value = svdb_file_item_get_value(file, item);
+    if (!value) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+        return NULL;
+    }
+
+    variant = g_variant_ref_sink(g_variant_new_variant(value));
+    bytes = g_variant_get_data_as_bytes(variant);
+    g_variant_unref(variant);
+    g_variant_unref(value);
+    return bytes;
+}
+
+static gint svdb_file_key_compare(gconstpointer a, gconstpointer b) {
+    return strcmp(*(const gchar *const *) a, *(const gchar *const *) b);
+}
+
+gchar **svdb_file_list(SvdbFile *file, const gchar *dir, gsize *length, GError **error) {
+    const struct svdb_hash_item *item;
+    const guint32_le *indecies;
+    GPtrArray *keys;
+    guint32 index;
+    guint count;
+
+    if (length) {
+        *length = 0;
+    }
+    if (!file || !dir) {
+        return NULL;
+    }
+
+    // Only dir item and its children are touched, other items aren't read at all.
+    item = svdb_file_find_item(file, dir);
+
+    if (!item || item->type != 'L') {
+        return NULL;
+    }
+
+    if (!svdb_table_list_indecies_from_item(file->data, file->size, item, &indecies, &count)) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(corrupted list)");
+        return NULL;
+    }
+
+    index = item - file->root.hash_items;
+    keys = g_ptr_array_sized_new(count + 1);
+
+    for (guint i = 0; i < count; ++i) {
+        guint32 itemno = guint32_from_le(indecies[i]);
+        const struct svdb_hash_item *child;
+        guint32 start, size;
+
+        if (itemno >= file->root.n_hash_items || guint32_from_le(file->root.hash_items[itemno].parent) != index) {
+            continue;
+        }
+
+        child = file->root.hash_items + itemno;
+        start = guint32_from_le(child->key_start);
+        size = guint16_from_le(child->key_size);
+
+        if G_UNLIKELY((guint64) start + size > file->size) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(key out of bounds)");
+            g_ptr_array_set_free_func(keys, &g_free);
+            g_ptr_array_unref(keys);
+            return NULL;
+        }
+
+        g_ptr_array_add(keys, g_strndup((const gchar *) file->data + start, size));
+    }
+
+    // Sorted, so output doesn't depend on list order in file.
+    g_ptr_array_sort(keys, svdb_file_key_compare);
+
+    if (length) {
+        *length = keys->len;
+    }
+    g_ptr_array_add(keys, NULL);
+    return (gchar **) g_ptr_array_free(keys, FALSE);
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_FILE
@@ -0,0 +1,156 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_FIND
+#include "private_svdb_visit.c"
+#define LIBSVDB_PRIVATE_SVDB_FIND
+
+typedef struct SvdbFinder_t
+{
+    SvdbFindMode mode;
+    const gchar *pattern;
+    gsize pattern_length;
+    GRegex *regex;
+    const GVariantType *type;
+    GVariant *value;
+    SvdbFindFunc func;
+    gpointer user_data;
+    /// @brief Root table is entered (nested tables are skipped).
+    gboolean entered;
+    /// @brief Value is corrupted.
+    gboolean corrupted;
+} SvdbFinder;
+
+/// @brief Match glob pattern ('*' - any string, including '/'; '?' - any character).
+/// @param partial - TRUE => check if some continuation of string can match pattern.
+static gboolean svdb_glob_match(const gchar *pattern, const gchar *string, gboolean partial) {
+    const gchar *star = NULL;
+    const gchar *star_string = NULL;
+
+    while (*string) {
+        if (*pattern == '*') {
+            star = ++pattern;
+            star_string = string;
+        } else if (*pattern && (*pattern == '?' || *pattern == *string)) {
+            ++pattern, ++string;
+        } else if (star) {
+            pattern = star;
+            string = ++star_string;
+        } else {
+            return FALSE;
+        }
+    }
+
+    if (partial) {
+        return TRUE;
+    }
+
+    while (*pattern == '*') {
+        ++pattern;
+    }
+    return *pattern == '\0';
+}
+
+/// @brief Match current name.
+/// @param partial - TRUE => check if name of some child item can match (for subtree pruning).
+static gboolean svdb_finder_match(const SvdbFinder *finder, const gchar *name, gboolean partial) {
+    switch (finder->mode) {
+        case SVDB_FIND_PREFIX:
+            if (partial) {
+                return strncmp(name, finder->pattern, MIN(strlen(name), finder->pattern_length)) == 0;
+            }
+            return strncmp(name, finder->pattern, finder->pattern_length) == 0;
+        case SVDB_FIND_GLOB:
+            return svdb_glob_match(finder->pattern, name, partial);
+        case SVDB_FIND_REGEX:
+            // Partial match is reported only if match reaches end of name, so unanchored patterns (like `lock` or
+            // `1$`) would prune dirs, which contain matching keys. Every value name is tested instead.
+            if (partial) {
+                return TRUE;
+            }
+            return g_regex_match(finder->regex, name, 0, NULL);
+    }
+
+    return FALSE;
+}
+
+static SvdbVisitResult svdb_finder_visit(SvdbVisitEvent event, const gchar *name, const gchar *key,
+                                         SvdbFileValue *file_value, gpointer user_data) {
+    SvdbFinder *finder = user_data;
+    GVariant *value;
+
+    switch (event) {
+        case SVDB_VISIT_ENTER_TABLE:
+            // Nested tables are not a part of root table key space.
+            if (finder->entered) {
+                return SVDB_VISIT_SKIP;
+            }
+            finder->entered = TRUE;
+            return SVDB_VISIT_CONTINUE;
+        case SVDB_VISIT_ENTER_LIST:
+            // Prune subtree, if no child name can match.
+            return svdb_finder_match(finder, name, TRUE) ? SVDB_VISIT_CONTINUE : SVDB_VISIT_SKIP;
+        case SVDB_VISIT_VALUE:
+            if (!svdb_finder_match(finder, name, FALSE)) {
+                return SVDB_VISIT_CONTINUE;
+            }
+
+            // Values are decoded only for matched names.
+            value = svdb_file_value_get_variant(file_value);
+
+            if (!value) {
+                finder->corrupted = TRUE;
+                return SVDB_VISIT_STOP;
+            }
+
+            if ((!finder->type || g_variant_is_of_type(value, finder->type))
+                && (!finder->value || g_variant_equal(value, finder->value))
+                && !finder->func(name, value, finder->user_data)) {
+                return SVDB_VISIT_STOP;
+            }
+            return SVDB_VISIT_CONTINUE;
+        default:
+            return SVDB_VISIT_CONTINUE;
+    }
+}
+
+gboolean svdb_file_find(SvdbFile *file, const gchar *pattern, SvdbFindMode mode, const GVariantType *type,
+                        GVariant *value, SvdbFindFunc func, gpointer user_data, GError **error) {
+    SvdbFinder finder = {0};
+    gboolean result;
+
+    if (!file || !func) {
+        return FALSE;
+    }
+
+    if (!pattern) {
+        pattern = "";
+    }
+
+    finder.mode = mode;
+    finder.pattern = pattern;
+    finder.pattern_length = strlen(pattern);
+    finder.type = type;
+    finder.value = value;
+    finder.func = func;
+    finder.user_data = user_data;
+
+    if (mode == SVDB_FIND_REGEX) {
+        finder.regex = g_regex_new(pattern, G_REGEX_OPTIMIZE, 0, error);
+        if (!finder.regex) {
+            return FALSE;
+        }
+    }
+
+    result = svdb_file_visit(file, svdb_finder_visit, &finder, error);
+
+    if (result && finder.corrupted) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+        result = FALSE;
+    }
+
+    if (finder.regex) {
+        g_regex_unref(finder.regex);
+    }
+
+    return result;
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_FIND
@@ -0,0 +1,128 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_MMAP
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include "private_svdb_common.c"
+#define LIBSVDB_PRIVATE_SVDB_MMAP
+
+typedef struct SvdbMapping_t
+{
+    gpointer data;
+    gsize size;
+} SvdbMapping;
+
+static void svdb_mapping_free(gpointer user_data) {
+    SvdbMapping *mapping = user_data;
+
+    munmap(mapping->data, mapping->size);
+    g_slice_free(SvdbMapping, mapping);
+}
+
+/// @brief Give access pattern hint for range of mapping (range is expanded to pages, errors are ignored: it's only
+/// hint, and memory may be not mapped from file at all).
+static void svdb_mmap_advise(gconstpointer data, gsize size, gint advice) {
+    static gsize page_size = 0;
+    guintptr start, end;
+
+    if (!data || !size) {
+        return;
+    }
+
+    if (!page_size) {
+        page_size = sysconf(_SC_PAGESIZE);
+    }
+
+    start = (guintptr) data & ~(guintptr) (page_size - 1);
+    end = (guintptr) data + size;
+    madvise((gpointer) start, end - start, advice);
+}
+
+/// @brief Ask kernel to read in bloom filter, buckets and hash items of table before it is probed (they are stored
+/// together after table header).
+static void svdb_mmap_prefetch_table(const SVDBTableHeader *header) {
+#ifdef MADV_WILLNEED
+    const gchar *start = (const gchar *) header->bloom_words;
+    const gchar *end = (const gchar *) (header->hash_items + header->n_hash_items);
+
+    if (start && end > start) {
+        svdb_mmap_advise(start, end - start, MADV_WILLNEED);
+    }
+#endif
+}
+
+/// @brief Map file read-only with access pattern hints.
+/// @return file bytes (mapping is unmapped with last reference), or NULL.
+static GBytes *svdb_mmap_file(const gchar *filename, SvdbLoadFlags flags, GError **error) {
+    SvdbMapping *mapping;
+    struct stat st;
+    gpointer data;
+    gint map_flags = MAP_PRIVATE;
+    gint fd, errsv;
+
+    fd = g_open(filename, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        errsv = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errsv), "open() failed: %s", g_strerror(errsv));
+        return NULL;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        errsv = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errsv), "fstat() failed: %s", g_strerror(errsv));
+        close(fd);
+        return NULL;
+    }
+
+    // Empty file can't be mapped, header check fails on it later.
+    if (st.st_size == 0) {
+        close(fd);
+        return g_bytes_new(NULL, 0);
+    }
+
+    if ((guint64) st.st_size > G_MAXSIZE) {
+        g_set_error_literal(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "file is too large");
+        close(fd);
+        return NULL;
+    }
+
+#ifdef MAP_POPULATE
+    if (flags & SVDB_LOAD_POPULATE) {
+        map_flags |= MAP_POPULATE;
+    }
+#endif
+
+    data = mmap(NULL, st.st_size, PROT_READ, map_flags, fd, 0);
+    errsv = errno;
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errsv), "mmap() failed: %s", g_strerror(errsv));
+        return NULL;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    if (flags & SVDB_LOAD_SEQUENTIAL) {
+        svdb_mmap_advise(data, st.st_size, MADV_SEQUENTIAL);
+    }
+#endif
+#ifdef MADV_RANDOM
+    if (flags & SVDB_LOAD_RANDOM) {
+        svdb_mmap_advise(data, st.st_size, MADV_RANDOM);
+    }
+#endif
+#if !defined(MAP_POPULATE) && defined(MADV_WILLNEED)
+    if (flags & SVDB_LOAD_POPULATE) {
+        svdb_mmap_advise(data, st.st_size, MADV_WILLNEED);
+    }
+#endif
+
+    mapping = g_slice_new(SvdbMapping);
+    mapping->data = data;
+    mapping->size = st.st_size;
+    return g_bytes_new_with_free_func(data, st.st_size, svdb_mapping_free, mapping);
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_MMAP
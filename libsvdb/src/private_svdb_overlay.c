@@ -0,0 +1,603 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_OVERLAY
+#include "private_svdb_file.c"
+#include "private_svdb_export.c"
+#define LIBSVDB_PRIVATE_SVDB_OVERLAY
+
+/// @brief Changed dir of overlay.
+typedef struct SvdbOverlayDir_t
+{
+    /// @brief Changed keys, key => value (NULL for removed key).
+    GHashTable *keys;
+    /// @brief Changed subdirs, key (with trailing '/') => dir (borrowed).
+    GHashTable *dirs;
+    /// @brief List item of dir in base file, or NULL if dir is new.
+    const struct svdb_hash_item *item;
+} SvdbOverlayDir;
+
+struct SvdbOverlay_t
+{
+    /// @brief Base file, or NULL (empty).
+    SvdbFile *base;
+    /// @brief Changed dirs, full path => dir. Root table is dir with empty path, its only subdir is "/".
+    GHashTable *dirs;
+};
+
+/// @brief Item of written table: item of base file (copied as is), or new/changed item of overlay.
+typedef struct SvdbOverlayEntry_t
+{
+    /// @brief Item of base file, or NULL for new item.
+    const struct svdb_hash_item *item;
+    /// @brief Own key (borrowed from base file or overlay, isn't NUL-terminated).
+    const gchar *key;
+    gsize key_length;
+    /// @brief New value (borrowed from overlay), or NULL.
+    GVariant *value;
+    /// @brief Changed dir of list (borrowed from overlay), or NULL.
+    SvdbOverlayDir *dir;
+    guint32 hash;
+    /// @brief Index of parent entry, or -1.
+    guint32 parent;
+    gchar type;
+    /// @brief Count of children (for list).
+    guint32 length;
+    /// @brief Index of item in written table.
+    guint32 index;
+    /// @brief Written children indexes (for list) and count of filled ones.
+    guint32_le *content;
+    guint32 filled;
+} SvdbOverlayEntry;
+
+static void svdb_overlay_value_free(GVariant *value) {
+    if (value) {
+        g_variant_unref(value);
+    }
+}
+
+static void svdb_overlay_dir_free(SvdbOverlayDir *dir) {
+    g_hash_table_unref(dir->keys);
+    g_hash_table_unref(dir->dirs);
+    g_free(dir);
+}
+
+/// @brief Lookup item of base file by full name.
+static const struct svdb_hash_item *svdb_overlay_base_lookup(SvdbOverlay *overlay, const gchar *name, gsize length) {
+    SvdbFile *base = overlay->base;
+    gchar *key;
+    const struct svdb_hash_item *item;
+
+    if (!base) {
+        return NULL;
+    }
+
+    key = g_strndup(name, length);
+    item = svdb_file_find_item(base, key);
+    g_free(key);
+    return item;
+}
+
+/// @brief Get changed dir, creating it and missing parent dirs.
+/// @param path - dir path (starts and ends with '/'), or empty for root table.
+/// @param length - length of dir path.
+static SvdbOverlayDir *svdb_overlay_get_dir(SvdbOverlay *overlay, const gchar *path, gsize length) {
+    gchar *dir_path = g_strndup(path, length);
+    SvdbOverlayDir *dir = g_hash_table_lookup(overlay->dirs, dir_path);
+    SvdbOverlayDir *parent;
+    gsize parent_length;
+
+    if (dir) {
+        g_free(dir_path);
+        return dir;
+    }
+
+    // Root table (empty path) always exists, so parent dir is found.
+    parent_length = length - 1;
+    while (parent_length > 0 && path[parent_length - 1] != '/') {
+        --parent_length;
+    }
+    parent = svdb_overlay_get_dir(overlay, path, parent_length);
+
+    dir = g_new0(SvdbOverlayDir, 1);
+    dir->keys = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
+                                      (GDestroyNotify) &svdb_overlay_value_free);
+    dir->dirs = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free, NULL);
+    dir->item = svdb_overlay_base_lookup(overlay, path, length);
+
+    g_hash_table_insert(parent->dirs, g_strdup(dir_path + parent_length), dir);
+    g_hash_table_insert(overlay->dirs, dir_path, dir);
+    return dir;
+}
+
+/// @brief Check key path (must start with '/', and doesn't end with '/') and dirs of it in base file.
+/// @return offset of key in path, or 0 if path is invalid.
+static gsize svdb_overlay_check_path(SvdbOverlay *overlay, const gchar *path, GError **error) {
+    gsize length = path ? strlen(path) : 0;
+    const gchar *last;
+
+    if (length < 2 || path[0] != '/' || path[length - 1] == '/' || strstr(path, "//")) {
+        g_set_error(error, SVDB_ERROR, 0, "invalid key path(%s)", path ? path : "");
+        return 0;
+    }
+
+    for (const gchar *end = path; end; end = strchr(end + 1, '/')) {
+        const struct svdb_hash_item *item = svdb_overlay_base_lookup(overlay, path, end - path + 1);
+
+        if (item && svdb_item_char_to_type(item->type) != SVDB_TYPE_LIST) {
+            g_set_error(error, SVDB_ERROR, 0, "trying to change dir of non-list item(%.*s)",
+                        (gint) (end - path + 1), path);
+            return 0;
+        }
+    }
+
+    last = strrchr(path, '/');
+    return last - path + 1;
+}
+
+SvdbOverlay *svdb_overlay_new(SvdbFile *base) {
+    SvdbOverlay *overlay = g_new0(SvdbOverlay, 1);
+    SvdbOverlayDir *root = g_new0(SvdbOverlayDir, 1);
+
+    overlay->base = svdb_file_ref(base);
+    overlay->dirs = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
+                                          (GDestroyNotify) &svdb_overlay_dir_free);
+
+    root->keys = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
+                                       (GDestroyNotify) &svdb_overlay_value_free);
+    root->dirs = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free, NULL);
+    g_hash_table_insert(overlay->dirs, g_strdup(""), root);
+
+    return overlay;
+}
+
+void svdb_overlay_free(SvdbOverlay *overlay) {
+    if (!overlay) {
+        return;
+    }
+    g_hash_table_unref(overlay->dirs);
+    svdb_file_unref(overlay->base);
+    g_free(overlay);
+}
+
+gboolean svdb_overlay_set(SvdbOverlay *overlay, const gchar *path, GVariant *value, GError **error) {
+    SvdbOverlayDir *dir;
+    gsize offset;
+
+    if (!overlay || !value) {
+        return FALSE;
+    }
+
+    offset = svdb_overlay_check_path(overlay, path, error);
+    if (!offset) {
+        return FALSE;
+    }
+
+    dir = svdb_overlay_get_dir(overlay, path, offset);
+    g_hash_table_replace(dir->keys, g_strdup(path + offset), g_variant_ref_sink(value));
+    return TRUE;
+}
+
+gboolean svdb_overlay_unset(SvdbOverlay *overlay, const gchar *path, GError **error) {
+    const struct svdb_hash_item *item;
+    SvdbOverlayDir *dir;
+    gchar *dir_path;
+    gsize offset;
+
+    if (!overlay) {
+        return FALSE;
+    }
+
+    offset = svdb_overlay_check_path(overlay, path, error);
+    if (!offset) {
+        return FALSE;
+    }
+
+    item = svdb_overlay_base_lookup(overlay, path, strlen(path));
+
+    // Key of base file is hidden, new key is just forgotten (so missing dirs aren't created by unset).
+    if (item && svdb_item_char_to_type(item->type) == SVDB_TYPE_VARIANT) {
+        dir = svdb_overlay_get_dir(overlay, path, offset);
+        g_hash_table_replace(dir->keys, g_strdup(path + offset), NULL);
+        return TRUE;
+    }
+
+    dir_path = g_strndup(path, offset);
+    dir = g_hash_table_lookup(overlay->dirs, dir_path);
+    g_free(dir_path);
+
+    if (dir) {
+        g_hash_table_remove(dir->keys, path + offset);
+    }
+    return TRUE;
+}
+
+GVariant *svdb_overlay_read(SvdbOverlay *overlay, const gchar *path, GError **error) {
+    const gchar *key;
+    SvdbOverlayDir *dir;
+    gchar *dir_path;
+    gpointer value;
+
+    if (!overlay || !path) {
+        return NULL;
+    }
+
+    key = strrchr(path, '/');
+    if (key) {
+        ++key;
+        dir_path = g_strndup(path, key - path);
+        dir = g_hash_table_lookup(overlay->dirs, dir_path);
+        g_free(dir_path);
+
+        if (dir && g_hash_table_lookup_extended(dir->keys, key, NULL, &value)) {
+            return value ? g_variant_ref(value) : NULL;
+        }
+    }
+
+    return overlay->base ? svdb_file_read(overlay->base, path, error) : NULL;
+}
+
+static int svdb_overlay_entry_compare(const void *a, const void *b) {
+    const SvdbOverlayEntry *entry_a = a;
+    const SvdbOverlayEntry *entry_b = b;
+    int result = memcmp(entry_a->key, entry_b->key, MIN(entry_a->key_length, entry_b->key_length));
+
+    if (result) {
+        return result;
+    }
+    return entry_a->key_length < entry_b->key_length ? -1 : entry_a->key_length > entry_b->key_length;
+}
+
+/// @brief Append base children of list (or root items, if list is NULL) and changes of dir, sorted by key.
+static gboolean svdb_overlay_collect_children(SvdbOverlay *overlay, GArray *children,
+                                              const struct svdb_hash_item *list, SvdbOverlayDir *dir,
+                                              GError **error) {
+    SvdbFile *base = overlay->base;
+    const SVDBTableHeader *header = base ? &base->root : NULL;
+    const guint32_le *indecies = NULL;
+    guint32 parent = (guint32) -1;
+    guint count = 0;
+    GHashTable *matched = NULL;
+    GHashTableIter iter;
+    gpointer key, value;
+    gboolean result = TRUE;
+
+    if (list) {
+        parent = list - header->hash_items;
+        if (!svdb_table_list_indecies_from_item(base->data, base->size, list, &indecies, &count)) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(corrupted list)");
+            return FALSE;
+        }
+    } else if (header) {
+        count = header->n_hash_items;
+    }
+
+    if (dir) {
+        matched = g_hash_table_new(&g_str_hash, &g_str_equal);
+    }
+
+    for (guint i = 0; i < count && result; ++i) {
+        guint32 index = indecies ? guint32_from_le(indecies[i]) : i;
+        SvdbOverlayEntry child = {0};
+        const struct svdb_hash_item *item;
+        guint32 start, length;
+
+        // Child must point back to list, so walk is always a tree.
+        if (index >= header->n_hash_items || guint32_from_le(header->hash_items[index].parent) != parent) {
+            continue;
+        }
+
+        item = header->hash_items + index;
+        start = guint32_from_le(item->key_start);
+        length = guint16_from_le(item->key_size);
+
+        if G_UNLIKELY((guint64) start + length > base->size) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(key out of bounds)");
+            result = FALSE;
+            break;
+        }
+
+        child.item = item;
+        child.key = (const gchar *) base->data + start;
+        child.key_length = length;
+        child.hash = guint32_from_le(item->hash_value);
+        child.type = item->type;
+
+        // Nested tables aren't used by dconf, so their content isn't merged.
+        if (svdb_item_char_to_type(item->type) != SVDB_TYPE_VARIANT
+            && svdb_item_char_to_type(item->type) != SVDB_TYPE_LIST) {
+            g_set_error(error, SVDB_ERROR, 0, "unsupported item type(%c) in overlay base", item->type);
+            result = FALSE;
+            break;
+        }
+
+        // Lookups are done only in changed dirs, other dirs are copied without them.
+        if (dir) {
+            gchar *name = g_strndup(child.key, length);
+            gboolean found;
+
+            if (svdb_item_char_to_type(item->type) == SVDB_TYPE_LIST) {
+                child.dir = g_hash_table_lookup(dir->dirs, name);
+                found = FALSE;
+            } else {
+                found = g_hash_table_lookup_extended(dir->keys, name, &key, &value);
+            }
+
+            g_free(name);
+
+            if (found) {
+                g_hash_table_add(matched, key);
+                // Removed key.
+                if (!value) {
+                    continue;
+                }
+                child.value = value;
+            }
+        }
+
+        g_array_append_val(children, child);
+    }
+
+    if (!result) {
+        if (matched) {
+            g_hash_table_unref(matched);
+        }
+        return FALSE;
+    }
+
+    if (dir) {
+        g_hash_table_iter_init(&iter, dir->keys);
+        while (g_hash_table_iter_next(&iter, &key, &value)) {
+            SvdbOverlayEntry child = {0};
+
+            if (!value || g_hash_table_contains(matched, key)) {
+                continue;
+            }
+            child.key = key;
+            child.key_length = strlen(key);
+            child.value = value;
+            child.type = svdb_item_type_to_char(SVDB_TYPE_VARIANT);
+            g_array_append_val(children, child);
+        }
+
+        g_hash_table_iter_init(&iter, dir->dirs);
+        while (g_hash_table_iter_next(&iter, &key, &value)) {
+            SvdbOverlayEntry child = {0};
+
+            if (((SvdbOverlayDir *) value)->item) {
+                continue;
+            }
+            child.key = key;
+            child.key_length = strlen(key);
+            child.dir = value;
+            child.type = svdb_item_type_to_char(SVDB_TYPE_LIST);
+            g_array_append_val(children, child);
+        }
+
+        g_hash_table_unref(matched);
+    }
+
+    // Same order, as svdb_table_get_raw writes, so same content gives same bytes.
+    g_array_sort(children, svdb_overlay_entry_compare);
+    return TRUE;
+}
+
+/// @brief Append merged children of list entry (or of root table, if parent is -1) in write order (depth first,
+/// sorted by key), and recursively their children.
+static gboolean svdb_overlay_collect(SvdbOverlay *overlay, GArray *entries, guint32 parent, guint32 hash,
+                                     const struct svdb_hash_item *list, SvdbOverlayDir *dir, GError **error) {
+    GArray *children = g_array_new(FALSE, FALSE, sizeof(SvdbOverlayEntry));
+    gboolean result;
+
+    result = svdb_overlay_collect_children(overlay, children, list, dir, error);
+
+    for (guint i = 0; i < children->len && result; ++i) {
+        SvdbOverlayEntry *child = &g_array_index(children, SvdbOverlayEntry, i);
+
+        // Hashes of base items are reused, unless they are legacy ones (written file always has full name hashes).
+        if (!child->item || overlay->base->legacy_hashes) {
+            gchar *key = g_strndup(child->key, child->key_length);
+
+            child->hash = svdb_hash_append(hash, key, NULL);
+            g_free(key);
+        }
+        child->parent = parent;
+        g_array_append_val(entries, *child);
+
+        if (svdb_item_char_to_type(child->type) == SVDB_TYPE_LIST) {
+            result = svdb_overlay_collect(overlay, entries, entries->len - 1, child->hash, child->item, child->dir,
+                                          error);
+        }
+    }
+
+    if (parent != (guint32) -1) {
+        g_array_index(entries, SvdbOverlayEntry, parent).length = children->len;
+    }
+
+    g_array_unref(children);
+    return result;
+}
+
+/// @brief Write value of entry: bytes of base value are copied as is, if byte order is the same.
+static gboolean svdb_overlay_write_value(SvdbOverlay *overlay, GvdbBuilder *builder, const SvdbOverlayEntry *entry,
+                                         gboolean byteswap, struct svdb_pointer *pointer, GError **error) {
+    SvdbFile *base = overlay->base;
+    GVariant *value, *variant, *normal;
+
+    if (!entry->value && base->byteswapped == byteswap) {
+        gconstpointer data;
+        gsize size;
+
+        data = svdb_table_dereference(base->data, base->size, entry->item->value.pointer, 8, &size);
+        if G_UNLIKELY(!data) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+            return FALSE;
+        }
+
+        svdb_gvdbbuilder_add_value(builder, g_bytes_new_from_bytes(base->bytes, (const gchar *) data
+                                                                                - (const gchar *) base->data, size),
+                                   pointer);
+        return TRUE;
+    }
+
+    value = entry->value ? g_variant_ref(entry->value) : svdb_file_item_get_value(base, entry->item);
+    if G_UNLIKELY(!value) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+        return FALSE;
+    }
+
+    if (byteswap) {
+        GVariant *swapped = g_variant_byteswap(value);
+
+        g_variant_unref(value);
+        value = swapped;
+    }
+
+    variant = g_variant_new_variant(value);
+    normal = g_variant_get_normal_form(variant);
+    svdb_gvdbbuilder_add_value(builder, g_variant_get_data_as_bytes(normal), pointer);
+
+    g_variant_unref(normal);
+    g_variant_unref(variant);
+    g_variant_unref(value);
+    return TRUE;
+}
+
+/// @brief Write root table of entries (in order of entries, like svdb_gvdbbuilder_add_table_content does).
+static gboolean svdb_overlay_write_table(SvdbOverlay *overlay, GvdbBuilder *builder, GArray *entries,
+                                         gboolean byteswap, struct svdb_pointer *root, GError **error) {
+    BucketCounter *counter = svdb_bucketcounter_new(entries->len);
+    guint32_le *buckets;
+    struct svdb_hash_item *items;
+    GString *key = g_string_new(NULL);
+    GError *tmp_error = NULL;
+
+    for (guint i = 0; i < entries->len; ++i) {
+        svdb_bucketcounter_add(counter, g_array_index(entries, SvdbOverlayEntry, i).hash);
+    }
+
+    if (!svdb_gvdbbuilder_add_hash_table(builder, entries->len, counter, root, &buckets, &items, error)) {
+        svdb_bucketcounter_free(counter);
+        g_string_free(key, TRUE);
+        return FALSE;
+    }
+
+    svdb_bucketcounter_free(counter);
+    counter = svdb_bucketcounter_new(entries->len);
+
+    for (guint i = 0; i < entries->len && !tmp_error; ++i) {
+        SvdbOverlayEntry *entry = &g_array_index(entries, SvdbOverlayEntry, i);
+        guint32 index = svdb_bucketcounter_get_item_index(counter, buckets, entry->hash);
+        struct svdb_hash_item *item = items + index;
+
+        if (g_cancellable_set_error_if_cancelled(builder->cancellable, &tmp_error)) {
+            break;
+        }
+        if (item->hash_value.value != 0) {
+            g_set_error_literal(&tmp_error, SVDB_ERROR, 0, "internal error(collision while table building)");
+            break;
+        }
+
+        entry->index = index;
+        item->hash_value = guint32_to_le(entry->hash);
+        item->type = entry->type;
+
+        if (entry->parent == (guint32) -1) {
+            item->parent = guint32_to_le(-1);
+        } else {
+            SvdbOverlayEntry *parent = &g_array_index(entries, SvdbOverlayEntry, entry->parent);
+
+            item->parent = guint32_to_le(parent->index);
+            parent->content[parent->filled++] = guint32_to_le(index);
+        }
+
+        g_string_truncate(key, 0);
+        g_string_append_len(key, entry->key, entry->key_length);
+        svdb_gvdbbuilder_add_string(builder, key->str, &item->key_start, &item->key_size, &tmp_error);
+        if (tmp_error) {
+            break;
+        }
+
+        if (svdb_item_char_to_type(entry->type) == SVDB_TYPE_LIST) {
+            entry->content = svdb_gvdbbuilder_allocate_chunk(builder, 4, 4 * entry->length, &item->value.pointer);
+        } else {
+            svdb_overlay_write_value(overlay, builder, entry, byteswap, &item->value.pointer, &tmp_error);
+        }
+    }
+
+    svdb_bucketcounter_free(counter);
+    g_string_free(key, TRUE);
+
+    if (tmp_error) {
+        g_propagate_error(error, tmp_error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+GBytes *svdb_overlay_get_raw(SvdbOverlay *overlay, gboolean byteswap, SvdbWriteFlags flags, SvdbWriteStats *stats,
+                             GError **error) {
+    struct svdb_pointer root;
+    GvdbBuilder *builder;
+    GArray *entries;
+    GString *str;
+    gsize str_len;
+    GError *tmp_error = NULL;
+
+    if (!overlay) {
+        return NULL;
+    }
+
+    // Only small entries are kept for every item, keys and values stay in mapped base file until they are copied.
+    entries = g_array_new(FALSE, FALSE, sizeof(SvdbOverlayEntry));
+    // Entries are written in one pass, so locality layout isn't supported.
+    builder = svdb_gvdbbuilder_new(flags & ~SVDB_WRITE_LOCALITY);
+
+    if (!svdb_overlay_collect(overlay, entries, (guint32) -1, SVDB_HASH_INITIAL, NULL,
+                              g_hash_table_lookup(overlay->dirs, ""), &tmp_error)
+        || !svdb_overlay_write_table(overlay, builder, entries, byteswap, &root, &tmp_error)) {
+        g_array_unref(entries);
+        svdb_gvdbbuilder_free(builder);
+        g_propagate_error(error, tmp_error);
+        return NULL;
+    }
+
+    g_array_unref(entries);
+    str = svdb_gvdbbuilder_serialize(builder, byteswap, root, &tmp_error);
+
+    if (tmp_error) {
+        svdb_gvdbbuilder_free(builder);
+        g_propagate_error(error, tmp_error);
+        return NULL;
+    }
+
+    str_len = str->len;
+
+    if (stats) {
+        *stats = builder->stats;
+        stats->size = str_len;
+    }
+
+    svdb_gvdbbuilder_free(builder);
+    return g_bytes_new_take(g_string_free(str, FALSE), str_len);
+}
+
+gboolean svdb_overlay_write_to_file(SvdbOverlay *overlay, const gchar *filename, gboolean byteswap,
+                                    GError **error) {
+    GBytes *content;
+    gboolean status;
+
+    if (!overlay || !filename) {
+        return FALSE;
+    }
+
+    content = svdb_overlay_get_raw(overlay, byteswap, SVDB_WRITE_DEDUP, NULL, error);
+    if (!content) {
+        return FALSE;
+    }
+
+    // File is replaced (not rewritten in place), so mapped base file stays valid even if it's the same file.
+    status = g_file_set_contents(filename, g_bytes_get_data(content, NULL), g_bytes_get_size(content), error);
+
+    g_bytes_unref(content);
+    return status;
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_OVERLAY
@@ -1,5 +1,6 @@
 #ifndef LIBSVDB_PRIVATE_SVDB_PARSE
 #include "private_svdb_common.c"
+#include "private_svdb_mmap.c"
 #define LIBSVDB_PRIVATE_SVDB_PARSE
 
 static gconstpointer svdb_table_dereference(gconstpointer file_data, gsize file_size,
@@ -19,8 +20,30 @@ static gconstpointer svdb_table_dereference(gconstpointer file_data, gsize file_
     return file_data + start;
 }
 
-static GVariant *svdb_gvdb_item_get_variant(gconstpointer block, gsize block_size, gboolean byteswap,
-                                            gboolean trusted, const struct svdb_hash_item *item) {
+static gboolean svdb_gvdb_header_check(gconstpointer data, gsize size, gboolean *byteswapped) {
+    const struct svdb_header *header = data;
+
+    if (size < sizeof *header) {
+        return FALSE;
+    }
+
+    if (header->signature[0] == GVDB_SIGNATURE0 && header->signature[1] == GVDB_SIGNATURE1
+        && guint32_from_le(header->version) == 0) {
+        *byteswapped = FALSE;
+    } else if (header->signature[0] == GVDB_SWAPPED_SIGNATURE0
+               && header->signature[1] == GVDB_SWAPPED_SIGNATURE1
+               && guint32_from_le(header->version) == 0) {
+        *byteswapped = TRUE;
+    } else {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/// @brief Get value of variant item as it stored in file (byteswap, if needed, is up to caller).
+static GVariant *svdb_gvdb_item_get_variant(gconstpointer block, gsize block_size, gboolean trusted,
+                                            const struct svdb_hash_item *item) {
     GVariant *variant, *value;
     gconstpointer data;
     GBytes *bytes;
@@ -38,12 +61,6 @@ static GVariant *svdb_gvdb_item_get_variant(gconstpointer block, gsize block_siz
     g_variant_unref(variant);
     g_bytes_unref(bytes);
 
-    if (byteswap) {
-        GVariant *tmp = g_variant_byteswap(value);
-        g_variant_unref(value);
-        value = tmp;
-    }
-
     return value;
 }
 
@@ -55,11 +72,16 @@ static void svdb_item_set_parent(SvdbTableItem *item, SvdbTableItem *parent, GEr
         g_set_error_literal(error, SVDB_ERROR, 0, "trying to attach item to more than one parent.");
         return;
     }
+    if (item->frozen || parent->frozen) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "trying to attach frozen item.");
+        return;
+    }
     if (parent->type == SVDB_TYPE_VARIANT) {
         g_set_error_literal(error, SVDB_ERROR, 0, "trying to attach item to variant.");
         return;
     }
     item->parent = parent;
+    svdb_item_invalidate_content_hash(parent);
     guint32 count = item->childs + 1;
 
     while (parent && parent->type == SVDB_TYPE_LIST) {
@@ -98,7 +120,7 @@ static gboolean svdb_parse_table_header(gconstpointer block, gsize block_size,
     memset(header, 0, sizeof *header);
     gvdb_header = svdb_table_dereference(block, block_size, table, 4, &size);
 
-    if G_UNLIKELY(header == NULL || size < sizeof *gvdb_header) {
+    if G_UNLIKELY(gvdb_header == NULL || size < sizeof *gvdb_header) {
         return FALSE;
     }
 
@@ -156,7 +178,7 @@ static SvdbTableItem *svdb_parse_table_variant(SVDBTableHeader header, gconstpoi
         return NULL;
     }
 
-    GVariant *value = svdb_gvdb_item_get_variant(block, block_size, byteswap, trusted, variant);
+    GVariant *value = svdb_gvdb_item_get_variant(block, block_size, trusted, variant);
 
     if (value == NULL) {
         g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file");
@@ -166,18 +188,21 @@ static SvdbTableItem *svdb_parse_table_variant(SVDBTableHeader header, gconstpoi
     SvdbTableItem *item = svdb_item_new();
 
     svdb_item_set_variant(item, value);
+    // Foreign values are swapped lazily, only if accessed (see svdb_item_peek_variant).
+    item->byteswapped = byteswap;
     g_variant_unref(value);
     return item;
 }
 
 static SvdbTableItem *svdb_parse_table(gconstpointer block, gsize block_size, gboolean byteswap,
-                                       gboolean trusted, const struct svdb_pointer table, GError **error);
+                                       gboolean trusted, const struct svdb_pointer table,
+                                       GCancellable *cancellable, GError **error);
 
 
 static SvdbTableItem *svdb_parse_table_list(SVDBTableHeader header, gconstpointer block,
                                             gsize block_size, gboolean byteswap,
-                                            gboolean trusted,
-                                            const struct svdb_hash_item *list_item, GError **error) {
+                                            gboolean trusted, const struct svdb_hash_item *list_item,
+                                            GCancellable *cancellable, GError **error) {
     if (list_item->type != 'L') {
         return NULL;
     }
@@ -210,6 +235,9 @@ static SvdbTableItem *svdb_parse_table_list(SVDBTableHeader header, gconstpointe
         if (itemno > header.n_hash_items) {
             continue;
         }
+        if (g_cancellable_set_error_if_cancelled(cancellable, error)) {
+            goto error_exit;
+        }
         list_element = header.hash_items + itemno;
         curr->key = svdb_gvdb_item_get_key(block, block_size, list_element);
         switch (svdb_item_char_to_type(list_element->type)) {
@@ -231,7 +259,7 @@ static SvdbTableItem *svdb_parse_table_list(SVDBTableHeader header, gconstpointe
             }
             case SVDB_TYPE_LIST: {
                 curr->item = svdb_parse_table_list(header, block, block_size, byteswap, trusted,
-                                                   list_element, &tmp_error);
+                                                   list_element, cancellable, &tmp_error);
                 if (tmp_error) {
                     g_propagate_error(error, tmp_error);
                     svdb_item_unref(item);
@@ -247,7 +275,7 @@ static SvdbTableItem *svdb_parse_table_list(SVDBTableHeader header, gconstpointe
             }
             case SVDB_TYPE_TABLE: {
                 SvdbTableItem *table = svdb_parse_table(block, block_size, byteswap, trusted,
-                                                        list_element->value.pointer, &tmp_error);
+                                                        list_element->value.pointer, cancellable, &tmp_error);
                 if (tmp_error) {
                     g_propagate_error(error, tmp_error);
                     svdb_item_unref(item);
@@ -292,7 +320,8 @@ error_exit:
 }
 
 static SvdbTableItem *svdb_parse_table(gconstpointer block, gsize block_size, gboolean byteswap,
-                                       gboolean trusted, const struct svdb_pointer table, GError **error) {
+                                       gboolean trusted, const struct svdb_pointer table,
+                                       GCancellable *cancellable, GError **error) {
     SvdbTableItem *result = svdb_table_new();
     SVDBTableHeader header;
     GError *tmp_error = NULL;
@@ -305,6 +334,10 @@ static SvdbTableItem *svdb_parse_table(gconstpointer block, gsize block_size, gb
         if (guint32_from_le(header.hash_items[i].parent) != -1) {
             continue;
         }
+        if (g_cancellable_set_error_if_cancelled(cancellable, error)) {
+            svdb_item_unref(result);
+            return NULL;
+        }
         switch (svdb_item_char_to_type(header.hash_items[i].type)) {
             case SVDB_TYPE_VARIANT: {
                 SvdbTableItem *item = svdb_parse_table_variant(header, block, block_size, byteswap,
@@ -330,7 +363,8 @@ static SvdbTableItem *svdb_parse_table(gconstpointer block, gsize block_size, gb
             }
             case SVDB_TYPE_LIST: {
                 SvdbTableItem *item = svdb_parse_table_list(header, block, block_size, byteswap,
-                                                            trusted, header.hash_items + i, &tmp_error);
+                                                            trusted, header.hash_items + i, cancellable,
+                                                            &tmp_error);
 
                 if (tmp_error) {
                     g_propagate_error(error, tmp_error);
@@ -359,7 +393,8 @@ static SvdbTableItem *svdb_parse_table(gconstpointer block, gsize block_size, gb
             }
             case SVDB_TYPE_TABLE: {
                 SvdbTableItem *value = svdb_parse_table(block, block_size, byteswap, trusted,
-                                                        header.hash_items[i].value.pointer, &tmp_error);
+                                                        header.hash_items[i].value.pointer, cancellable,
+                                                        &tmp_error);
 
                 if (tmp_error) {
                     g_propagate_error(error, tmp_error);
@@ -385,4 +420,43 @@ static SvdbTableItem *svdb_parse_table(gconstpointer block, gsize block_size, gb
     }
     return result;
 }
+
+/// @brief Parse GVDB bytes into table (see svdb_table_read_from_bytes).
+static SvdbTableItem *svdb_parse_bytes(GBytes *bytes, gboolean trusted, GCancellable *cancellable, GError **error) {
+    const struct svdb_header *header;
+    gsize size;
+    gboolean byteswapped;
+    gconstpointer data;
+
+    data = g_bytes_get_data(bytes, &size);
+
+    if (!svdb_gvdb_header_check(data, size, &byteswapped)) {
+        g_set_error_literal(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "corrupted gvdb file(invalid gvdb header)");
+        return NULL;
+    }
+
+    header = data;
+    return svdb_parse_table(data, size, byteswapped, trusted, header->root, cancellable, error);
+}
+
+/// @brief Parse GVDB file into table (see svdb_table_read_from_file).
+static SvdbTableItem *svdb_parse_file(const gchar *filename, gboolean trusted, SvdbLoadFlags flags,
+                                      GCancellable *cancellable, GError **error) {
+    SvdbTableItem *table;
+    GBytes *bytes;
+
+    bytes = svdb_mmap_file(filename, flags, error);
+    if (!bytes) {
+        g_prefix_error(error, "%s: ", filename);
+        return NULL;
+    }
+
+    table = svdb_parse_bytes(bytes, trusted, cancellable, error);
+    g_bytes_unref(bytes);
+
+    g_prefix_error(error, "%s: ", filename);
+
+    return table;
+}
+
 #endif // LIBSVDB_PRIVATE_SVDB_PARSE
@@ -0,0 +1,224 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_PRINT
+#include "private_svdb_common.c"
+#define LIBSVDB_PRIVATE_SVDB_PRINT
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Output of fast paths must be byte-identical to g_variant_print_string() (see gvariant.c), any difference breaks
+// dumps compared by text.
+
+/// @brief Check if byte must be printed by per-char path: quote, backslash, control char, DEL or part of
+/// non-ASCII char (which can be non-printable).
+static inline gboolean svdb_print_is_special(guchar c, gchar quote) {
+    return c < 0x20 || c >= 0x7f || c == (guchar) quote || c == '\\';
+}
+
+/// @brief Get length of string prefix, which is copied to output as is.
+static gsize svdb_print_plain_span(const gchar *str, gsize length, gchar quote) {
+    gsize i = 0;
+
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i quotes = _mm_set1_epi8(quote);
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) (str + i));
+        // Compare is signed, so non-ASCII bytes (negative) are below space too.
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, backslash)));
+        int mask = _mm_movemask_epi8(special);
+
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < length; ++i) {
+        if (svdb_print_is_special(str[i], quote)) {
+            return i;
+        }
+    }
+    return length;
+}
+
+/// @brief Append quoted string (str must be valid UTF-8, as any string got from GVariant).
+static void svdb_print_string_literal(GString *string, const gchar *str, gsize length) {
+    const gchar *end = str + length;
+    gchar quote = memchr(str, '\'', length) ? '"' : '\'';
+
+    g_string_append_c(string, quote);
+
+    while (str < end) {
+        gsize plain = svdb_print_plain_span(str, end - str, quote);
+        gunichar c;
+
+        g_string_append_len(string, str, plain);
+        str += plain;
+        if (str == end) {
+            break;
+        }
+
+        c = g_utf8_get_char(str);
+
+        if (c == (gunichar) quote || c == '\\') {
+            g_string_append_c(string, '\\');
+        }
+
+        if (g_unichar_isprint(c)) {
+            g_string_append_unichar(string, c);
+        } else {
+            g_string_append_c(string, '\\');
+            if (c < 0x10000) {
+                switch (c) {
+                    case '\a':
+                        g_string_append_c(string, 'a');
+                        break;
+                    case '\b':
+                        g_string_append_c(string, 'b');
+                        break;
+                    case '\f':
+                        g_string_append_c(string, 'f');
+                        break;
+                    case '\n':
+                        g_string_append_c(string, 'n');
+                        break;
+                    case '\r':
+                        g_string_append_c(string, 'r');
+                        break;
+                    case '\t':
+                        g_string_append_c(string, 't');
+                        break;
+                    case '\v':
+                        g_string_append_c(string, 'v');
+                        break;
+                    default:
+                        g_string_append_printf(string, "u%04x", c);
+                        break;
+                }
+            } else {
+                g_string_append_printf(string, "U%08x", c);
+            }
+        }
+
+        str = g_utf8_next_char(str);
+    }
+
+    g_string_append_c(string, quote);
+}
+
+/// @brief Append decimal number (like "%" G_GUINT64_FORMAT), without format parsing.
+static void svdb_print_number(GString *string, guint64 number, gboolean negative) {
+    gchar buffer[24];
+    gchar *digit = buffer + sizeof(buffer);
+
+    do {
+        *--digit = '0' + number % 10;
+        number /= 10;
+    } while (number);
+
+    if (negative) {
+        *--digit = '-';
+    }
+
+    g_string_append_len(string, digit, buffer + sizeof(buffer) - digit);
+}
+
+/// @brief Append double, with '.0' for integral values, so it's parsed back as double.
+static void svdb_print_double(GString *string, gdouble number) {
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE + 2];
+    gint i;
+
+    g_ascii_dtostr(buffer, G_ASCII_DTOSTR_BUF_SIZE, number);
+
+    for (i = 0; buffer[i]; ++i) {
+        if (buffer[i] == '.' || buffer[i] == 'e' || buffer[i] == 'n' || buffer[i] == 'N') {
+            break;
+        }
+    }
+
+    if (buffer[i] == '\0') {
+        buffer[i++] = '.';
+        buffer[i++] = '0';
+        buffer[i] = '\0';
+    }
+
+    g_string_append(string, buffer);
+}
+
+GString *svdb_variant_print_string(GVariant *value, GString *string, gboolean type_annotate) {
+    const gchar *type = g_variant_get_type_string(value);
+    const gchar *str;
+    gsize length;
+
+    if (!string) {
+        string = g_string_new(NULL);
+    }
+
+    if (type[0] != '\0' && type[1] == '\0') {
+        switch (type[0]) {
+            case 'b':
+                if (g_variant_get_boolean(value)) {
+                    g_string_append_len(string, "true", 4);
+                } else {
+                    g_string_append_len(string, "false", 5);
+                }
+                return string;
+            case 'i': {
+                gint32 number = g_variant_get_int32(value);
+
+                svdb_print_number(string, number < 0 ? -(guint64) number : (guint64) number, number < 0);
+                return string;
+            }
+            case 'u':
+                if (type_annotate) {
+                    g_string_append_len(string, "uint32 ", 7);
+                }
+                svdb_print_number(string, g_variant_get_uint32(value), FALSE);
+                return string;
+            case 'd':
+                svdb_print_double(string, g_variant_get_double(value));
+                return string;
+            case 's':
+                str = g_variant_get_string(value, &length);
+                svdb_print_string_literal(string, str, length);
+                return string;
+            default:
+                break;
+        }
+    } else if (strcmp(type, "as") == 0) {
+        // Strings point into value data, only array of pointers is allocated.
+        const gchar **strv = g_variant_get_strv(value, &length);
+
+        if (length == 0) {
+            if (type_annotate) {
+                g_string_append_len(string, "@as ", 4);
+            }
+            g_string_append_len(string, "[]", 2);
+        } else {
+            g_string_append_c(string, '[');
+            for (gsize i = 0; i < length; ++i) {
+                if (i) {
+                    g_string_append_len(string, ", ", 2);
+                }
+                svdb_print_string_literal(string, strv[i], strlen(strv[i]));
+            }
+            g_string_append_c(string, ']');
+        }
+
+        g_free(strv);
+        return string;
+    }
+
+    return g_variant_print_string(value, string, type_annotate);
+}
+
+gchar *svdb_variant_print(GVariant *value, gboolean type_annotate) {
+    return g_string_free(svdb_variant_print_string(value, NULL, type_annotate), FALSE);
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_PRINT
@@ -0,0 +1,141 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_RECORD
+#include "private_svdb_common.c"
+#include "private_svdb_print.c"
+#define LIBSVDB_PRIVATE_SVDB_RECORD
+
+/// @brief Escape JSON string content, which is written at end of buffer (from start), in place.
+/// Escaped text is written backward, so there is no temporary copy.
+static void svdb_record_escape_json(GString *buffer, gsize start) {
+    static const gchar hex[] = "0123456789abcdef";
+    gsize extra = 0;
+    gsize source, target;
+
+    for (gsize i = start; i < buffer->len; ++i) {
+        guchar c = buffer->str[i];
+
+        if (c == '"' || c == '\\' || c == '\n' || c == '\t' || c == '\r' || c == '\b' || c == '\f') {
+            extra += 1;
+        } else if (c < 0x20) {
+            extra += 5;
+        }
+    }
+
+    if (!extra) {
+        return;
+    }
+
+    source = buffer->len;
+    g_string_set_size(buffer, buffer->len + extra);
+    target = buffer->len;
+
+    while (source > start) {
+        guchar c = buffer->str[--source];
+        gchar escape = 0;
+
+        switch (c) {
+            case '"':
+            case '\\':
+                escape = c;
+                break;
+            case '\n':
+                escape = 'n';
+                break;
+            case '\t':
+                escape = 't';
+                break;
+            case '\r':
+                escape = 'r';
+                break;
+            case '\b':
+                escape = 'b';
+                break;
+            case '\f':
+                escape = 'f';
+                break;
+            default:
+                break;
+        }
+
+        if (escape) {
+            buffer->str[--target] = escape;
+            buffer->str[--target] = '\\';
+        } else if (c < 0x20) {
+            buffer->str[--target] = hex[c & 0xf];
+            buffer->str[--target] = hex[c >> 4];
+            buffer->str[--target] = '0';
+            buffer->str[--target] = '0';
+            buffer->str[--target] = 'u';
+            buffer->str[--target] = '\\';
+        } else {
+            buffer->str[--target] = c;
+        }
+    }
+}
+
+/// @brief Append JSON string (with quotes).
+static void svdb_record_append_json_string(GString *buffer, const gchar *text) {
+    gsize start;
+
+    g_string_append_c(buffer, '"');
+    start = buffer->len;
+    g_string_append(buffer, text);
+    svdb_record_escape_json(buffer, start);
+    g_string_append_c(buffer, '"');
+}
+
+void svdb_record_append(GString *buffer, SvdbRecordFormat format, const gchar *path, GVariant *value) {
+    const gchar *type;
+    gsize start;
+
+    if (!buffer || !path) {
+        return;
+    }
+
+    type = value ? g_variant_get_type_string(value) : NULL;
+
+    switch (format) {
+        case SVDB_RECORD_JSONL:
+            g_string_append(buffer, "{\"path\":");
+            svdb_record_append_json_string(buffer, path);
+
+            if (!value) {
+                g_string_append(buffer, ",\"type\":null,\"value\":null}\n");
+                break;
+            }
+
+            g_string_append(buffer, ",\"type\":");
+            svdb_record_append_json_string(buffer, type);
+            g_string_append(buffer, ",\"value\":\"");
+            // Value is printed right into buffer, and escaped there.
+            start = buffer->len;
+            svdb_variant_print_string(value, buffer, FALSE);
+            svdb_record_escape_json(buffer, start);
+            g_string_append(buffer, "\"}\n");
+            break;
+        case SVDB_RECORD_NUL:
+            g_string_append_len(buffer, path, strlen(path) + 1);
+            if (value) {
+                g_string_append_len(buffer, type, strlen(type) + 1);
+                svdb_variant_print_string(value, buffer, FALSE);
+                g_string_append_c(buffer, '\0');
+            } else {
+                g_string_append_len(buffer, "\0\0", 2);
+            }
+            break;
+        case SVDB_RECORD_GVARIANT_TEXT:
+        default:
+            g_string_append(buffer, path);
+            g_string_append_c(buffer, '\t');
+            if (value) {
+                g_string_append(buffer, type);
+                g_string_append_c(buffer, '\t');
+                svdb_variant_print_string(value, buffer, FALSE);
+            } else {
+                g_string_append_c(buffer, '\t');
+            }
+            g_string_append_c(buffer, '\n');
+            break;
+    }
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_RECORD
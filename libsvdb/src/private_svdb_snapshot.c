@@ -0,0 +1,232 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_SNAPSHOT
+#include "private_svdb_parse.c"
+#define LIBSVDB_PRIVATE_SVDB_SNAPSHOT
+
+/// @brief Freeze subtree: drop parent links and fill all lazy caches, so readers never write into items.
+static void svdb_snapshot_freeze(SvdbTableItem *item) {
+    SvdbIter iter;
+    SvdbTableItem *child;
+
+    item->frozen = TRUE;
+    item->parent = NULL;
+
+    if (item->type == SVDB_TYPE_VARIANT) {
+        svdb_item_peek_variant(item);
+        return;
+    }
+
+    svdb_iter_init(&iter, item);
+    while (svdb_iter_next(&iter, NULL, &child)) {
+        if (!child->frozen) {
+            svdb_snapshot_freeze(child);
+        }
+    }
+}
+
+/// @brief Create frozen shallow copy of table or list, children are shared with original.
+static SvdbTableItem *svdb_snapshot_copy(const SvdbTableItem *item) {
+    SvdbTableItem *copy = svdb_item_new();
+
+    copy->frozen = TRUE;
+    copy->type = item->type;
+    copy->childs = item->childs;
+
+    if (item->type == SVDB_TYPE_TABLE) {
+        GHashTableIter iter;
+        gpointer key, value;
+
+        copy->table = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
+                                            (GDestroyNotify) &svdb_item_clear_unref_dettach);
+        g_hash_table_iter_init(&iter, item->table);
+        while (g_hash_table_iter_next(&iter, &key, &value)) {
+            g_hash_table_insert(copy->table, g_strdup(key), svdb_item_ref(value));
+        }
+        return copy;
+    }
+
+    svdb_item_list_reserve(copy, item->length + 1);
+    for (gsize i = 0; i < item->length; ++i) {
+        copy->list[i].key = g_strdup(item->list[i].key);
+        copy->list[i].item = svdb_item_ref(item->list[i].item);
+    }
+    copy->length = item->length;
+    return copy;
+}
+
+/// @brief Create frozen empty list (for missing dirs).
+static SvdbTableItem *svdb_snapshot_new_list(void) {
+    SvdbTableItem *list = svdb_item_new();
+
+    list->frozen = TRUE;
+    list->type = SVDB_TYPE_LIST;
+    return list;
+}
+
+/// @brief Get index of element in list, or -1.
+static gssize svdb_snapshot_list_find(const SvdbTableItem *list, const gchar *key) {
+    for (gsize i = 0; i < list->length; ++i) {
+        if (strcmp(list->list[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// @brief Put item into list of copied path node (item reference is taken), or remove element, if item is NULL.
+static void svdb_snapshot_list_put(SvdbTableItem *list, const gchar *key, SvdbTableItem *item) {
+    gssize index = svdb_snapshot_list_find(list, key);
+
+    if (index >= 0) {
+        svdb_item_unref(list->list[index].item);
+
+        if (item) {
+            list->list[index].item = item;
+            return;
+        }
+
+        g_free(list->list[index].key);
+        memmove(list->list + index, list->list + index + 1, (list->length - index - 1) * sizeof *list->list);
+        --list->length;
+        return;
+    }
+
+    if (item) {
+        svdb_item_list_reserve(list, list->length + 1);
+        list->list[list->length].key = g_strdup(key);
+        list->list[list->length].item = item;
+        ++list->length;
+    }
+}
+
+/// @brief Get list of dir in snapshot without copying (or NULL, if dir doesn't exist).
+static const SvdbTableItem *svdb_snapshot_find_dir(const SvdbTableItem *list, gchar **segments, GError **error) {
+    for (gchar **segment = segments; list && segment[1]; ++segment) {
+        gchar *key = g_strconcat(*segment, "/", NULL);
+        gssize index = svdb_snapshot_list_find(list, key);
+
+        g_free(key);
+        list = index >= 0 ? list->list[index].item : NULL;
+
+        if (list && list->type != SVDB_TYPE_LIST) {
+            g_set_error(error, SVDB_ERROR, 0, "trying to change dir of non-list item(%s/)", *segment);
+            return NULL;
+        }
+    }
+    return list;
+}
+
+SvdbTableItem *svdb_tree_freeze(SvdbTableItem *table) {
+    if (!table || table->type != SVDB_TYPE_TABLE || table->parent) {
+        return NULL;
+    }
+
+    if (!table->frozen) {
+        svdb_snapshot_freeze(table);
+        // Hashes of whole tree are computed once, so later they are only read.
+        svdb_item_content_hash(table);
+    }
+
+    return svdb_item_ref(table);
+}
+
+gboolean svdb_item_is_frozen(const SvdbTableItem *item) {
+    return item && item->frozen;
+}
+
+SvdbTableItem *svdb_tree_set(const SvdbTableItem *snapshot, const gchar *path, GVariant *value, GError **error) {
+    const SvdbTableItem *old_root_list;
+    SvdbTableItem *root, *list, *item;
+    GPtrArray *copies;
+    gchar **segments;
+    gsize length;
+    guint count;
+
+    if (!snapshot || snapshot->type != SVDB_TYPE_TABLE || !snapshot->frozen) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "snapshot isn't frozen table");
+        return NULL;
+    }
+
+    length = path ? strlen(path) : 0;
+    if (length < 2 || path[0] != '/' || path[length - 1] == '/' || strstr(path, "//")) {
+        g_set_error(error, SVDB_ERROR, 0, "invalid key path(%s)", path ? path : "");
+        return NULL;
+    }
+
+    old_root_list = g_hash_table_lookup(snapshot->table, "/");
+    if (old_root_list && old_root_list->type != SVDB_TYPE_LIST) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "trying to change dir of non-list item(/)");
+        return NULL;
+    }
+
+    segments = g_strsplit(path + 1, "/", -1);
+    count = g_strv_length(segments);
+
+    // Dirs must be lists, and missing key isn't changed by unset (so missing dirs aren't created).
+    if (old_root_list) {
+        GError *tmp_error = NULL;
+        const SvdbTableItem *dir = svdb_snapshot_find_dir(old_root_list, segments, &tmp_error);
+
+        if (tmp_error) {
+            g_propagate_error(error, tmp_error);
+            g_strfreev(segments);
+            return NULL;
+        }
+        if (!value && (!dir || svdb_snapshot_list_find(dir, segments[count - 1]) < 0)) {
+            g_strfreev(segments);
+            return svdb_item_ref(snapshot);
+        }
+    } else if (!value) {
+        g_strfreev(segments);
+        return svdb_item_ref(snapshot);
+    }
+
+    // Only nodes on path are copied, all other subtrees are shared with snapshot.
+    root = svdb_snapshot_copy(snapshot);
+    list = old_root_list ? svdb_snapshot_copy(old_root_list) : svdb_snapshot_new_list();
+    g_hash_table_replace(root->table, g_strdup("/"), list);
+
+    copies = g_ptr_array_new();
+    g_ptr_array_add(copies, list);
+
+    for (guint i = 0; i + 1 < count; ++i) {
+        gchar *key = g_strconcat(segments[i], "/", NULL);
+        gssize index = svdb_snapshot_list_find(list, key);
+        SvdbTableItem *child = index >= 0 ? svdb_snapshot_copy(list->list[index].item) : svdb_snapshot_new_list();
+
+        svdb_snapshot_list_put(list, key, child);
+        g_ptr_array_add(copies, child);
+        list = child;
+        g_free(key);
+    }
+
+    item = NULL;
+    if (value) {
+        item = svdb_item_new();
+        item->type = SVDB_TYPE_VARIANT;
+        item->variant = g_variant_ref_sink(value);
+        item->frozen = TRUE;
+    }
+    svdb_snapshot_list_put(list, segments[count - 1], item);
+
+    // Child counters of copied lists are recomputed bottom-up (list counter is sum of its children ones).
+    for (guint i = copies->len; i > 0; --i) {
+        list = g_ptr_array_index(copies, i - 1);
+
+        list->childs = 0;
+        for (gsize j = 0; j < list->length; ++j) {
+            list->childs += list->list[j].item->childs + 1;
+        }
+    }
+
+    list = g_ptr_array_index(copies, 0);
+    root->childs = snapshot->childs - (old_root_list ? old_root_list->childs + 1 : 0) + list->childs + 1;
+
+    // Hashes of shared subtrees are valid, so only copied nodes are hashed.
+    svdb_item_content_hash(root);
+
+    g_ptr_array_unref(copies);
+    g_strfreev(segments);
+    return root;
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_SNAPSHOT
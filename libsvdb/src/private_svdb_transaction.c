@@ -0,0 +1,381 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_TRANSACTION
+#include "private_svdb_parse.c"
+#define LIBSVDB_PRIVATE_SVDB_TRANSACTION
+
+typedef enum SvdbTransactionOpKind {
+    /// @brief Set variant value of key.
+    SVDB_TRANSACTION_SET,
+    /// @brief Remove key.
+    SVDB_TRANSACTION_UNSET,
+    /// @brief Remove dir with all its content.
+    SVDB_TRANSACTION_REMOVE,
+} SvdbTransactionOpKind;
+
+typedef struct SvdbTransactionOp_t
+{
+    SvdbTransactionOpKind kind;
+    GVariant *value;
+    /// @brief Op has matched existing list element while commit.
+    gboolean applied;
+} SvdbTransactionOp;
+
+struct SvdbTransaction_t
+{
+    SvdbTableItem *table;
+    /// @brief Pending ops grouped by dir (with leading and trailing '/'), dir => (key in dir => op).
+    /// The last op of key wins.
+    GHashTable *dirs;
+};
+
+static void svdb_transaction_op_free(SvdbTransactionOp *op) {
+    if (op->value) {
+        g_variant_unref(op->value);
+    }
+    g_slice_free(SvdbTransactionOp, op);
+}
+
+/// @brief Get index of element in list, or -1.
+static gssize svdb_transaction_list_find(const SvdbTableItem *list, const gchar *key, gsize key_length) {
+    for (gsize i = 0; i < list->length; ++i) {
+        if (strncmp(list->list[i].key, key, key_length) == 0 && list->list[i].key[key_length] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// @brief Queue op on key of dir.
+static void svdb_transaction_add_op(SvdbTransaction *transaction, const gchar *dir, gsize dir_length,
+                                    const gchar *key, SvdbTransactionOpKind kind, GVariant *value) {
+    SvdbTransactionOp *op = g_slice_new0(SvdbTransactionOp);
+    gchar *dir_path = g_strndup(dir, dir_length);
+    GHashTable *ops = g_hash_table_lookup(transaction->dirs, dir_path);
+
+    if (!ops) {
+        ops = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
+                                    (GDestroyNotify) &svdb_transaction_op_free);
+        g_hash_table_insert(transaction->dirs, dir_path, ops);
+    } else {
+        g_free(dir_path);
+    }
+
+    op->kind = kind;
+    op->value = value ? g_variant_ref_sink(value) : NULL;
+    g_hash_table_replace(ops, g_strdup(key), op);
+}
+
+/// @brief Check key path (must start with '/', and doesn't contain empty segments).
+/// @return offset of last segment in path, or 0 if path is invalid.
+static gsize svdb_transaction_check_path(const gchar *path, gboolean is_dir, GError **error) {
+    gsize length = path ? strlen(path) : 0;
+    const gchar *last;
+
+    if (length < 2 || path[0] != '/' || (path[length - 1] == '/') != is_dir || strstr(path, "//")) {
+        g_set_error(error, SVDB_ERROR, 0, "invalid %s path(%s)", is_dir ? "dir" : "key", path ? path : "");
+        return 0;
+    }
+
+    last = path + length - (is_dir ? 2 : 1);
+    while (*last != '/') {
+        --last;
+    }
+    return last - path + 1;
+}
+
+SvdbTransaction *svdb_transaction_new(SvdbTableItem *table) {
+    SvdbTransaction *transaction;
+
+    if (!table || table->type != SVDB_TYPE_TABLE || table->frozen) {
+        return NULL;
+    }
+
+    transaction = g_new0(SvdbTransaction, 1);
+    transaction->table = svdb_item_ref(table);
+    transaction->dirs = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
+                                              (GDestroyNotify) &g_hash_table_unref);
+    return transaction;
+}
+
+gboolean svdb_transaction_set(SvdbTransaction *transaction, const gchar *path, GVariant *value, GError **error) {
+    gsize offset;
+
+    if (!transaction || !value) {
+        return FALSE;
+    }
+
+    offset = svdb_transaction_check_path(path, FALSE, error);
+    if (!offset) {
+        return FALSE;
+    }
+
+    svdb_transaction_add_op(transaction, path, offset, path + offset, SVDB_TRANSACTION_SET, value);
+    return TRUE;
+}
+
+gboolean svdb_transaction_unset(SvdbTransaction *transaction, const gchar *path, GError **error) {
+    gsize offset;
+
+    if (!transaction) {
+        return FALSE;
+    }
+
+    offset = svdb_transaction_check_path(path, FALSE, error);
+    if (!offset) {
+        return FALSE;
+    }
+
+    svdb_transaction_add_op(transaction, path, offset, path + offset, SVDB_TRANSACTION_UNSET, NULL);
+    return TRUE;
+}
+
+static gboolean svdb_transaction_is_subdir(gpointer key, gpointer value, gpointer user_data) {
+    return g_str_has_prefix(key, user_data);
+}
+
+gboolean svdb_transaction_remove(SvdbTransaction *transaction, const gchar *path, GError **error) {
+    gsize offset;
+
+    if (!transaction) {
+        return FALSE;
+    }
+
+    offset = svdb_transaction_check_path(path, TRUE, error);
+    if (!offset) {
+        return FALSE;
+    }
+
+    // Earlier ops inside of dir are overridden by its removal.
+    g_hash_table_foreach_remove(transaction->dirs, svdb_transaction_is_subdir, (gpointer) path);
+    svdb_transaction_add_op(transaction, path, offset, path + offset, SVDB_TRANSACTION_REMOVE, NULL);
+    return TRUE;
+}
+
+/// @brief Check if dir is removed by op in its parent dir (and will be created again, if needed).
+static gboolean svdb_transaction_is_removed(SvdbTransaction *transaction, const gchar *dir, gsize parent_length,
+                                            gsize length) {
+    gchar *parent = g_strndup(dir, parent_length);
+    gchar *key = g_strndup(dir + parent_length, length - parent_length);
+    GHashTable *ops = g_hash_table_lookup(transaction->dirs, parent);
+    SvdbTransactionOp *op = ops ? g_hash_table_lookup(ops, key) : NULL;
+
+    g_free(parent);
+    g_free(key);
+    return op && op->kind == SVDB_TRANSACTION_REMOVE;
+}
+
+/// @brief Walk to list of dir.
+/// @param create - create missing lists (else only check, that existing items on path are lists).
+/// @return list of dir, or NULL (if it doesn't exist, or error is set).
+static SvdbTableItem *svdb_transaction_walk(SvdbTransaction *transaction, const gchar *dir, gboolean create,
+                                           GError **error) {
+    SvdbTableItem *list = g_hash_table_lookup(transaction->table->table, "/");
+    const gchar *segment = dir + 1;
+    GError *tmp_error = NULL;
+
+    if (list && list->type != SVDB_TYPE_LIST) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "trying to change dir of non-list item(/)");
+        return NULL;
+    }
+
+    if (!list) {
+        if (!create) {
+            return NULL;
+        }
+        list = svdb_item_new();
+        svdb_item_list_append(list, NULL, 0, NULL);
+        svdb_table_set(transaction->table, "/", list, NULL);
+        svdb_item_unref(list);
+    }
+
+    while (*segment) {
+        const gchar *end = strchr(segment, '/') + 1;
+        gssize index;
+
+        if (!create && svdb_transaction_is_removed(transaction, dir, segment - dir, end - dir)) {
+            return NULL;
+        }
+
+        index = svdb_transaction_list_find(list, segment, end - segment);
+
+        if (index < 0) {
+            SvdbTableItem *child;
+
+            if (!create) {
+                return NULL;
+            }
+
+            child = svdb_item_new();
+            svdb_item_list_append(child, NULL, 0, NULL);
+            svdb_item_set_parent(child, list, &tmp_error);
+            if (tmp_error) {
+                g_propagate_error(error, tmp_error);
+                svdb_item_unref(child);
+                return NULL;
+            }
+
+            svdb_item_list_reserve(list, list->length + 1);
+            list->list[list->length].key = g_strndup(segment, end - segment);
+            list->list[list->length].item = child;
+            index = list->length++;
+        }
+
+        list = list->list[index].item;
+        if (list->type != SVDB_TYPE_LIST) {
+            gchar *path = g_strndup(dir, end - dir);
+
+            g_set_error(error, SVDB_ERROR, 0, "trying to change dir of non-list item(%s)", path);
+            g_free(path);
+            return NULL;
+        }
+
+        segment = end;
+    }
+
+    return list;
+}
+
+/// @brief Apply ops of dir to its list in one pass (ops are matched with hash lookups).
+static gboolean svdb_transaction_apply(SvdbTableItem *list, GHashTable *ops, GError **error) {
+    GHashTableIter iter;
+    SvdbTransactionOp *op;
+    const gchar *key;
+    gsize kept = 0;
+    GError *tmp_error = NULL;
+
+    // Ops can be applied again by retried commit.
+    g_hash_table_iter_init(&iter, ops);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &op)) {
+        op->applied = FALSE;
+    }
+
+    for (gsize i = 0; i < list->length; ++i) {
+        SvdbListElement *element = list->list + i;
+
+        op = g_hash_table_lookup(ops, element->key);
+        if (op) {
+            op->applied = TRUE;
+
+            if (op->kind != SVDB_TRANSACTION_SET) {
+                svdb_item_clear_unref_dettach(element->item);
+                g_free(element->key);
+                continue;
+            }
+
+            if (element->item->type == SVDB_TYPE_VARIANT) {
+                svdb_item_set_variant(element->item, op->value);
+            } else {
+                SvdbTableItem *item = svdb_item_new();
+
+                svdb_item_set_variant(item, op->value);
+                svdb_item_clear_unref_dettach(element->item);
+                svdb_item_set_parent(item, list, &tmp_error);
+                element->item = item;
+
+                if (tmp_error) {
+                    // Keep rest of elements as is, so list stays valid.
+                    for (; i < list->length; ++i) {
+                        list->list[kept++] = list->list[i];
+                    }
+                    list->length = kept;
+                    g_propagate_error(error, tmp_error);
+                    return FALSE;
+                }
+            }
+        }
+
+        list->list[kept++] = *element;
+    }
+    list->length = kept;
+
+    g_hash_table_iter_init(&iter, ops);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &key, (gpointer *) &op)) {
+        SvdbTableItem *item;
+
+        if (op->applied || op->kind != SVDB_TRANSACTION_SET) {
+            continue;
+        }
+
+        item = svdb_item_new();
+        svdb_item_set_variant(item, op->value);
+        svdb_item_set_parent(item, list, &tmp_error);
+        if (tmp_error) {
+            svdb_item_unref(item);
+            g_propagate_error(error, tmp_error);
+            return FALSE;
+        }
+
+        svdb_item_list_reserve(list, list->length + 1);
+        list->list[list->length].key = g_strdup(key);
+        list->list[list->length].item = item;
+        ++list->length;
+    }
+
+    return TRUE;
+}
+
+static gint svdb_transaction_dir_compare(gconstpointer a, gconstpointer b) {
+    gsize a_length = strlen(*(const gchar *const *) a);
+    gsize b_length = strlen(*(const gchar *const *) b);
+
+    return a_length < b_length ? -1 : a_length > b_length;
+}
+
+gboolean svdb_transaction_commit(SvdbTransaction *transaction, GError **error) {
+    GHashTableIter iter;
+    GPtrArray *dirs;
+    const gchar *dir;
+    gboolean result = TRUE;
+
+    if (!transaction) {
+        return FALSE;
+    }
+
+    // Check all ops before any change, so failed commit doesn't change tree.
+    g_hash_table_iter_init(&iter, transaction->dirs);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &dir, NULL)) {
+        GError *tmp_error = NULL;
+
+        svdb_transaction_walk(transaction, dir, FALSE, &tmp_error);
+        if (tmp_error) {
+            g_propagate_error(error, tmp_error);
+            return FALSE;
+        }
+    }
+
+    // Parent dirs are applied first, so removed dirs are recreated by later ops inside of them.
+    dirs = g_hash_table_get_keys_as_ptr_array(transaction->dirs);
+    g_ptr_array_sort(dirs, svdb_transaction_dir_compare);
+
+    for (guint i = 0; i < dirs->len && result; ++i) {
+        GHashTable *ops = g_hash_table_lookup(transaction->dirs, g_ptr_array_index(dirs, i));
+        SvdbTableItem *list = svdb_transaction_walk(transaction, g_ptr_array_index(dirs, i), TRUE, error);
+
+        result = list && svdb_transaction_apply(list, ops, error);
+    }
+
+    g_ptr_array_unref(dirs);
+
+    // Failed commit keeps ops, so they can be inspected, committed again or rolled back.
+    if (result) {
+        g_hash_table_remove_all(transaction->dirs);
+    }
+    return result;
+}
+
+void svdb_transaction_rollback(SvdbTransaction *transaction) {
+    if (!transaction) {
+        return;
+    }
+    g_hash_table_remove_all(transaction->dirs);
+}
+
+void svdb_transaction_free(SvdbTransaction *transaction) {
+    if (!transaction) {
+        return;
+    }
+    g_hash_table_unref(transaction->dirs);
+    svdb_item_unref(transaction->table);
+    g_free(transaction);
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_TRANSACTION
@@ -0,0 +1,152 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_VARIANT
+#include "private_svdb_common.c"
+#include "private_svdb_verify.c"
+#define LIBSVDB_PRIVATE_SVDB_VARIANT
+
+#define SVDB_VARIANT_TABLE_TYPE ((const GVariantType *) "a{sv}")
+#define SVDB_VARIANT_LIST_TYPE ((const GVariantType *) "a(sv)")
+
+/// @brief Build (floating) variant of subtree, see svdb_item_to_variant.
+static GVariant *svdb_variant_build(const SvdbTableItem *item) {
+    GVariantBuilder builder;
+    SvdbListElement *children;
+    gsize length;
+
+    if (item->type == SVDB_TYPE_VARIANT) {
+        return g_variant_new_variant(svdb_item_peek_variant(item));
+    }
+
+    if (item->type == SVDB_TYPE_TABLE) {
+        // Sorted, so equal tables give equal variants.
+        children = svdb_item_sorted_children(item, &length);
+        g_variant_builder_init(&builder, SVDB_VARIANT_TABLE_TYPE);
+
+        for (gsize i = 0; i < length; ++i) {
+            if (children[i].item->type != SVDB_TYPE_NONE) {
+                g_variant_builder_add(&builder, "{sv}", children[i].key, svdb_variant_build(children[i].item));
+            }
+        }
+
+        g_free(children);
+        return g_variant_builder_end(&builder);
+    }
+
+    g_variant_builder_init(&builder, SVDB_VARIANT_LIST_TYPE);
+    for (gsize i = 0; i < item->length; ++i) {
+        const SvdbListElement *element = item->list + i;
+
+        if (element->item->type != SVDB_TYPE_NONE) {
+            g_variant_builder_add(&builder, "(sv)", element->key ? element->key : "",
+                                  svdb_variant_build(element->item));
+        }
+    }
+    return g_variant_builder_end(&builder);
+}
+
+GVariant *svdb_item_to_variant(const SvdbTableItem *item) {
+    if (!item || item->type == SVDB_TYPE_NONE) {
+        return NULL;
+    }
+    return g_variant_ref_sink(svdb_variant_build(item));
+}
+
+static SvdbTableItem *svdb_variant_parse(GVariant *node, guint depth, GError **error);
+
+/// @brief Parse children of table or list node. Children are attached directly (tree is new), and child counter
+/// is computed once.
+static gboolean svdb_variant_parse_children(SvdbTableItem *item, GVariant *node, guint depth, GError **error) {
+    gsize length = g_variant_n_children(node);
+    GHashTable *keys = NULL;
+
+    if (item->type == SVDB_TYPE_LIST) {
+        keys = g_hash_table_new(&g_str_hash, &g_str_equal);
+        svdb_item_list_reserve(item, length);
+    }
+
+    for (gsize i = 0; i < length; ++i) {
+        GVariant *child_node;
+        SvdbTableItem *child;
+        const gchar *key;
+
+        g_variant_get_child(node, i, item->type == SVDB_TYPE_LIST ? "(&sv)" : "{&sv}", &key, &child_node);
+
+        if (keys ? g_hash_table_contains(keys, key) : g_hash_table_contains(item->table, key)) {
+            g_set_error(error, SVDB_ERROR, 0, "duplicate key(%s) in item variant", key);
+            g_variant_unref(child_node);
+            break;
+        }
+
+        child = svdb_variant_parse(child_node, depth + 1, error);
+        g_variant_unref(child_node);
+        if (!child) {
+            break;
+        }
+
+        child->parent = item;
+        item->childs += child->childs + 1;
+
+        if (keys) {
+            item->list[item->length].key = g_strdup(key);
+            item->list[item->length].item = child;
+            ++item->length;
+            // Keys are borrowed from node, which outlives set.
+            g_hash_table_add(keys, (gpointer) key);
+        } else {
+            g_hash_table_insert(item->table, g_strdup(key), child);
+        }
+    }
+
+    if (keys) {
+        g_hash_table_unref(keys);
+    }
+    return !error || !*error;
+}
+
+static SvdbTableItem *svdb_variant_parse(GVariant *node, guint depth, GError **error) {
+    SvdbTableItem *item;
+    GError *tmp_error = NULL;
+
+    if (depth > SVDB_VERIFY_MAX_DEPTH) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "too deep item variant nesting");
+        return NULL;
+    }
+
+    if (g_variant_is_of_type(node, G_VARIANT_TYPE_VARIANT)) {
+        item = svdb_item_new();
+        item->type = SVDB_TYPE_VARIANT;
+        item->variant = g_variant_get_variant(node);
+        return item;
+    }
+
+    if (g_variant_is_of_type(node, SVDB_VARIANT_TABLE_TYPE)) {
+        item = svdb_table_new();
+    } else if (g_variant_is_of_type(node, SVDB_VARIANT_LIST_TYPE)) {
+        item = svdb_item_new();
+        item->type = SVDB_TYPE_LIST;
+    } else {
+        g_set_error(error, SVDB_ERROR, 0, "invalid item variant type(%s)", g_variant_get_type_string(node));
+        return NULL;
+    }
+
+    if (!svdb_variant_parse_children(item, node, depth, &tmp_error)) {
+        g_propagate_error(error, tmp_error);
+        svdb_item_unref(item);
+        return NULL;
+    }
+    return item;
+}
+
+SvdbTableItem *svdb_item_from_variant(GVariant *variant, GError **error) {
+    SvdbTableItem *item;
+
+    if (!variant) {
+        return NULL;
+    }
+
+    g_variant_ref_sink(variant);
+    item = svdb_variant_parse(variant, 0, error);
+    g_variant_unref(variant);
+    return item;
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_VARIANT
@@ -0,0 +1,316 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_VERIFY
+#include <glib/gstdio.h>
+#include "private_svdb_parse.c"
+#define LIBSVDB_PRIVATE_SVDB_VERIFY
+
+/// @brief Max depth of nested hash tables ('H' items), protects from pointer cycles.
+#define SVDB_VERIFY_MAX_DEPTH 64
+/// @brief Max count of files remembered in verification cache.
+#define SVDB_VERIFY_CACHE_MAX_ENTRIES 64
+
+static gboolean svdb_verify_table(gconstpointer data, gsize size, const struct svdb_pointer table,
+                                  GHashTable *visited, guint depth, GError **error);
+
+static gboolean svdb_verify_parents(const SVDBTableHeader *header, GError **error) {
+    // 0 - not visited, 1 - on current parent chain, 2 - chain terminates at root.
+    guint8 *state = g_malloc0(header->n_hash_items);
+
+    for (guint32 i = 0; i < header->n_hash_items; ++i) {
+        guint32 current = i;
+
+        while (current != (guint32) -1 && state[current] == 0) {
+            guint32 parent = guint32_from_le(header->hash_items[current].parent);
+
+            if (parent != (guint32) -1 && parent >= header->n_hash_items) {
+                g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(parent index out of range)");
+                g_free(state);
+                return FALSE;
+            }
+
+            state[current] = 1;
+            current = parent;
+        }
+
+        if (current != (guint32) -1 && state[current] == 1) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(parent cycle)");
+            g_free(state);
+            return FALSE;
+        }
+
+        current = i;
+        while (current != (guint32) -1 && state[current] == 1) {
+            state[current] = 2;
+            current = guint32_from_le(header->hash_items[current].parent);
+        }
+    }
+
+    g_free(state);
+    return TRUE;
+}
+
+static gboolean svdb_verify_variant(gconstpointer data, gsize size, const struct svdb_hash_item *item,
+                                    GError **error) {
+    gconstpointer value_data;
+    gsize value_size;
+    GVariant *variant;
+    GBytes *bytes;
+    gboolean normal;
+
+    value_data = svdb_table_dereference(data, size, item->value.pointer, 8, &value_size);
+
+    if G_UNLIKELY(value_data == NULL) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid value pointer)");
+        return FALSE;
+    }
+
+    bytes = g_bytes_new_static(value_data, value_size);
+    variant = g_variant_new_from_bytes(G_VARIANT_TYPE_VARIANT, bytes, FALSE);
+    normal = g_variant_is_normal_form(variant);
+    g_variant_unref(variant);
+    g_bytes_unref(bytes);
+
+    if (!normal) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(value isn't in normal form)");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean svdb_verify_list(gconstpointer data, gsize size, const SVDBTableHeader *header,
+                                 guint32 index, GError **error) {
+    const guint32_le *indecies;
+    guint length;
+
+    if (!svdb_table_list_indecies_from_item(data, size, header->hash_items + index, &indecies, &length)) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(corrupted list)");
+        return FALSE;
+    }
+
+    for (guint i = 0; i < length; ++i) {
+        guint32 itemno = guint32_from_le(indecies[i]);
+
+        if (itemno >= header->n_hash_items) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(list index out of range)");
+            return FALSE;
+        }
+        // Together with acyclic parent chains this guarantees that list recursion terminates.
+        if (guint32_from_le(header->hash_items[itemno].parent) != index) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(list element has foreign parent)");
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/// @param visited - offsets of already verified tables, so tables shared by many items are verified once.
+static gboolean svdb_verify_table(gconstpointer data, gsize size, const struct svdb_pointer table,
+                                  GHashTable *visited, guint depth, GError **error) {
+    SVDBTableHeader header;
+    guint32 previous_bucket = 0;
+
+    if (depth > SVDB_VERIFY_MAX_DEPTH) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(too deep table nesting)");
+        return FALSE;
+    }
+
+    if (!g_hash_table_add(visited, GUINT_TO_POINTER(guint32_from_le(table.start)))) {
+        return TRUE;
+    }
+
+    if (!svdb_parse_table_header(data, size, table, &header)) {
+        g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid table header)");
+        return FALSE;
+    }
+
+    for (guint32 i = 0; i < header.n_buckets; ++i) {
+        guint32 bucket = guint32_from_le(header.hash_buckets[i]);
+
+        if (bucket < previous_bucket || bucket > header.n_hash_items) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid hash bucket)");
+            return FALSE;
+        }
+        previous_bucket = bucket;
+    }
+
+    if (!svdb_verify_parents(&header, error)) {
+        return FALSE;
+    }
+
+    for (guint32 i = 0; i < header.n_hash_items; ++i) {
+        const struct svdb_hash_item *item = header.hash_items + i;
+        guint64 key_end = (guint64) guint32_from_le(item->key_start) + guint16_from_le(item->key_size);
+
+        if (key_end > size) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(key out of bounds)");
+            return FALSE;
+        }
+
+        switch (svdb_item_char_to_type(item->type)) {
+            case SVDB_TYPE_VARIANT:
+                if (!svdb_verify_variant(data, size, item, error)) {
+                    return FALSE;
+                }
+                break;
+            case SVDB_TYPE_LIST:
+                if (!svdb_verify_list(data, size, &header, i, error)) {
+                    return FALSE;
+                }
+                break;
+            case SVDB_TYPE_TABLE:
+                if (!svdb_verify_table(data, size, item->value.pointer, visited, depth + 1, error)) {
+                    return FALSE;
+                }
+                break;
+        }
+    }
+
+    return TRUE;
+}
+
+gboolean svdb_verify_bytes(GBytes *bytes, GError **error) {
+    const struct svdb_header *header;
+    GHashTable *visited;
+    gboolean byteswapped;
+    gboolean result;
+    gconstpointer data;
+    gsize size;
+
+    if (!bytes) {
+        return FALSE;
+    }
+
+    data = g_bytes_get_data(bytes, &size);
+
+    if (!svdb_gvdb_header_check(data, size, &byteswapped)) {
+        g_set_error_literal(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "corrupted gvdb file(invalid gvdb header)");
+        return FALSE;
+    }
+
+    header = data;
+    visited = g_hash_table_new(&g_direct_hash, &g_direct_equal);
+    result = svdb_verify_table(data, size, header->root, visited, 0, error);
+    g_hash_table_unref(visited);
+
+    return result;
+}
+
+static gchar *svdb_verify_cache_identity(const gchar *filename) {
+    GStatBuf buf;
+
+    if (g_stat(filename, &buf) != 0) {
+        return NULL;
+    }
+
+    return g_strdup_printf("%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT
+                           ":%" G_GINT64_FORMAT ".%09ld:%" G_GINT64_FORMAT ".%09ld",
+                           (guint64) buf.st_dev, (guint64) buf.st_ino, (guint64) buf.st_size,
+                           (gint64) buf.st_mtim.tv_sec, (long) buf.st_mtim.tv_nsec,
+                           (gint64) buf.st_ctim.tv_sec, (long) buf.st_ctim.tv_nsec);
+}
+
+static void svdb_verify_cache_store(GKeyFile *cache, const gchar *cache_file, const gchar *group,
+                                    const gchar *path, const gchar *identity, const gchar *checksum) {
+    gchar *directory;
+    gchar **groups;
+    gsize length;
+
+    g_key_file_remove_group(cache, group, NULL);
+
+    // Groups keep insertion order, so the first one is the least recently verified file.
+    groups = g_key_file_get_groups(cache, &length);
+    for (gsize i = 0; length - i >= SVDB_VERIFY_CACHE_MAX_ENTRIES; ++i) {
+        g_key_file_remove_group(cache, groups[i], NULL);
+    }
+    g_strfreev(groups);
+
+    g_key_file_set_string(cache, group, "path", path);
+    g_key_file_set_string(cache, group, "identity", identity);
+    g_key_file_set_string(cache, group, "sha256", checksum);
+
+    directory = g_path_get_dirname(cache_file);
+    g_mkdir_with_parents(directory, 0700);
+    g_free(directory);
+
+    // The cache is an optimization only, failing to save it must not fail the load.
+    g_key_file_save_to_file(cache, cache_file, NULL);
+}
+
+/// @brief Check that bytes of file are valid GVDB, using verification cache.
+/// @return TRUE if bytes can be parsed in trusted mode, FALSE (with error) if file is corrupted.
+static gboolean svdb_verify_bytes_cached(const gchar *filename, GBytes *bytes, const gchar *cache_file,
+                                         GError **error) {
+    gchar *default_cache_file = NULL;
+    gchar *identity;
+    gchar *checksum;
+    gchar *path;
+    gchar *group;
+    GKeyFile *cache;
+    gboolean verified = FALSE;
+
+    if (!cache_file) {
+        default_cache_file = g_build_filename(g_get_user_cache_dir(), "dbdconf", "verified", NULL);
+        cache_file = default_cache_file;
+    }
+
+    // Paths can contain chars, which aren't allowed in group names ('[', ']'), so group is hash of path.
+    path = g_canonicalize_filename(filename, NULL);
+    group = g_compute_checksum_for_string(G_CHECKSUM_SHA256, path, -1);
+    identity = svdb_verify_cache_identity(filename);
+    checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, bytes);
+    cache = g_key_file_new();
+
+    if (identity && g_key_file_load_from_file(cache, cache_file, G_KEY_FILE_NONE, NULL)) {
+        gchar *cached_path = g_key_file_get_string(cache, group, "path", NULL);
+        gchar *cached_identity = g_key_file_get_string(cache, group, "identity", NULL);
+        gchar *cached_checksum = g_key_file_get_string(cache, group, "sha256", NULL);
+
+        verified = g_strcmp0(cached_path, path) == 0 && g_strcmp0(cached_identity, identity) == 0
+                   && g_strcmp0(cached_checksum, checksum) == 0;
+
+        g_free(cached_path);
+        g_free(cached_identity);
+        g_free(cached_checksum);
+    }
+
+    if (!verified) {
+        verified = svdb_verify_bytes(bytes, error);
+
+        if (verified && identity) {
+            svdb_verify_cache_store(cache, cache_file, group, path, identity, checksum);
+        }
+    }
+
+    g_key_file_unref(cache);
+    g_free(checksum);
+    g_free(identity);
+    g_free(group);
+    g_free(path);
+    g_free(default_cache_file);
+
+    return verified;
+}
+
+SvdbTableItem *svdb_table_read_from_file_cached(const gchar *filename, const gchar *cache_file, GError **error) {
+    SvdbTableItem *table = NULL;
+    GBytes *bytes;
+
+    // File is verified and then parsed, both passes read it in whole.
+    bytes = svdb_mmap_file(filename, SVDB_LOAD_SEQUENTIAL, error);
+    if (!bytes) {
+        g_prefix_error(error, "%s: ", filename);
+        return NULL;
+    }
+
+    if (svdb_verify_bytes_cached(filename, bytes, cache_file, error)) {
+        table = svdb_table_read_from_bytes(bytes, TRUE, error);
+    }
+    g_bytes_unref(bytes);
+
+    g_prefix_error(error, "%s: ", filename);
+
+    return table;
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_VERIFY
@@ -0,0 +1,209 @@
+#ifndef LIBSVDB_PRIVATE_SVDB_VISIT
+#include "private_svdb_file.c"
+#include "private_svdb_verify.c"
+#define LIBSVDB_PRIVATE_SVDB_VISIT
+
+struct SvdbFileValue_t
+{
+    SvdbFile *file;
+    const struct svdb_hash_item *item;
+    /// @brief Decoded value, or NULL if it wasn't requested yet.
+    GVariant *variant;
+};
+
+/// @brief Frame of explicit walk stack: table, or list inside of table.
+typedef struct SvdbVisitFrame_t
+{
+    /// @brief Hash table, which contains items of frame.
+    SVDBTableHeader header;
+    gboolean is_list;
+    /// @brief List item index in header (for list frames).
+    guint32 index;
+    const guint32_le *indecies;
+    guint count;
+    /// @brief Next item position (in header items for table frames, in indecies for list frames).
+    guint32 position;
+    /// @brief Name length before frame item key (restored on leave).
+    gsize name_length;
+    /// @brief Offset of names of frame table (names of nested table doesn't include names of outer ones).
+    gsize base;
+    /// @brief Count of tables on stack (including this frame).
+    guint depth;
+} SvdbVisitFrame;
+
+GVariant *svdb_file_value_get_variant(SvdbFileValue *value) {
+    if (!value) {
+        return NULL;
+    }
+    if (!value->variant) {
+        value->variant = svdb_file_item_get_value(value->file, value->item);
+    }
+    return value->variant;
+}
+
+/// @brief Get index of next item of frame.
+/// @return index, or (guint32) -1 if there are no more items.
+static guint32 svdb_visit_frame_next(SvdbVisitFrame *frame) {
+    const SVDBTableHeader *header = &frame->header;
+
+    if (!frame->is_list) {
+        while (frame->position < header->n_hash_items) {
+            guint32 index = frame->position++;
+
+            if (guint32_from_le(header->hash_items[index].parent) == (guint32) -1) {
+                return index;
+            }
+        }
+        return (guint32) -1;
+    }
+
+    while (frame->position < frame->count) {
+        guint32 index = guint32_from_le(frame->indecies[frame->position++]);
+
+        // Child must point back to list, so walk is always a tree.
+        if (index < header->n_hash_items && guint32_from_le(header->hash_items[index].parent) == frame->index) {
+            return index;
+        }
+    }
+    return (guint32) -1;
+}
+
+gboolean svdb_file_visit(SvdbFile *file, SvdbVisitFunc func, gpointer user_data, GError **error) {
+    GArray *stack;
+    GString *name;
+    SvdbVisitFrame frame = {0};
+    SvdbVisitResult visit;
+    gboolean result = TRUE;
+
+    if (!file || !func) {
+        return FALSE;
+    }
+
+    visit = func(SVDB_VISIT_ENTER_TABLE, "", "", NULL, user_data);
+    if (visit != SVDB_VISIT_CONTINUE) {
+        return TRUE;
+    }
+
+    stack = g_array_new(FALSE, FALSE, sizeof(SvdbVisitFrame));
+    name = g_string_new(NULL);
+
+    frame.header = file->root;
+    frame.depth = 1;
+    g_array_append_val(stack, frame);
+
+    while (stack->len) {
+        SvdbVisitFrame *top = &g_array_index(stack, SvdbVisitFrame, stack->len - 1);
+        guint32 index = svdb_visit_frame_next(top);
+        const struct svdb_hash_item *item;
+        const gchar *key;
+        guint32 start, length;
+        gsize name_length;
+        gsize base;
+
+        if (index == (guint32) -1) {
+            name_length = top->name_length;
+            g_array_set_size(stack, stack->len - 1);
+            func(SVDB_VISIT_LEAVE, NULL, NULL, NULL, user_data);
+            g_string_truncate(name, name_length);
+            continue;
+        }
+
+        item = top->header.hash_items + index;
+        start = guint32_from_le(item->key_start);
+        length = guint16_from_le(item->key_size);
+
+        if G_UNLIKELY((guint64) start + length > file->size) {
+            g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(key out of bounds)");
+            result = FALSE;
+            break;
+        }
+
+        name_length = name->len;
+        base = top->base;
+        g_string_append_len(name, (const gchar *) file->data + start, length);
+        key = name->str + name_length;
+
+        switch (svdb_item_char_to_type(item->type)) {
+            case SVDB_TYPE_VARIANT: {
+                SvdbFileValue value = {file, item, NULL};
+
+                visit = func(SVDB_VISIT_VALUE, name->str + base, key, &value, user_data);
+                if (value.variant) {
+                    g_variant_unref(value.variant);
+                }
+                g_string_truncate(name, name_length);
+                break;
+            }
+            case SVDB_TYPE_LIST: {
+                SvdbVisitFrame list = {0};
+
+                if (!svdb_table_list_indecies_from_item(file->data, file->size, item, &list.indecies, &list.count)) {
+                    g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(corrupted list)");
+                    result = FALSE;
+                    visit = SVDB_VISIT_STOP;
+                    break;
+                }
+
+                visit = func(SVDB_VISIT_ENTER_LIST, name->str + base, key, NULL, user_data);
+                if (visit != SVDB_VISIT_CONTINUE) {
+                    g_string_truncate(name, name_length);
+                    break;
+                }
+
+                list.header = top->header;
+                list.is_list = TRUE;
+                list.index = index;
+                list.name_length = name_length;
+                list.base = base;
+                list.depth = top->depth;
+                g_array_append_val(stack, list);
+                break;
+            }
+            case SVDB_TYPE_TABLE: {
+                SvdbVisitFrame table = {0};
+
+                if (top->depth >= SVDB_VERIFY_MAX_DEPTH) {
+                    g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(too deep table nesting)");
+                    result = FALSE;
+                    visit = SVDB_VISIT_STOP;
+                    break;
+                }
+                if (!svdb_parse_table_header(file->data, file->size, item->value.pointer, &table.header)) {
+                    g_set_error_literal(error, SVDB_ERROR, 0, "corrupted gvdb file(invalid table header)");
+                    result = FALSE;
+                    visit = SVDB_VISIT_STOP;
+                    break;
+                }
+                if (file->flags & SVDB_LOAD_RANDOM) {
+                    svdb_mmap_prefetch_table(&table.header);
+                }
+
+                visit = func(SVDB_VISIT_ENTER_TABLE, name->str + base, key, NULL, user_data);
+                if (visit != SVDB_VISIT_CONTINUE) {
+                    g_string_truncate(name, name_length);
+                    break;
+                }
+
+                table.name_length = name_length;
+                table.base = name->len;
+                table.depth = top->depth + 1;
+                g_array_append_val(stack, table);
+                break;
+            }
+            default:
+                visit = SVDB_VISIT_CONTINUE;
+                g_string_truncate(name, name_length);
+                break;
+        }
+
+        if (visit == SVDB_VISIT_STOP) {
+            break;
+        }
+    }
+
+    g_string_free(name, TRUE);
+    g_array_unref(stack);
+    return result;
+}
+
+#endif // LIBSVDB_PRIVATE_SVDB_VISIT
@@ -1,7 +1,21 @@
 #include "private_svdb_parse.c"
 #include "private_svdb_export.c"
+#include "private_svdb_verify.c"
+#include "private_svdb_file.c"
+#include "private_svdb_visit.c"
+#include "private_svdb_find.c"
+#include "private_svdb_diff.c"
+#include "private_svdb_builder.c"
+#include "private_svdb_transaction.c"
+#include "private_svdb_snapshot.c"
+#include "private_svdb_overlay.c"
+#include "private_svdb_variant.c"
+#include "private_svdb_async.c"
+#include "private_svdb_print.c"
+#include "private_svdb_record.c"
 
 G_DEFINE_BOXED_TYPE(SvdbTableItem, svdb_table, svdb_item_ref, svdb_item_unref)
+G_DEFINE_BOXED_TYPE(SvdbFile, svdb_file, svdb_file_ref, svdb_file_unref)
 
 SvdbTableItem *svdb_table_new() {
     GHashTable *table = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
@@ -12,61 +26,22 @@ SvdbTableItem *svdb_table_new() {
 }
 
 SvdbTableItem *svdb_table_read_from_file(const gchar *filename, gboolean trusted, GError **error) {
-    GMappedFile *mapped;
-    SvdbTableItem *table;
-    GBytes *bytes;
-
-    mapped = g_mapped_file_new(filename, FALSE, error);
-    if (!mapped) {
-        return NULL;
-    }
-
-    bytes = g_mapped_file_get_bytes(mapped);
-    table = svdb_table_read_from_bytes(bytes, trusted, error);
-    g_mapped_file_unref(mapped);
-    g_bytes_unref(bytes);
-
-    g_prefix_error(error, "%s: ", filename);
+    return svdb_parse_file(filename, trusted, SVDB_LOAD_SEQUENTIAL, NULL, error);
+}
 
-    return table;
+SvdbTableItem *svdb_table_read_from_file_full(const gchar *filename, gboolean trusted, SvdbLoadFlags flags,
+                                              GError **error) {
+    return svdb_parse_file(filename, trusted, flags, NULL, error);
 }
 
 SvdbTableItem *svdb_table_read_from_bytes(GBytes *bytes, gboolean trusted, GError **error) {
-    const struct svdb_header *header;
-    gsize size;
-    gboolean byteswapped;
-    gconstpointer data;
-
-    data = g_bytes_get_data(bytes, &size);
-
-    if (size < sizeof *header) {
-        goto invalid;
-    }
-
-    header = (gpointer) data;
-
-    if (header->signature[0] == GVDB_SIGNATURE0 && header->signature[1] == GVDB_SIGNATURE1
-        && guint32_from_le(header->version) == 0) {
-        byteswapped = FALSE;
-    } else if (header->signature[0] == GVDB_SWAPPED_SIGNATURE0
-               && header->signature[1] == GVDB_SWAPPED_SIGNATURE1
-               && guint32_from_le(header->version) == 0) {
-        byteswapped = TRUE;
-    } else {
-        goto invalid;
-    }
-
-    return svdb_parse_table(data, size, byteswapped, trusted, header->root, error);
-
-invalid:
-    g_set_error_literal(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "corrupted gvdb file(invalid gvdb header)");
-    return NULL;
+    return svdb_parse_bytes(bytes, trusted, NULL, error);
 }
 
 gboolean svdb_table_set(SvdbTableItem *table, const gchar *key,
                         SvdbTableItem *value, GError **error) {
     GError *tmp_error = NULL;
-    if (!table || table->type != SVDB_TYPE_TABLE || !key) {
+    if (!table || table->type != SVDB_TYPE_TABLE || table->frozen || !key) {
         return FALSE;
     }
 
@@ -100,10 +75,8 @@ gchar **svdb_table_list_child(const SvdbTableItem *table, gsize *size, GError **
     gsize tmp;
     gchar **result;
     gchar **str_iter;
-    SvdbTableItem *item;
-    const gchar *key;
-
-    GHashTableIter iter;
+    SvdbListElement *children;
+    gsize length;
 
     if (!size) {
         size = &tmp;
@@ -113,7 +86,7 @@ gchar **svdb_table_list_child(const SvdbTableItem *table, gsize *size, GError **
         return NULL;
     }
 
-    *size = g_hash_table_size(table->table);
+    *size = svdb_item_get_length(table);
 
     if (!*size) {
         return NULL;
@@ -122,16 +95,19 @@ gchar **svdb_table_list_child(const SvdbTableItem *table, gsize *size, GError **
     result = g_new(gchar*, *size + 1);
     str_iter = result;
 
-    g_hash_table_iter_init(&iter, table->table);
-    while (g_hash_table_iter_next(&iter, (gpointer) &key, (gpointer) &item)) {
-        if (item->type == SVDB_TYPE_TABLE) {
-            *str_iter = g_strdup_printf("%s/", key);
+    // Children are listed in key order, so equal tables give equal lists.
+    children = svdb_item_sorted_children(table, &length);
+
+    for (gsize i = 0; i < length; ++i) {
+        if (children[i].item->type == SVDB_TYPE_TABLE) {
+            *str_iter = g_strconcat(children[i].key, "/", NULL);
         } else {
-            *str_iter = g_strdup(key);
+            *str_iter = g_strdup(children[i].key);
         }
         ++str_iter;
     }
     *str_iter = NULL;
+    g_free(children);
 
     // result real length must be equal `g_hash_table_size()`.
     if (str_iter - result != *size) {
@@ -143,8 +119,87 @@ gchar **svdb_table_list_child(const SvdbTableItem *table, gsize *size, GError **
     return result;
 }
 
+void svdb_iter_init(SvdbIter *iter, const SvdbTableItem *item) {
+    if (!iter) {
+        return;
+    }
+
+    iter->item = item;
+    iter->index = 0;
+
+    if (item && item->type == SVDB_TYPE_TABLE) {
+        g_hash_table_iter_init(&iter->table_iter, item->table);
+    }
+}
+
+gboolean svdb_iter_next(SvdbIter *iter, const gchar **key, SvdbTableItem **value) {
+    const gchar *tmp_key;
+    SvdbTableItem *tmp_value;
+
+    if (!iter || !iter->item) {
+        return FALSE;
+    }
+    if (!key) {
+        key = &tmp_key;
+    }
+    if (!value) {
+        value = &tmp_value;
+    }
+
+    switch (iter->item->type) {
+        case SVDB_TYPE_TABLE:
+            return g_hash_table_iter_next(&iter->table_iter, (gpointer *) key, (gpointer *) value);
+        case SVDB_TYPE_LIST:
+            if (iter->index >= iter->item->length) {
+                return FALSE;
+            }
+            *key = iter->item->list[iter->index].key;
+            *value = iter->item->list[iter->index].item;
+            ++iter->index;
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+gsize svdb_item_foreach(const SvdbTableItem *item, SvdbForeachFunc func, gpointer user_data) {
+    const gchar *key;
+    SvdbTableItem *value;
+    SvdbIter iter;
+    gsize count = 0;
+
+    if (!func) {
+        return 0;
+    }
+
+    svdb_iter_init(&iter, item);
+    while (svdb_iter_next(&iter, &key, &value)) {
+        ++count;
+        if (!func(key, value, user_data)) {
+            break;
+        }
+    }
+
+    return count;
+}
+
+gsize svdb_item_get_length(const SvdbTableItem *item) {
+    if (!item) {
+        return 0;
+    }
+
+    switch (item->type) {
+        case SVDB_TYPE_TABLE:
+            return g_hash_table_size(item->table);
+        case SVDB_TYPE_LIST:
+            return item->length;
+        default:
+            return 0;
+    }
+}
+
 gboolean svdb_table_unset(SvdbTableItem *table, const gchar *key) {
-    if (!table || table->type != SVDB_TYPE_TABLE) {
+    if (!table || table->type != SVDB_TYPE_TABLE || table->frozen) {
         return FALSE;
     }
     return g_hash_table_remove(table->table, key);
@@ -152,13 +207,13 @@ gboolean svdb_table_unset(SvdbTableItem *table, const gchar *key) {
 
 SvdbTableItem *svdb_item_new() {
     SvdbTableItem *item = g_malloc0(sizeof *item);
-    ++item->refcount;
+    g_atomic_ref_count_init(&item->refcount);
     return item;
 }
 
 gboolean svdb_item_set_list(SvdbTableItem *item, const SvdbListElement *list,
                             guint32 length, GError **error) {
-    if (!item) {
+    if (!item || item->frozen) {
         return FALSE;
     }
 
@@ -173,6 +228,7 @@ gboolean svdb_item_set_list(SvdbTableItem *item, const SvdbListElement *list,
 
     item->length = length;
     item->list = g_malloc(length * sizeof *item->list);
+    item->capacity = length;
     item->childs = 0;
 
     for (guint32 i = 0; i < length; ++i) {
@@ -194,7 +250,7 @@ gboolean svdb_item_set_list(SvdbTableItem *item, const SvdbListElement *list,
 
 gboolean svdb_item_list_append(SvdbTableItem *item, const SvdbListElement *list,
                                guint32 length, GError **error) {
-    if (!item) {
+    if (!item || item->frozen) {
         return FALSE;
     }
     GError *tmp_error = NULL;
@@ -209,8 +265,8 @@ gboolean svdb_item_list_append(SvdbTableItem *item, const SvdbListElement *list,
     }
 
     gsize old_length = item->length;
+    svdb_item_list_reserve(item, old_length + length);
     item->length += length;
-    item->list = g_realloc(item->list, item->length * sizeof *item->list);
 
     for (gsize i = old_length; i < item->length; ++i) {
         svdb_item_set_parent(list[i - old_length].item, item, &tmp_error);
@@ -223,7 +279,7 @@ gboolean svdb_item_list_append(SvdbTableItem *item, const SvdbListElement *list,
 
     for (gsize i = old_length; i < item->length; ++i) {
         item->list[i].item = svdb_item_ref(list[i - old_length].item);
-        item->list[i].key = g_strdup(list[i].key);
+        item->list[i].key = g_strdup(list[i - old_length].key);
     }
 
     return TRUE;
@@ -244,7 +300,7 @@ gboolean svdb_item_list_append_variant(SvdbTableItem *list, const gchar *key, GV
 }
 
 gboolean svdb_item_list_append_value(SvdbTableItem *list, const gchar *key, SvdbTableItem *value, GError **error) {
-    if (!list) {
+    if (!list || list->frozen) {
         return FALSE;
     }
     GError *tmp_error = NULL;
@@ -252,8 +308,8 @@ gboolean svdb_item_list_append_value(SvdbTableItem *list, const gchar *key, Svdb
     if (list->type != SVDB_TYPE_LIST) {
         svdb_item_clear(list);
         list->type = SVDB_TYPE_LIST;
+        svdb_item_list_reserve(list, 1);
         list->length = 1;
-        list->list = g_malloc(sizeof *list->list);
         list->list->item = svdb_item_ref(value);
         list->list->key = g_strdup(key);
         return TRUE;
@@ -275,8 +331,8 @@ gboolean svdb_item_list_append_value(SvdbTableItem *list, const gchar *key, Svdb
         }
     }
 
+    svdb_item_list_reserve(list, list->length + 1);
     ++list->length;
-    list->list = g_realloc(list->list, list->length * sizeof *list->list);
     svdb_item_set_parent(value, list, &tmp_error);
     if (tmp_error) {
         g_propagate_error(error, tmp_error);
@@ -290,7 +346,7 @@ gboolean svdb_item_list_append_value(SvdbTableItem *list, const gchar *key, Svdb
 }
 
 gboolean svdb_item_list_remove_element(SvdbTableItem *item, const gchar *element) {
-    if (!item || !element || item->type != SVDB_TYPE_LIST || !item->length) {
+    if (!item || !element || item->type != SVDB_TYPE_LIST || item->frozen || !item->length) {
         return FALSE;
     }
     gsize pos = -1;
@@ -309,83 +365,59 @@ gboolean svdb_item_list_remove_element(SvdbTableItem *item, const gchar *element
     svdb_item_clear_unref_dettach(item->list[pos].item);
     g_free(item->list[pos].key);
 
-    for (gsize i = pos; i < item->length - 1; ++i) {
-        item->list[i].item = item->list[i + 1].item;
-    }
+    memmove(item->list + pos, item->list + pos + 1, (item->length - pos - 1) * sizeof *item->list);
+    --item->length;
     return TRUE;
 }
 
 gboolean svdb_item_list_remove_elements(SvdbTableItem *item, const gchar **elements, gsize nelements,
                                         gboolean exist_cancel) {
-    if (!item || !elements || item->type != SVDB_TYPE_LIST) {
+    if (!item || !elements || item->type != SVDB_TYPE_LIST || item->frozen) {
         return FALSE;
     }
 
-    if (!*elements) {
+    if (!nelements || !*elements) {
         return TRUE;
     }
 
-    gsize size = 0;
-    gboolean *exists = NULL;
-    SvdbListElement *new_list = NULL;
+    GHashTable *removed = g_hash_table_new(&g_str_hash, &g_str_equal);
+    gsize kept = 0;
 
-    if (exist_cancel) {
-        exists = g_new0(gboolean, nelements);
-    }
-
-    for (gsize i = 0; i < item->length; ++i) {
-        gboolean founded = FALSE;
-        for (gsize j = 0; j < nelements; ++j) {
-            if (strcmp(item->list[i].key, elements[j]) == 0) {
-                founded = TRUE;
-                if (exist_cancel) {
-                    exists[j] = TRUE;
-                }
-                break;
-            }
-        }
-        if (!founded) {
-            new_list = g_realloc_n(new_list, sizeof *new_list, ++size);
-            new_list[size - 1] = item->list[i];
-            item->list[i].item = NULL;
-            item->list[i].key = NULL;
-        }
+    for (gsize i = 0; i < nelements; ++i) {
+        g_hash_table_add(removed, (gpointer) elements[i]);
     }
 
     if (exist_cancel) {
-        gboolean all = TRUE;
-        for (gsize i = 0; i < nelements; ++i) {
-            if (!exists[i]) {
-                all = FALSE;
-                break;
+        gsize found = 0;
+
+        // List keys are unique, so all keys exist iff count of found ones is count of distinct keys.
+        for (gsize i = 0; i < item->length; ++i) {
+            if (g_hash_table_contains(removed, item->list[i].key)) {
+                ++found;
             }
         }
-        if (!all) {
-            gsize alt_count = 0;
-            for (gsize i = 0; i < item->length; ++i) {
-                if (!item->list[i].key) {
-                    item->list[i] = new_list[alt_count++];
-                }
-            }
-            g_free(new_list);
-            g_free(exists);
+        if (found != g_hash_table_size(removed)) {
+            g_hash_table_unref(removed);
             return FALSE;
         }
     }
-    for (gsize i = item->length; i > 0; --i) {
-        if (!item->list[i - 1].key) {
-            g_free(item->list[i - 1].key);
-            svdb_item_clear_unref_dettach(item->list[i - 1].item);
+
+    for (gsize i = 0; i < item->length; ++i) {
+        if (g_hash_table_contains(removed, item->list[i].key)) {
+            svdb_item_clear_unref_dettach(item->list[i].item);
+            g_free(item->list[i].key);
+            continue;
         }
+        item->list[kept++] = item->list[i];
     }
-    g_free(item->list);
-    item->list = new_list;
-    item->length = size;
+
+    item->length = kept;
+    g_hash_table_unref(removed);
     return TRUE;
 }
 
 gboolean svdb_item_list_clear(SvdbTableItem *item) {
-    if (!item || item->type != SVDB_TYPE_LIST) {
+    if (!item || item->type != SVDB_TYPE_LIST || item->frozen) {
         return FALSE;
     }
     for (gsize i = item->length; i > 0; --i) {
@@ -395,11 +427,12 @@ gboolean svdb_item_list_clear(SvdbTableItem *item) {
     g_free(item->list);
     item->list = NULL;
     item->length = 0;
+    item->capacity = 0;
     return TRUE;
 }
 
 gboolean svdb_item_set_variant(SvdbTableItem *item, GVariant *variant) {
-    if (!item) {
+    if (!item || item->frozen) {
         return FALSE;
     }
 
@@ -443,7 +476,7 @@ GVariant *svdb_item_get_variant(const SvdbTableItem *item) {
     if (item->type != SVDB_TYPE_VARIANT) {
         return NULL;
     }
-    return g_variant_ref(item->variant);
+    return g_variant_ref(svdb_item_peek_variant(item));
 }
 
 GString *svdb_item_dump(const SvdbTableItem *item, const gchar *path, gboolean valueMode) {
@@ -459,37 +492,43 @@ GString *svdb_item_dump(const SvdbTableItem *item, const gchar *path, gboolean v
         case SVDB_TYPE_LIST: {
             GString *result = NULL;
             GString *tmp;
+            SvdbListElement *children;
+            gsize length;
+
+            // Elements are dumped in key order, so equal lists give equal text.
+            children = svdb_item_sorted_children(item, &length);
 
             if (valueMode) {
-                if (item->length == 0) {
+                if (length == 0) {
                     return g_string_new_len("{}", 2);
                 }
                 result = g_string_new("{");
 
-                tmp = svdb_item_dump(item->list[0].item, path, TRUE);
-                g_string_append_printf(result, "%s: %s", item->list[0].key, tmp->str);
+                tmp = svdb_item_dump(children[0].item, path, TRUE);
+                g_string_append_printf(result, "%s: %s", children[0].key, tmp->str);
                 g_string_free(tmp, TRUE);
 
-                for (int i = 1; i < item->length; ++i) {
-                    tmp = svdb_item_dump(item->list[i].item, path, TRUE);
-                    g_string_append_printf(result, ", %s: %s", item->list[i].key, tmp->str);
+                for (gsize i = 1; i < length; ++i) {
+                    tmp = svdb_item_dump(children[i].item, path, TRUE);
+                    g_string_append_printf(result, ", %s: %s", children[i].key, tmp->str);
                     g_string_free(tmp, TRUE);
                 }
 
                 g_string_append_c(result, '}');
 
+                g_free(children);
                 return result;
             }
 
-            if (item->length == 0) {
+            if (length == 0) {
                 return g_string_new(NULL);
             }
 
             GString *other = NULL;
-            for (int i = 0; i < item->length; ++i) {
-                if (item->list[i].item->type == SVDB_TYPE_LIST) {
-                    gchar *sub_path = g_strdup_printf("%s%s", path, item->list[i].key);
-                    tmp = svdb_item_dump(item->list[i].item, sub_path, FALSE);
+            for (gsize i = 0; i < length; ++i) {
+                if (children[i].item->type == SVDB_TYPE_LIST) {
+                    gchar *sub_path = g_strdup_printf("%s%s", path, children[i].key);
+                    tmp = svdb_item_dump(children[i].item, sub_path, FALSE);
 
                     if (tmp) {
                         if (!other) {
@@ -515,9 +554,17 @@ GString *svdb_item_dump(const SvdbTableItem *item, const gchar *path, gboolean v
                     }
                     g_string_append_c(result, ']');
                 }
-                tmp = svdb_item_dump(item->list[i].item, path, FALSE);
-                g_string_append_printf(result, "\n%s=%s", item->list[i].key, tmp->str);
-                g_string_free(tmp, TRUE);
+                g_string_append_c(result, '\n');
+                g_string_append(result, children[i].key);
+                g_string_append_c(result, '=');
+                if (children[i].item->type == SVDB_TYPE_VARIANT) {
+                    // Values (most of dump) are printed right into result.
+                    svdb_variant_print_string(svdb_item_peek_variant(children[i].item), result, FALSE);
+                } else {
+                    tmp = svdb_item_dump(children[i].item, path, FALSE);
+                    g_string_append_len(result, tmp->str, tmp->len);
+                    g_string_free(tmp, TRUE);
+                }
             }
             if (other) {
                 if (!result) {
@@ -529,44 +576,70 @@ GString *svdb_item_dump(const SvdbTableItem *item, const gchar *path, gboolean v
                 }
             }
 
+            g_free(children);
             return result;
         }
         case SVDB_TYPE_VARIANT: {
-            return g_variant_print_string(item->variant, NULL, FALSE);
+            return svdb_variant_print_string(svdb_item_peek_variant(item), NULL, FALSE);
         }
 
         case SVDB_TYPE_TABLE: {
-            const gchar *key;
-            const SvdbTableItem *key_item;
-            GHashTableIter iter;
+            SvdbListElement *children;
             GString *result;
             GString *tmp;
+            gsize length;
 
-            g_hash_table_iter_init(&iter, item->table);
+            // Items are dumped in key order (not GHashTable one), so equal tables give equal text.
+            children = svdb_item_sorted_children(item, &length);
 
-            if (!g_hash_table_iter_next(&iter, (gpointer) &key, (gpointer) &key_item)) {
+            if (length == 0) {
                 return g_string_new("{}");
             }
 
             result = g_string_new("{");
 
-            tmp = svdb_item_dump(key_item, path, TRUE);
-            g_string_append_printf(result, "%s: %s", key, tmp->str);
-            g_string_free(tmp, TRUE);
-
-            while (g_hash_table_iter_next(&iter, (gpointer) &key, (gpointer) &key_item)) {
-                tmp = svdb_item_dump(key_item, path, TRUE);
-                g_string_append_printf(result, ", %s: %s", key, tmp->str);
+            for (gsize i = 0; i < length; ++i) {
+                tmp = svdb_item_dump(children[i].item, path, TRUE);
+                g_string_append_printf(result, i ? ", %s: %s" : "%s: %s", children[i].key, tmp->str);
                 g_string_free(tmp, TRUE);
             }
 
             g_string_append_c(result, '}');
 
+            g_free(children);
             return result;
         }
     }
 }
 
+gchar *svdb_item_get_content_hash(const SvdbTableItem *item) {
+    const guint8 *hash;
+    GString *result;
+
+    if (!item) {
+        return NULL;
+    }
+
+    hash = svdb_item_content_hash(item);
+    result = g_string_sized_new(SVDB_CONTENT_HASH_SIZE * 2);
+
+    for (gsize i = 0; i < SVDB_CONTENT_HASH_SIZE; ++i) {
+        g_string_append_printf(result, "%02x", hash[i]);
+    }
+
+    return g_string_free(result, FALSE);
+}
+
+gboolean svdb_item_equal(const SvdbTableItem *item, const SvdbTableItem *other) {
+    if (item == other) {
+        return TRUE;
+    }
+    if (!item || !other) {
+        return FALSE;
+    }
+    return memcmp(svdb_item_content_hash(item), svdb_item_content_hash(other), SVDB_CONTENT_HASH_SIZE) == 0;
+}
+
 SvdbTableItem *svdb_item_list_get_element(const SvdbTableItem *list, const gchar *key) {
     if (!list || list->type != SVDB_TYPE_LIST || list->length == 0 || !key) {
         return NULL;
@@ -586,7 +659,7 @@ SvdbTableItem *svdb_item_ref(const SvdbTableItem *item) {
     if (!item) {
         return NULL;
     }
-    ++((SvdbTableItem *) item)->refcount;
+    g_atomic_ref_count_inc(&((SvdbTableItem *) item)->refcount);
     return (gpointer) item;
 }
 
@@ -594,7 +667,7 @@ void svdb_item_unref(SvdbTableItem *item) {
     if (!item) {
         return;
     }
-    if (!--item->refcount) {
+    if (g_atomic_ref_count_dec(&item->refcount)) {
         svdb_item_clear(item);
         g_free(item);
     }
@@ -76,6 +76,10 @@ GString* svdb_dump_path(const SvdbTableItem* table, const gchar* path, GError**
     return result;
 }
 
+static int svdb_key_compare(const void *a, const void *b) {
+    return strcmp(*(const gchar *const *) a, *(const gchar *const *) b);
+}
+
 GString* svdb_list_path(const SvdbTableItem* table, const gchar* path, GError** error) {
     if (!table || !path) {
         return NULL;
@@ -87,22 +91,34 @@ GString* svdb_list_path(const SvdbTableItem* table, const gchar* path, GError**
     }
 
     GString *result = NULL;
-    gsize size;
-
-    const SvdbListElement* elements = svdb_item_get_list(table, &size);
-
-    if (!elements) {
-        return NULL;
+    const gchar **keys;
+    gsize count = 0;
+    gsize length = 0;
+    SvdbIter iter;
+
+    // Count result length first, so result is allocated only once.
+    keys = g_new(const gchar *, svdb_item_get_length(table) + 1);
+    svdb_iter_init(&iter, table);
+    while (svdb_iter_next(&iter, &keys[count], NULL)) {
+        length += strlen(keys[count++]) + 1;
     }
 
-    for (gsize i = 0; i < size; ++i) {
-        if (!result) {
-            result = g_string_new(elements[i].key);
-            continue;
+    if (length) {
+        // Keys are sorted, so output doesn't depend on GHashTable order.
+        qsort(keys, count, sizeof *keys, svdb_key_compare);
+        result = g_string_sized_new(length);
+
+        for (gsize i = 0; i < count; ++i) {
+            if (result->len) {
+                g_string_append_c(result, '\n');
+            }
+            g_string_append(result, keys[i]);
         }
-        g_string_append_printf(result, "\n%s", elements[i].key);
     }
 
+    g_free(keys);
+
+    svdb_item_unref((gpointer) table); // isn't const, see svdb_table_join_to signature.
     return result;
 }
 GString* svdb_read_path(const SvdbTableItem* table, const gchar* path, GError** error) {
@@ -0,0 +1,117 @@
+#include <glib/gstdio.h>
+#include <svdb.h>
+
+void on_ready(GObject *source, GAsyncResult *result, gpointer user_data) {
+    GAsyncResult **out = user_data;
+
+    *out = g_object_ref(result);
+}
+
+/// @brief Run default main context until callback stores result.
+GAsyncResult *wait_result(GAsyncResult **result) {
+    while (!*result) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+    return *result;
+}
+
+void check_file(const gchar *filename, const gchar *tmp_filename) {
+    GError *error = NULL;
+    GAsyncResult *result = NULL;
+    SvdbTableItem *table, *expected, *written;
+
+    expected = svdb_table_read_from_file(filename, FALSE, &error);
+    g_assert_no_error(error);
+
+    svdb_table_read_from_file_async(filename, FALSE, G_PRIORITY_DEFAULT, NULL, on_ready, &result);
+    table = svdb_table_read_from_file_finish(wait_result(&result), &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(table, expected));
+    g_clear_object(&result);
+
+    svdb_table_write_to_file_async(table, tmp_filename, TRUE, G_PRIORITY_LOW, NULL, on_ready, &result);
+    g_assert(svdb_table_write_to_file_finish(wait_result(&result), &error));
+    g_assert_no_error(error);
+    g_clear_object(&result);
+
+    written = svdb_table_read_from_file(tmp_filename, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(written, expected));
+
+    svdb_item_unref(written);
+    svdb_item_unref(table);
+    svdb_item_unref(expected);
+}
+
+void check_cancel(const gchar *filename, const gchar *tmp_filename) {
+    GError *error = NULL;
+    GAsyncResult *result = NULL;
+    GCancellable *cancellable = g_cancellable_new();
+    SvdbTableItem *table, *old;
+
+    old = svdb_table_read_from_file(tmp_filename, FALSE, &error);
+    g_assert_no_error(error);
+    g_cancellable_cancel(cancellable);
+
+    svdb_table_read_from_file_async(filename, FALSE, G_PRIORITY_DEFAULT, cancellable, on_ready, &result);
+    table = svdb_table_read_from_file_finish(wait_result(&result), &error);
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_assert(!table);
+    g_clear_error(&error);
+    g_clear_object(&result);
+
+    table = svdb_table_read_from_file(filename, FALSE, &error);
+    g_assert_no_error(error);
+
+    // Cancelled write keeps old file.
+    svdb_table_write_to_file_async(table, tmp_filename, FALSE, G_PRIORITY_DEFAULT, cancellable, on_ready, &result);
+    g_assert(!svdb_table_write_to_file_finish(wait_result(&result), &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error(&error);
+    g_clear_object(&result);
+    svdb_item_unref(table);
+
+    table = svdb_table_read_from_file(tmp_filename, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(table, old));
+
+    svdb_item_unref(table);
+    svdb_item_unref(old);
+    g_object_unref(cancellable);
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    gchar *tmp_dir, *tmp_filename;
+    GError *error = NULL;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    tmp_dir = g_dir_make_tmp("svdb-async-XXXXXX", &error);
+    g_assert_no_error(error);
+    tmp_filename = g_build_filename(tmp_dir, "out.gvdb", NULL);
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        check_file(file_full_path, tmp_filename);
+        check_cancel(file_full_path, tmp_filename);
+        g_free(file_full_path);
+    }
+    g_dir_close(dir);
+
+    g_remove(tmp_filename);
+    g_rmdir(tmp_dir);
+    g_free(tmp_filename);
+    g_free(tmp_dir);
+}
@@ -1,2 +1,23 @@
 add_test_dbdconf(db_dump "${CMAKE_CURRENT_LIST_DIR}/db_dump.c")
 add_test_dbdconf(dbd_read_write_read "${CMAKE_CURRENT_LIST_DIR}/dbd_read_write_read.c")
+add_test_dbdconf(verify "${CMAKE_CURRENT_LIST_DIR}/verify.c")
+add_test_dbdconf(file_lookup "${CMAKE_CURRENT_LIST_DIR}/file_lookup.c")
+add_test_dbdconf(find "${CMAKE_CURRENT_LIST_DIR}/find.c")
+add_test_dbdconf(diff "${CMAKE_CURRENT_LIST_DIR}/diff.c")
+add_test_dbdconf(content_hash "${CMAKE_CURRENT_LIST_DIR}/content_hash.c")
+add_test_dbdconf(iter "${CMAKE_CURRENT_LIST_DIR}/iter.c")
+add_test_dbdconf(visit "${CMAKE_CURRENT_LIST_DIR}/visit.c")
+add_test_dbdconf(sorted_output "${CMAKE_CURRENT_LIST_DIR}/sorted_output.c")
+add_test_dbdconf(dedup "${CMAKE_CURRENT_LIST_DIR}/dedup.c")
+add_test_dbdconf(tree_builder "${CMAKE_CURRENT_LIST_DIR}/tree_builder.c")
+add_test_dbdconf(transaction "${CMAKE_CURRENT_LIST_DIR}/transaction.c")
+add_test_dbdconf(snapshot "${CMAKE_CURRENT_LIST_DIR}/snapshot.c")
+add_test_dbdconf(overlay "${CMAKE_CURRENT_LIST_DIR}/overlay.c")
+add_test_dbdconf(item_variant "${CMAKE_CURRENT_LIST_DIR}/item_variant.c")
+add_test_dbdconf(async "${CMAKE_CURRENT_LIST_DIR}/async.c")
+add_test_dbdconf(load_flags "${CMAKE_CURRENT_LIST_DIR}/load_flags.c")
+add_test_dbdconf(file_list "${CMAKE_CURRENT_LIST_DIR}/file_list.c")
+add_test_dbdconf(record "${CMAKE_CURRENT_LIST_DIR}/record.c")
+add_test_dbdconf(variant_print "${CMAKE_CURRENT_LIST_DIR}/variant_print.c")
+add_test_dbdconf(locality "${CMAKE_CURRENT_LIST_DIR}/locality.c")
+add_test_dbdconf(byteswap "${CMAKE_CURRENT_LIST_DIR}/byteswap.c")
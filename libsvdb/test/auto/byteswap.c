@@ -0,0 +1,91 @@
+#include <svdb.h>
+
+#define READERS 4
+
+gpointer dump_table(gpointer data) {
+    return svdb_item_dump(data, "/", FALSE);
+}
+
+void check_written(SvdbTableItem *expected, SvdbTableItem *table, gboolean byteswap) {
+    GError *error = NULL;
+    SvdbTableItem *copy;
+    GBytes *bytes;
+
+    bytes = svdb_table_get_raw(table, byteswap, &error);
+    g_assert_no_error(error);
+    copy = svdb_table_read_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(expected, copy));
+
+    svdb_item_unref(copy);
+    g_bytes_unref(bytes);
+}
+
+void check_byteswap(const gchar *native_path, const gchar *swapped_path) {
+    GError *error = NULL;
+    SvdbTableItem *native, *swapped;
+    GThread *readers[READERS];
+    GString *expected;
+
+    native = svdb_table_read_from_file(native_path, FALSE, &error);
+    g_assert_no_error(error);
+    swapped = svdb_table_read_from_file(swapped_path, FALSE, &error);
+    g_assert_no_error(error);
+
+    // Foreign values are swapped on first access, concurrent readers must get the same values.
+    expected = svdb_item_dump(native, "/", FALSE);
+    for (gint i = 0; i < READERS; ++i) {
+        readers[i] = g_thread_new("svdb-byteswap-reader", dump_table, swapped);
+    }
+    for (gint i = 0; i < READERS; ++i) {
+        GString *dump = g_thread_join(readers[i]);
+
+        g_assert_cmpstr(dump->str, ==, expected->str);
+        g_string_free(dump, TRUE);
+    }
+    g_string_free(expected, TRUE);
+
+    g_assert(svdb_item_equal(native, swapped));
+
+    // Both stored byte orders are written in both byte orders.
+    check_written(native, native, FALSE);
+    check_written(native, native, TRUE);
+    check_written(native, swapped, FALSE);
+    check_written(native, swapped, TRUE);
+
+    svdb_item_unref(swapped);
+    svdb_item_unref(native);
+}
+
+int main() {
+    const gchar *path;
+    gint checked = 0;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    for (gint i = 1;; ++i) {
+        gchar *native_path = g_strdup_printf("%stest_data%d.gvdb", path, i);
+        gchar *swapped_path = g_strdup_printf("%stest_data%d_byteswap.gvdb", path, i);
+        gboolean found = g_file_test(native_path, G_FILE_TEST_EXISTS) && g_file_test(swapped_path, G_FILE_TEST_EXISTS);
+
+        if (found) {
+            check_byteswap(native_path, swapped_path);
+            ++checked;
+        }
+
+        g_free(native_path);
+        g_free(swapped_path);
+        if (!found) {
+            break;
+        }
+    }
+
+    g_assert_cmpint(checked, >, 0);
+    return 0;
+}
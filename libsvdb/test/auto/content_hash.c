@@ -0,0 +1,79 @@
+#include <svdb.h>
+
+void check_content_hash(const gchar *filename) {
+    GError *error = NULL;
+    SvdbTableItem *table, *copy, *item, *original;
+    gchar *hash, *changed_hash;
+    GVariant *value;
+    GBytes *bytes;
+
+    table = svdb_table_read_from_file(filename, FALSE, &error);
+    g_assert_no_error(error);
+
+    // Same content, other order of hash table and byte order of values.
+    bytes = svdb_table_get_raw(table, TRUE, &error);
+    g_assert_no_error(error);
+    copy = svdb_table_read_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_bytes_unref(bytes);
+
+    hash = svdb_item_get_content_hash(table);
+    g_assert(svdb_item_equal(table, copy));
+
+    // Change of subtree changes hashes of all ancestors.
+    original = svdb_table_get(copy, "svdb-content-hash");
+    g_assert(!original);
+    item = svdb_item_new();
+    value = g_variant_ref_sink(g_variant_new_int32(42));
+    svdb_item_set_variant(item, value);
+    g_variant_unref(value);
+    svdb_table_set(copy, "svdb-content-hash", item, &error);
+    g_assert_no_error(error);
+    g_assert(!svdb_item_equal(table, copy));
+
+    changed_hash = svdb_item_get_content_hash(copy);
+    g_assert_cmpstr(hash, !=, changed_hash);
+    g_free(changed_hash);
+
+    value = g_variant_ref_sink(g_variant_new_int32(43));
+    svdb_item_set_variant(item, value);
+    g_variant_unref(value);
+    changed_hash = svdb_item_get_content_hash(copy);
+    g_assert_cmpstr(hash, !=, changed_hash);
+    g_free(changed_hash);
+    svdb_item_unref(item);
+
+    svdb_table_unset(copy, "svdb-content-hash");
+    changed_hash = svdb_item_get_content_hash(copy);
+    g_assert_cmpstr(hash, ==, changed_hash);
+    g_free(changed_hash);
+
+    g_free(hash);
+    svdb_item_unref(copy);
+    svdb_item_unref(table);
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        check_content_hash(file_full_path);
+        g_free(file_full_path);
+    }
+    g_dir_close(dir);
+}
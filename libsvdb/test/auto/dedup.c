@@ -0,0 +1,91 @@
+#include <svdb.h>
+
+void check_dedup(SvdbTableItem *table) {
+    GError *error = NULL;
+    SvdbWriteStats plain_stats, dedup_stats;
+    GBytes *plain, *dedup;
+    SvdbTableItem *copy;
+
+    plain = svdb_table_get_raw_full(table, FALSE, SVDB_WRITE_NONE, &plain_stats, &error);
+    g_assert_no_error(error);
+    dedup = svdb_table_get_raw_full(table, FALSE, SVDB_WRITE_DEDUP, &dedup_stats, &error);
+    g_assert_no_error(error);
+
+    g_assert_cmpuint(plain_stats.size, ==, g_bytes_get_size(plain));
+    g_assert_cmpuint(dedup_stats.size, ==, g_bytes_get_size(dedup));
+    g_assert_cmpuint(plain_stats.saved_bytes, ==, 0);
+    g_assert_cmpuint(plain_stats.n_unique_values, ==, plain_stats.n_values);
+    g_assert_cmpuint(dedup_stats.n_values, ==, plain_stats.n_values);
+    g_assert_cmpuint(dedup_stats.n_keys, ==, plain_stats.n_keys);
+    g_assert_cmpuint(dedup_stats.size, <=, plain_stats.size);
+
+    // Aliased pointers are valid GVDB with the same content.
+    g_assert(svdb_verify_bytes(dedup, &error));
+    g_assert_no_error(error);
+    copy = svdb_table_read_from_bytes(dedup, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(table, copy));
+
+    svdb_item_unref(copy);
+    g_bytes_unref(plain);
+    g_bytes_unref(dedup);
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+    SvdbTableItem *table;
+    SvdbWriteStats stats;
+    GBytes *bytes;
+
+    // Many equal values.
+    table = svdb_table_new();
+    for (gint i = 0; i < 64; ++i) {
+        gchar *key = g_strdup_printf("key%d", i);
+        SvdbTableItem *item = svdb_item_new();
+        GVariant *value = g_variant_ref_sink(g_variant_new_boolean(i % 2));
+
+        svdb_item_set_variant(item, value);
+        g_variant_unref(value);
+        svdb_table_set(table, key, item, &error);
+        g_assert_no_error(error);
+
+        svdb_item_unref(item);
+        g_free(key);
+    }
+
+    check_dedup(table);
+    bytes = svdb_table_get_raw_full(table, FALSE, SVDB_WRITE_DEDUP, &stats, &error);
+    g_assert_no_error(error);
+    g_assert_cmpuint(stats.n_values, ==, 64);
+    g_assert_cmpuint(stats.n_unique_values, ==, 2);
+    g_assert_cmpuint(stats.saved_bytes, >, 0);
+    g_bytes_unref(bytes);
+    svdb_item_unref(table);
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+
+        table = svdb_table_read_from_file(file_full_path, FALSE, &error);
+        g_assert_no_error(error);
+        check_dedup(table);
+
+        svdb_item_unref(table);
+        g_free(file_full_path);
+    }
+
+    g_dir_close(dir);
+}
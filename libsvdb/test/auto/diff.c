@@ -0,0 +1,189 @@
+#include <svdb.h>
+
+typedef struct {
+    gsize counts[4];
+    const gchar *changed_key;
+    const gchar *removed_key;
+} DiffResult;
+
+gboolean collect_diff(const gchar *key, SvdbDiffKind kind, GVariant *old_value, GVariant *new_value,
+                      gpointer user_data) {
+    DiffResult *result = user_data;
+
+    g_assert(kind != SVDB_DIFF_ADDED || (!old_value && new_value));
+    g_assert(kind != SVDB_DIFF_REMOVED || (old_value && !new_value));
+    g_assert(kind != SVDB_DIFF_CHANGED || (old_value && new_value && !g_variant_equal(old_value, new_value)));
+
+    if (kind == SVDB_DIFF_CHANGED && result->changed_key) {
+        g_assert_cmpstr(key, ==, result->changed_key);
+    }
+    if (kind == SVDB_DIFF_REMOVED && result->removed_key) {
+        g_assert_cmpstr(key, ==, result->removed_key);
+    }
+
+    ++result->counts[kind];
+    return TRUE;
+}
+
+gsize count_values(SvdbTableItem *item) {
+    gsize count = 0;
+
+    switch (svdb_item_get_type(item)) {
+        case SVDB_TYPE_VARIANT:
+            return 1;
+        case SVDB_TYPE_LIST: {
+            gsize length;
+            const SvdbListElement *list = svdb_item_get_list(item, &length);
+
+            for (gsize i = 0; i < length; ++i) {
+                count += count_values(list[i].item);
+            }
+            return count;
+        }
+        default:
+            return 0;
+    }
+}
+
+SvdbFile *table_to_file(SvdbTableItem *table, gboolean byteswap) {
+    GError *error = NULL;
+    GBytes *bytes = svdb_table_get_raw(table, byteswap, &error);
+    SvdbFile *file;
+
+    g_assert_no_error(error);
+    file = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_bytes_unref(bytes);
+    return file;
+}
+
+void check_diff(const gchar *filename) {
+    GError *error = NULL;
+    SvdbTableItem *table, *item;
+    GVariant *value;
+    SvdbFile *original, *swapped, *modified, *nested;
+    DiffResult result = {0};
+    const gchar *changed_key = NULL, *removed_key = NULL;
+    gsize total = 0, size;
+    GPtrArray *entries;
+    gchar **keys;
+
+    table = svdb_table_read_from_file(filename, FALSE, &error);
+    g_assert_no_error(error);
+    original = table_to_file(table, FALSE);
+    swapped = table_to_file(table, TRUE);
+
+    keys = svdb_table_list_child(table, &size, &error);
+    g_assert_no_error(error);
+    for (gsize i = 0; i < size; ++i) {
+        item = svdb_table_get(table, keys[i]);
+        total += count_values(item);
+        if (svdb_item_get_type(item) == SVDB_TYPE_VARIANT) {
+            if (!changed_key) {
+                changed_key = keys[i];
+            } else if (!removed_key) {
+                removed_key = keys[i];
+            }
+        }
+        svdb_item_unref(item);
+    }
+
+    // Empty files and same content.
+    g_assert(svdb_file_diff(NULL, original, collect_diff, &result, &error));
+    g_assert(svdb_file_diff(original, NULL, collect_diff, &result, &error));
+    g_assert(svdb_file_diff(original, swapped, collect_diff, &result, &error));
+    g_assert_no_error(error);
+    g_assert_cmpuint(result.counts[SVDB_DIFF_ADDED], ==, total);
+    g_assert_cmpuint(result.counts[SVDB_DIFF_REMOVED], ==, total);
+    g_assert_cmpuint(result.counts[SVDB_DIFF_CHANGED], ==, 0);
+
+    // One key of each kind.
+    item = svdb_item_new();
+    value = g_variant_ref_sink(g_variant_new_string("svdb-diff"));
+    svdb_item_set_variant(item, value);
+    g_variant_unref(value);
+    svdb_table_set(table, "svdb-diff-added", item, &error);
+    g_assert_no_error(error);
+    svdb_item_unref(item);
+
+    if (changed_key) {
+        item = svdb_item_new();
+        value = g_variant_ref_sink(g_variant_new_string("svdb-diff-changed"));
+        svdb_item_set_variant(item, value);
+        g_variant_unref(value);
+        svdb_table_set(table, changed_key, item, &error);
+        g_assert_no_error(error);
+        svdb_item_unref(item);
+    }
+    if (removed_key) {
+        svdb_table_unset(table, removed_key);
+    }
+
+    modified = table_to_file(table, FALSE);
+    memset(&result, 0, sizeof result);
+    result.changed_key = changed_key;
+    result.removed_key = removed_key;
+    g_assert(svdb_file_diff(swapped, modified, collect_diff, &result, &error));
+    g_assert_no_error(error);
+    g_assert_cmpuint(result.counts[SVDB_DIFF_ADDED], ==, 1);
+    g_assert_cmpuint(result.counts[SVDB_DIFF_REMOVED], ==, removed_key ? 1 : 0);
+    g_assert_cmpuint(result.counts[SVDB_DIFF_CHANGED], ==, changed_key ? 1 : 0);
+
+    // Sorted entries, unchanged dirs are skipped by digest.
+    entries = svdb_diff(original, modified, &error);
+    g_assert_no_error(error);
+    g_assert_cmpuint(entries->len, ==, 1 + (removed_key ? 1 : 0) + (changed_key ? 1 : 0));
+    for (guint i = 1; i < entries->len; ++i) {
+        const SvdbDiffEntry *previous = g_ptr_array_index(entries, i - 1);
+        const SvdbDiffEntry *entry = g_ptr_array_index(entries, i);
+        g_assert_cmpint(strcmp(previous->key, entry->key), <, 0);
+    }
+    g_ptr_array_unref(entries);
+
+    entries = svdb_diff(modified, modified, &error);
+    g_assert_no_error(error);
+    g_assert_cmpuint(entries->len, ==, 0);
+    g_ptr_array_unref(entries);
+
+    // Nested tables aren't walked, so they are reported as error instead of being skipped.
+    item = svdb_table_new();
+    svdb_table_set(table, "svdb-diff-nested", item, &error);
+    g_assert_no_error(error);
+    svdb_item_unref(item);
+    nested = table_to_file(table, FALSE);
+    g_assert(!svdb_file_diff(original, nested, collect_diff, &result, &error));
+    g_assert(error);
+    g_clear_error(&error);
+    svdb_file_unref(nested);
+
+    g_strfreev(keys);
+    svdb_file_unref(modified);
+    svdb_file_unref(swapped);
+    svdb_file_unref(original);
+    svdb_item_unref(table);
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        check_diff(file_full_path);
+        g_free(file_full_path);
+    }
+    g_dir_close(dir);
+}
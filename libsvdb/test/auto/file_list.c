@@ -0,0 +1,64 @@
+#include <svdb.h>
+
+SvdbFile *build(const gchar **paths) {
+    GError *error = NULL;
+    SvdbTreeBuilder *builder = svdb_tree_builder_new();
+    SvdbTableItem *table;
+    SvdbFile *file;
+    GBytes *bytes;
+
+    for (gint i = 0; paths[i]; ++i) {
+        g_assert(svdb_tree_builder_add(builder, paths[i], g_variant_new_string(paths[i]), &error));
+        g_assert_no_error(error);
+    }
+    table = svdb_tree_builder_finish(builder);
+
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    file = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+
+    g_bytes_unref(bytes);
+    svdb_item_unref(table);
+    return file;
+}
+
+void assert_list(SvdbFile *file, const gchar *dir, const gchar *expected) {
+    GError *error = NULL;
+    gchar **keys;
+    gchar *joined;
+    gsize length;
+
+    keys = svdb_file_list(file, dir, &length, &error);
+    g_assert_no_error(error);
+
+    if (!expected) {
+        g_assert(!keys);
+        g_assert_cmpuint(length, ==, 0);
+        return;
+    }
+
+    g_assert_cmpuint(length, ==, g_strv_length(keys));
+    joined = g_strjoinv(" ", keys);
+    g_assert_cmpstr(joined, ==, expected);
+
+    g_free(joined);
+    g_strfreev(keys);
+}
+
+int main() {
+    const gchar *paths[] = {"/org/gnome/b", "/org/gnome/a", "/org/kde/c", "/org/z", "/top", "/org/gnome/sub/d", NULL};
+    SvdbFile *file = build(paths);
+
+    assert_list(file, "/", "org/ top");
+    assert_list(file, "/org/", "gnome/ kde/ z");
+    assert_list(file, "/org/gnome/", "a b sub/");
+    assert_list(file, "/org/gnome/sub/", "d");
+
+    // Values and missing dirs aren't lists.
+    assert_list(file, "/org/z", NULL);
+    assert_list(file, "/missing/", NULL);
+    assert_list(file, "/org/gnome", NULL);
+
+    svdb_file_unref(file);
+}
@@ -0,0 +1,237 @@
+#include <svdb.h>
+
+// Collect all values reachable from root table by full names (parent keys + key).
+void collect_values(SvdbTableItem *item, const gchar *name, GHashTable *values, GHashTable *duplicates) {
+    switch (svdb_item_get_type(item)) {
+        case SVDB_TYPE_VARIANT:
+            if (g_hash_table_contains(values, name)) {
+                g_hash_table_add(duplicates, g_strdup(name));
+            } else {
+                g_hash_table_insert(values, g_strdup(name), svdb_item_ref(item));
+            }
+            break;
+        case SVDB_TYPE_LIST: {
+            gsize length;
+            const SvdbListElement *list = svdb_item_get_list(item, &length);
+
+            for (gsize i = 0; i < length; ++i) {
+                gchar *child_name = g_strconcat(name, list[i].key, NULL);
+                collect_values(list[i].item, child_name, values, duplicates);
+                g_free(child_name);
+            }
+            break;
+        }
+        default:
+            // Nested tables aren't reachable by root table lookup.
+            break;
+    }
+}
+
+void check_lookups(SvdbTableItem *table, GBytes *bytes) {
+    GError *error = NULL;
+    GHashTable *values = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) svdb_item_unref);
+    GHashTable *duplicates = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GHashTableIter iter;
+    const gchar *name;
+    SvdbTableItem *item;
+    SvdbFile *file;
+    gchar **keys;
+    gsize size;
+
+    keys = svdb_table_list_child(table, &size, &error);
+    g_assert_no_error(error);
+    for (gsize i = 0; i < size; ++i) {
+        item = svdb_table_get(table, keys[i]);
+        collect_values(item, keys[i], values, duplicates);
+        svdb_item_unref(item);
+    }
+    g_strfreev(keys);
+
+    file = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(file);
+
+    g_hash_table_iter_init(&iter, values);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &name, (gpointer *) &item)) {
+        GVariant *expected, *value, *variant;
+        GBytes *raw;
+
+        // Same full name in different subtrees can't be distinguished by lookup.
+        if (g_hash_table_contains(duplicates, name)) {
+            continue;
+        }
+
+        value = svdb_file_read(file, name, &error);
+        g_assert_no_error(error);
+        g_assert(value);
+
+        expected = svdb_item_get_variant(item);
+        g_assert(g_variant_equal(value, expected));
+        g_variant_unref(value);
+
+        // Raw bytes are serialized variant in host byte order.
+        raw = svdb_file_read_raw(file, name, &error);
+        g_assert_no_error(error);
+        g_assert(raw);
+        variant = g_variant_new_from_bytes(G_VARIANT_TYPE_VARIANT, raw, FALSE);
+        value = g_variant_get_variant(variant);
+        g_assert(g_variant_equal(value, expected));
+
+        g_variant_unref(value);
+        g_variant_unref(variant);
+        g_bytes_unref(raw);
+        g_variant_unref(expected);
+    }
+
+    g_assert(!svdb_file_read(file, "svdb-file-lookup-missing-key", &error));
+    g_assert_no_error(error);
+    g_assert(!svdb_file_read_raw(file, "svdb-file-lookup-missing-key", &error));
+    g_assert_no_error(error);
+
+    svdb_file_unref(file);
+    g_hash_table_unref(duplicates);
+    g_hash_table_unref(values);
+}
+
+guint32 legacy_hash(const gchar *key) {
+    guint32 hash = 5381;
+
+    for (; *key; ++key) {
+        hash = (hash * 33) + (signed char) *key;
+    }
+    return hash;
+}
+
+void append_words(GByteArray *array, const guint32 *words, guint count) {
+    for (guint i = 0; i < count; ++i) {
+        guint32 word = GUINT32_TO_LE(words[i]);
+        g_byte_array_append(array, (const guint8 *) &word, sizeof word);
+    }
+}
+
+void append_item(GByteArray *array, guint32 hash, guint32 parent, guint32 key_start, guint16 key_size, gchar type,
+                 guint32 value_start, guint32 value_end) {
+    guint32 words[3] = {hash, parent, key_start};
+    guint16 size = GUINT16_TO_LE(key_size);
+    guint8 type_bytes[2] = {type, 0};
+    guint32 value[2] = {value_start, value_end};
+
+    append_words(array, words, 3);
+    g_byte_array_append(array, (const guint8 *) &size, sizeof size);
+    g_byte_array_append(array, type_bytes, sizeof type_bytes);
+    append_words(array, value, 2);
+}
+
+// File of old svdb versions: hashes of own keys only ("dir" list with "key" value), must be looked up by full names.
+void check_legacy_hashes() {
+    GError *error = NULL;
+    GVariant *variant = g_variant_ref_sink(g_variant_new_variant(g_variant_new_int32(42)));
+    gsize variant_size = g_variant_get_size(variant);
+    GByteArray *array = g_byte_array_new();
+    guint32 header[6] = {1918981703, 1953390953, 0, 0, 24, 84};
+    guint32 table[3] = {0, 1, 0};
+    guint32 list[1] = {1};
+    SvdbFile *file, *written;
+    SvdbTableItem *item;
+    GVariant *value;
+    GPtrArray *entries;
+    GBytes *bytes;
+    gchar **keys;
+
+    append_words(array, header, 6);
+    append_words(array, table, 3);
+    append_item(array, legacy_hash("dir"), (guint32) -1, 84, 3, 'L', 92, 96);
+    append_item(array, legacy_hash("key"), 0, 87, 3, 'v', 96, 96 + variant_size);
+    g_byte_array_append(array, (const guint8 *) "dirkey\0\0", 8);
+    append_words(array, list, 1);
+    g_byte_array_append(array, g_variant_get_data(variant), variant_size);
+    bytes = g_byte_array_free_to_bytes(array);
+    g_variant_unref(variant);
+
+    file = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+
+    value = svdb_file_read(file, "dirkey", &error);
+    g_assert_no_error(error);
+    g_assert(value);
+    g_assert_cmpint(g_variant_get_int32(value), ==, 42);
+    g_variant_unref(value);
+
+    keys = svdb_file_list(file, "dir", NULL, &error);
+    g_assert_no_error(error);
+    g_assert(keys && g_strv_length(keys) == 1);
+    g_assert_cmpstr(keys[0], ==, "key");
+    g_strfreev(keys);
+
+    // Rewritten file has full name hashes, and same content.
+    item = svdb_table_read_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_bytes_unref(bytes);
+    bytes = svdb_table_get_raw(item, FALSE, &error);
+    g_assert_no_error(error);
+    written = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+
+    value = svdb_file_read(written, "dirkey", &error);
+    g_assert_no_error(error);
+    g_assert(value);
+    g_variant_unref(value);
+
+    entries = svdb_diff(file, written, &error);
+    g_assert_no_error(error);
+    g_assert_cmpuint(entries->len, ==, 0);
+    g_ptr_array_unref(entries);
+
+    svdb_file_unref(written);
+    svdb_file_unref(file);
+    svdb_item_unref(item);
+    g_bytes_unref(bytes);
+}
+
+int main() {
+    GDir *dir;
+    SvdbTableItem *table;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+    GMappedFile *mapped;
+    GBytes *bytes;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        filename = g_strdup_printf("%s/%s", path, filename);
+        mapped = g_mapped_file_new(filename, FALSE, &error);
+        g_assert_no_error(error);
+        bytes = g_mapped_file_get_bytes(mapped);
+        g_mapped_file_unref(mapped);
+
+        table = svdb_table_read_from_bytes(bytes, FALSE, &error);
+        g_assert_no_error(error);
+        check_lookups(table, bytes);
+        g_bytes_unref(bytes);
+
+        // Written files must be looked up the same way, in both byte orders.
+        for (int byteswap = 0; byteswap < 2; ++byteswap) {
+            bytes = svdb_table_get_raw(table, byteswap, &error);
+            g_assert_no_error(error);
+            check_lookups(table, bytes);
+            g_bytes_unref(bytes);
+        }
+
+        svdb_item_unref(table);
+        g_free((gpointer) filename);
+    }
+    g_dir_close(dir);
+
+    check_legacy_hashes();
+}
@@ -0,0 +1,142 @@
+#include <svdb.h>
+
+typedef struct {
+    SvdbFindMode mode;
+    const gchar *pattern;
+    const GVariantType *type;
+} FindQuery;
+
+// Check query against key and value the same way as find should do it.
+gboolean query_match(const FindQuery *query, const gchar *key, GVariant *value) {
+    gboolean matched = FALSE;
+
+    switch (query->mode) {
+        case SVDB_FIND_PREFIX:
+            matched = g_str_has_prefix(key, query->pattern);
+            break;
+        case SVDB_FIND_GLOB:
+            matched = g_pattern_match_simple(query->pattern, key);
+            break;
+        case SVDB_FIND_REGEX:
+            matched = g_regex_match_simple(query->pattern, key, 0, 0);
+            break;
+    }
+
+    return matched && (!query->type || g_variant_is_of_type(value, query->type));
+}
+
+// Count values in parsed tree, which match query.
+gsize count_matches(const FindQuery *query, SvdbTableItem *item, const gchar *name) {
+    gsize count = 0;
+
+    switch (svdb_item_get_type(item)) {
+        case SVDB_TYPE_VARIANT: {
+            GVariant *value = svdb_item_get_variant(item);
+            count = query_match(query, name, value) ? 1 : 0;
+            g_variant_unref(value);
+            break;
+        }
+        case SVDB_TYPE_LIST: {
+            gsize length;
+            const SvdbListElement *list = svdb_item_get_list(item, &length);
+
+            for (gsize i = 0; i < length; ++i) {
+                gchar *child_name = g_strconcat(name, list[i].key, NULL);
+                count += count_matches(query, list[i].item, child_name);
+                g_free(child_name);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return count;
+}
+
+gboolean count_found(const gchar *key, GVariant *value, gpointer user_data) {
+    const FindQuery *query = ((gpointer *) user_data)[0];
+    gsize *count = ((gpointer *) user_data)[1];
+
+    g_assert(query_match(query, key, value));
+    ++*count;
+    return TRUE;
+}
+
+void check_queries(const gchar *filename) {
+    const FindQuery queries[] = {
+        {SVDB_FIND_PREFIX, "", NULL},
+        {SVDB_FIND_PREFIX, "l1", NULL},
+        {SVDB_FIND_GLOB, "*", NULL},
+        {SVDB_FIND_GLOB, "*1*", NULL},
+        {SVDB_FIND_GLOB, "l?_*", NULL},
+        {SVDB_FIND_REGEX, "1$", NULL},
+        {SVDB_FIND_REGEX, "^l[0-9]_list", NULL},
+        {SVDB_FIND_REGEX, "_1[01]", NULL},
+        {SVDB_FIND_REGEX, "lock", NULL},
+        {SVDB_FIND_GLOB, "*", G_VARIANT_TYPE_STRING},
+    };
+    GError *error = NULL;
+    SvdbTableItem *table;
+    SvdbFile *file;
+    gchar **keys;
+    gsize size;
+
+    table = svdb_table_read_from_file(filename, FALSE, &error);
+    g_assert_no_error(error);
+    file = svdb_file_new(filename, FALSE, &error);
+    g_assert_no_error(error);
+
+    keys = svdb_table_list_child(table, &size, &error);
+    g_assert_no_error(error);
+
+    for (gsize q = 0; q < G_N_ELEMENTS(queries); ++q) {
+        gsize expected = 0;
+        gsize found = 0;
+        gpointer data[] = {(gpointer) &queries[q], &found};
+
+        for (gsize i = 0; i < size; ++i) {
+            SvdbTableItem *item = svdb_table_get(table, keys[i]);
+            expected += count_matches(&queries[q], item, keys[i]);
+            svdb_item_unref(item);
+        }
+
+        g_assert(svdb_file_find(file, queries[q].pattern, queries[q].mode, queries[q].type, NULL, count_found,
+                                data, &error));
+        g_assert_no_error(error);
+        g_assert_cmpuint(found, ==, expected);
+    }
+
+    g_assert(!svdb_file_find(file, "(", SVDB_FIND_REGEX, NULL, NULL, count_found, NULL, &error));
+    g_assert(error);
+    g_clear_error(&error);
+
+    g_strfreev(keys);
+    svdb_file_unref(file);
+    svdb_item_unref(table);
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        check_queries(file_full_path);
+        g_free(file_full_path);
+    }
+    g_dir_close(dir);
+}
@@ -0,0 +1,105 @@
+#include <svdb.h>
+
+void check_round_trip(const gchar *filename) {
+    GError *error = NULL;
+    SvdbTableItem *table, *copy;
+    GVariant *variant, *copy_variant;
+    GBytes *bytes, *copy_bytes;
+
+    table = svdb_table_read_from_file(filename, FALSE, &error);
+    g_assert_no_error(error);
+
+    variant = svdb_item_to_variant(table);
+    g_assert(g_variant_is_of_type(variant, G_VARIANT_TYPE("a{sv}")));
+    copy = svdb_item_from_variant(variant, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(table, copy));
+
+    // Child counters are computed right, so written files are equal too.
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    copy_bytes = svdb_table_get_raw(copy, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(bytes, copy_bytes));
+
+    copy_variant = svdb_item_to_variant(copy);
+    g_assert(g_variant_equal(variant, copy_variant));
+
+    g_variant_unref(copy_variant);
+    g_variant_unref(variant);
+    g_bytes_unref(copy_bytes);
+    g_bytes_unref(bytes);
+    svdb_item_unref(copy);
+    svdb_item_unref(table);
+}
+
+void check_format(void) {
+    GError *error = NULL;
+    SvdbTableItem *item, *child;
+    GVariant *variant, *node, *value;
+
+    item = svdb_item_new();
+    g_assert(!svdb_item_to_variant(item));
+    value = g_variant_ref_sink(g_variant_new_int32(1));
+    svdb_item_set_variant(item, value);
+    g_variant_unref(value);
+    variant = svdb_item_to_variant(item);
+    g_assert(g_variant_is_of_type(variant, G_VARIANT_TYPE_VARIANT));
+    g_variant_unref(variant);
+    svdb_item_unref(item);
+
+    // List keeps its order.
+    item = svdb_item_from_variant(g_variant_new_parsed("[('b', <<1>>), ('a', <[('c', <<2>>)]>)]"), &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(svdb_item_get_type(item), ==, SVDB_TYPE_LIST);
+    g_assert_cmpstr(svdb_item_get_list(item, NULL)[0].key, ==, "b");
+
+    child = svdb_item_list_get_element(item, "a");
+    g_assert_cmpint(svdb_item_get_type(child), ==, SVDB_TYPE_LIST);
+    svdb_item_unref(child);
+
+    variant = svdb_item_to_variant(item);
+    g_assert(g_variant_is_of_type(variant, G_VARIANT_TYPE("a(sv)")));
+    g_variant_get_child(variant, 0, "(&sv)", NULL, &node);
+    g_assert(g_variant_is_of_type(node, G_VARIANT_TYPE_VARIANT));
+    g_variant_get(node, "v", &value);
+    g_assert_cmpint(g_variant_get_int32(value), ==, 1);
+    g_variant_unref(value);
+    g_variant_unref(node);
+    g_variant_unref(variant);
+    svdb_item_unref(item);
+
+    g_assert(!svdb_item_from_variant(g_variant_new_int32(0), &error));
+    g_clear_error(&error);
+    g_assert(!svdb_item_from_variant(g_variant_new_parsed("[('a', <<1>>), ('a', <<2>>)]"), &error));
+    g_clear_error(&error);
+    g_assert(!svdb_item_from_variant(g_variant_new_parsed("{'a': <[('b', <0>)]>}"), &error));
+    g_clear_error(&error);
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+
+    check_format();
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        check_round_trip(file_full_path);
+        g_free(file_full_path);
+    }
+    g_dir_close(dir);
+}
@@ -0,0 +1,70 @@
+#include <svdb.h>
+
+gboolean stop_after_first(const gchar *key, SvdbTableItem *value, gpointer user_data) {
+    return FALSE;
+}
+
+void check_iter(const SvdbTableItem *item) {
+    const SvdbListElement *list;
+    const gchar *key;
+    SvdbTableItem *value;
+    SvdbIter iter;
+    gsize count = 0;
+    gsize length;
+
+    svdb_iter_init(&iter, item);
+    list = svdb_item_get_list(item, &length);
+
+    while (svdb_iter_next(&iter, &key, &value)) {
+        g_assert(key);
+        g_assert(value);
+        // Lists are iterated in their order.
+        if (list) {
+            g_assert(key == list[count].key);
+            g_assert(value == list[count].item);
+        }
+        ++count;
+        check_iter(value);
+    }
+
+    g_assert(!svdb_iter_next(&iter, &key, &value));
+    g_assert_cmpuint(count, ==, svdb_item_get_length(item));
+    g_assert_cmpuint(svdb_item_foreach(item, stop_after_first, NULL), ==, count ? 1 : 0);
+}
+
+int main() {
+    GDir *dir;
+    SvdbTableItem *table;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+    gchar **keys;
+    gsize size;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        filename = g_strdup_printf("%s/%s", path, filename);
+        table = svdb_table_read_from_file(filename, FALSE, &error);
+        g_assert_no_error(error);
+
+        check_iter(table);
+        keys = svdb_table_list_child(table, &size, &error);
+        g_assert_no_error(error);
+        g_assert_cmpuint(size, ==, svdb_item_get_length(table));
+        g_strfreev(keys);
+
+        svdb_item_unref(table);
+        g_free((gpointer) filename);
+    }
+    g_dir_close(dir);
+}
@@ -0,0 +1,120 @@
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <svdb.h>
+
+const SvdbLoadFlags all_flags[] = {
+    SVDB_LOAD_NONE,
+    SVDB_LOAD_SEQUENTIAL,
+    SVDB_LOAD_RANDOM,
+    SVDB_LOAD_POPULATE,
+    SVDB_LOAD_SEQUENTIAL | SVDB_LOAD_POPULATE,
+    SVDB_LOAD_RANDOM | SVDB_LOAD_POPULATE,
+};
+
+SvdbVisitResult count_values(SvdbVisitEvent event, const gchar *name, const gchar *key, SvdbFileValue *value,
+                             gpointer user_data) {
+    if (event == SVDB_VISIT_VALUE) {
+        ++*(guint *) user_data;
+    }
+    return SVDB_VISIT_CONTINUE;
+}
+
+// Hints don't change content: every flags combination gives the same table and lookups.
+void check_file(const gchar *filename) {
+    GError *error = NULL;
+    SvdbTableItem *expected, *table;
+    SvdbFile *file;
+    GBytes *bytes;
+    gchar *contents;
+    gsize length;
+    guint expected_count = 0;
+
+    g_file_get_contents(filename, &contents, &length, &error);
+    g_assert_no_error(error);
+    bytes = g_bytes_new_take(contents, length);
+
+    expected = svdb_table_read_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+
+    file = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_file_visit(file, count_values, &expected_count, &error));
+    g_assert_no_error(error);
+    svdb_file_unref(file);
+
+    for (gsize i = 0; i < G_N_ELEMENTS(all_flags); ++i) {
+        guint count = 0;
+
+        table = svdb_table_read_from_file_full(filename, FALSE, all_flags[i], &error);
+        g_assert_no_error(error);
+        g_assert(svdb_item_equal(table, expected));
+        svdb_item_unref(table);
+
+        file = svdb_file_new_full(filename, FALSE, all_flags[i], &error);
+        g_assert_no_error(error);
+        g_assert(svdb_file_visit(file, count_values, &count, &error));
+        g_assert_no_error(error);
+        g_assert_cmpuint(count, ==, expected_count);
+        svdb_file_unref(file);
+    }
+
+    svdb_item_unref(expected);
+    g_bytes_unref(bytes);
+}
+
+void check_errors(void) {
+    GError *error = NULL;
+    gchar *empty_filename;
+    gint fd;
+
+    g_assert(!svdb_table_read_from_file_full("svdb-load-flags-missing.gvdb", FALSE, SVDB_LOAD_POPULATE, &error));
+    g_assert_error(error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_clear_error(&error);
+
+    g_assert(!svdb_file_new_full("svdb-load-flags-missing.gvdb", FALSE, SVDB_LOAD_RANDOM, &error));
+    g_assert_error(error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_clear_error(&error);
+
+    // Empty file can't be mapped, it's reported as corrupted.
+    fd = g_file_open_tmp("svdb-load-flags-XXXXXX", &empty_filename, &error);
+    g_assert_no_error(error);
+    close(fd);
+
+    g_assert(!svdb_table_read_from_file_full(empty_filename, FALSE, SVDB_LOAD_SEQUENTIAL, &error));
+    g_assert(error);
+    g_clear_error(&error);
+
+    g_assert(!svdb_file_new_full(empty_filename, FALSE, SVDB_LOAD_RANDOM | SVDB_LOAD_POPULATE, &error));
+    g_assert(error);
+    g_clear_error(&error);
+
+    g_remove(empty_filename);
+    g_free(empty_filename);
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+
+    check_errors();
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        check_file(file_full_path);
+        g_free(file_full_path);
+    }
+    g_dir_close(dir);
+}
@@ -0,0 +1,165 @@
+#include <svdb.h>
+
+// Offset of value of key in file (raw value is slice of file bytes).
+gsize value_offset(GBytes *bytes, const gchar *key) {
+    GError *error = NULL;
+    SvdbFile *file;
+    GBytes *raw;
+    gsize offset;
+
+    file = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    raw = svdb_file_read_raw(file, key, &error);
+    g_assert_no_error(error);
+    g_assert(raw);
+
+    offset = (const guint8 *) g_bytes_get_data(raw, NULL) - (const guint8 *) g_bytes_get_data(bytes, NULL);
+
+    g_bytes_unref(raw);
+    svdb_file_unref(file);
+    return offset;
+}
+
+void check_content(SvdbTableItem *table, GBytes *bytes) {
+    GError *error = NULL;
+    SvdbTableItem *copy;
+
+    g_assert(svdb_verify_bytes(bytes, &error));
+    g_assert_no_error(error);
+    copy = svdb_table_read_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(table, copy));
+    svdb_item_unref(copy);
+}
+
+// Start of nested table: value of 'H' item of root hash table (see GVDB format).
+guint32 nested_table_start(GBytes *bytes) {
+    const guint32 *words = g_bytes_get_data(bytes, NULL);
+    const guint8 *data = (const guint8 *) words;
+    // Header: signature (2 words), version, options, root pointer.
+    guint32 root = GUINT32_FROM_LE(words[4]);
+    guint32 n_bloom_words = GUINT32_FROM_LE(words[root / 4]) & ((1 << 27) - 1);
+    guint32 n_buckets = GUINT32_FROM_LE(words[root / 4 + 1]);
+    const guint8 *items = data + root + 8 + (n_bloom_words + n_buckets) * 4;
+    // Items are 24 bytes: hash, parent, key start, key size (2 bytes), type, unused, value pointer.
+    guint32 n_items = (GUINT32_FROM_LE(words[5]) - root - 8 - (n_bloom_words + n_buckets) * 4) / 24;
+
+    for (guint32 i = 0; i < n_items; ++i) {
+        if (items[i * 24 + 14] == 'H') {
+            return GUINT32_FROM_LE(*(const guint32 *) (items + i * 24 + 16));
+        }
+    }
+
+    g_assert_not_reached();
+    return 0;
+}
+
+SvdbTableItem *build_tree(void) {
+    GError *error = NULL;
+    SvdbTreeBuilder *builder = svdb_tree_builder_new();
+    gchar *big = g_strnfill(2000, 'x');
+
+    for (gint i = 0; i < 20; ++i) {
+        for (gint j = 0; j < 10; ++j) {
+            gchar *path = g_strdup_printf("/org/app%02d/k%d", i, j);
+
+            g_assert(svdb_tree_builder_add(builder, path, g_variant_new_int32(i * 10 + j), &error));
+            g_assert_no_error(error);
+            g_free(path);
+        }
+        gchar *path = g_strdup_printf("/org/app%02d/sub/x", i);
+
+        g_assert(svdb_tree_builder_add(builder, path, g_variant_new_int32(-i), &error));
+        g_assert_no_error(error);
+        g_free(path);
+    }
+
+    g_assert(svdb_tree_builder_add(builder, "/org/big", g_variant_new_take_string(big), &error));
+    g_assert_no_error(error);
+    return svdb_tree_builder_finish(builder);
+}
+
+SvdbTableItem *build_nested(void) {
+    GError *error = NULL;
+    SvdbTableItem *table = svdb_table_new();
+    SvdbTableItem *nested = svdb_table_new();
+
+    for (gint i = 0; i < 200; ++i) {
+        gchar *key = g_strdup_printf("key%d", i);
+        SvdbTableItem *item = svdb_item_new();
+        GVariant *value = g_variant_ref_sink(g_variant_new_uint32(i));
+
+        svdb_item_set_variant(item, value);
+        g_variant_unref(value);
+        g_assert(svdb_table_set(i % 2 ? table : nested, key, item, &error));
+        g_assert_no_error(error);
+
+        svdb_item_unref(item);
+        g_free(key);
+    }
+
+    g_assert(svdb_table_set(table, "nested", nested, &error));
+    g_assert_no_error(error);
+    svdb_item_unref(nested);
+    return table;
+}
+
+int main() {
+    const gchar *profile[] = {"/org/app17/k3", NULL};
+    GError *error = NULL;
+    SvdbTableItem *table;
+    SvdbWriteStats stats, local_stats;
+    GBytes *plain, *local, *again, *profiled;
+
+    table = build_tree();
+
+    plain = svdb_table_get_raw_full(table, FALSE, SVDB_WRITE_DEDUP, &stats, &error);
+    g_assert_no_error(error);
+    local = svdb_table_get_raw_full(table, FALSE, SVDB_WRITE_DEDUP | SVDB_WRITE_LOCALITY, &local_stats, &error);
+    g_assert_no_error(error);
+    profiled = svdb_table_get_raw_profiled(table, FALSE, SVDB_WRITE_DEDUP, profile, NULL, &error);
+    g_assert_no_error(error);
+
+    check_content(table, plain);
+    check_content(table, local);
+    check_content(table, profiled);
+
+    // Layout only moves chunks.
+    g_assert_cmpuint(local_stats.n_values, ==, stats.n_values);
+    g_assert_cmpuint(local_stats.n_unique_keys, ==, stats.n_unique_keys);
+
+    // Output is deterministic.
+    again = svdb_table_get_raw_full(table, FALSE, SVDB_WRITE_DEDUP | SVDB_WRITE_LOCALITY, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(local, again));
+    g_bytes_unref(again);
+
+    // Depth-first: subtree of first dir is written before next dirs. Breadth-first: all keys of level are written
+    // before next level.
+    g_assert_cmpuint(value_offset(plain, "/org/app00/sub/x"), <, value_offset(plain, "/org/app19/k0"));
+    g_assert_cmpuint(value_offset(local, "/org/app00/sub/x"), >, value_offset(local, "/org/app19/k0"));
+
+    // Keys of dir are next to each other, large values are written after all small ones.
+    g_assert_cmpuint(value_offset(local, "/org/app05/k9") - value_offset(local, "/org/app05/k0"), <, 4096);
+    g_assert_cmpuint(value_offset(local, "/org/big"), >, value_offset(local, "/org/app19/sub/x"));
+
+    // Dirs of profile (and their parents) go first.
+    g_assert_cmpuint(value_offset(profiled, "/org/app17/k0"), <, value_offset(profiled, "/org/app00/k0"));
+    g_assert_cmpuint(value_offset(profiled, "/org/app00/k0"), <, value_offset(profiled, "/org/app01/k0"));
+
+    g_bytes_unref(plain);
+    g_bytes_unref(local);
+    g_bytes_unref(profiled);
+    svdb_item_unref(table);
+
+    // Large nested table starts on page boundary.
+    table = build_nested();
+    local = svdb_table_get_raw_full(table, FALSE, SVDB_WRITE_LOCALITY, NULL, &error);
+    g_assert_no_error(error);
+    check_content(table, local);
+    g_assert_cmpuint(nested_table_start(local) % 4096, ==, 0);
+
+    g_bytes_unref(local);
+    svdb_item_unref(table);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <svdb.h>
+
+SvdbTableItem *build(const gchar **paths) {
+    GError *error = NULL;
+    SvdbTreeBuilder *builder = svdb_tree_builder_new();
+
+    for (gint i = 0; paths[i]; ++i) {
+        g_assert(svdb_tree_builder_add(builder, paths[i], g_variant_new_string(paths[i]), &error));
+        g_assert_no_error(error);
+    }
+    return svdb_tree_builder_finish(builder);
+}
+
+/// @brief Overlay output must be the same, as writer of whole tree gives.
+void assert_same_bytes(SvdbOverlay *overlay, SvdbTableItem *expected, gboolean byteswap) {
+    GError *error = NULL;
+    GBytes *bytes, *expected_bytes;
+
+    bytes = svdb_overlay_get_raw(overlay, byteswap, SVDB_WRITE_DEDUP, NULL, &error);
+    g_assert_no_error(error);
+    expected_bytes = svdb_table_get_raw(expected, byteswap, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(bytes, expected_bytes));
+
+    g_bytes_unref(bytes);
+    g_bytes_unref(expected_bytes);
+}
+
+void assert_read(SvdbOverlay *overlay, const gchar *path, const gchar *expected) {
+    GError *error = NULL;
+    GVariant *value = svdb_overlay_read(overlay, path, &error);
+
+    g_assert_no_error(error);
+    if (!expected) {
+        g_assert(!value);
+        return;
+    }
+    g_assert(value);
+    g_assert_cmpstr(g_variant_get_string(value, NULL), ==, expected);
+    g_variant_unref(value);
+}
+
+int main() {
+    const gchar *initial[] = {"/a/k1", "/a/k2", "/a/b/k3", "/c/k4", "/k5", NULL};
+    const gchar *changed[] = {"/a/k1", "/a/b/k3", "/c/k4", "/c/d/k6", "/k5", "/k7", NULL};
+    GError *error = NULL;
+    SvdbTableItem *table, *expected;
+    SvdbOverlay *overlay;
+    SvdbFile *base;
+    GBytes *bytes;
+
+    table = build(initial);
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    base = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+
+    // Unchanged overlay gives the same file.
+    overlay = svdb_overlay_new(base);
+    assert_same_bytes(overlay, table, FALSE);
+    assert_same_bytes(overlay, table, TRUE);
+
+    g_assert(!svdb_overlay_set(overlay, "a/k", g_variant_new_int32(0), &error));
+    g_clear_error(&error);
+    g_assert(!svdb_overlay_unset(overlay, "/a/", &error));
+    g_clear_error(&error);
+
+    g_assert(svdb_overlay_set(overlay, "/a/k1", g_variant_new_int32(0), &error));
+    g_assert(svdb_overlay_set(overlay, "/a/k1", g_variant_new_string("/a/k1"), &error));
+    g_assert(svdb_overlay_unset(overlay, "/a/k2", &error));
+    g_assert(svdb_overlay_unset(overlay, "/missing/k", &error));
+    g_assert(svdb_overlay_set(overlay, "/c/d/k6", g_variant_new_string("/c/d/k6"), &error));
+    g_assert(svdb_overlay_set(overlay, "/k7", g_variant_new_int32(0), &error));
+    g_assert(svdb_overlay_unset(overlay, "/k7", &error));
+    g_assert(svdb_overlay_set(overlay, "/k7", g_variant_new_string("/k7"), &error));
+    g_assert_no_error(error);
+
+    assert_read(overlay, "/a/k1", "/a/k1");
+    assert_read(overlay, "/a/k2", NULL);
+    assert_read(overlay, "/a/b/k3", "/a/b/k3");
+    assert_read(overlay, "/c/d/k6", "/c/d/k6");
+    assert_read(overlay, "/missing/k", NULL);
+
+    expected = build(changed);
+    assert_same_bytes(overlay, expected, FALSE);
+    assert_same_bytes(overlay, expected, TRUE);
+    svdb_overlay_free(overlay);
+
+    // Overlay without base file.
+    overlay = svdb_overlay_new(NULL);
+    for (gint i = 0; changed[i]; ++i) {
+        g_assert(svdb_overlay_set(overlay, changed[i], g_variant_new_string(changed[i]), &error));
+        g_assert_no_error(error);
+    }
+    assert_same_bytes(overlay, expected, FALSE);
+    svdb_overlay_free(overlay);
+
+    svdb_item_unref(expected);
+    svdb_file_unref(base);
+    g_bytes_unref(bytes);
+    svdb_item_unref(table);
+}
@@ -0,0 +1,46 @@
+#include <svdb.h>
+
+void assert_record(SvdbRecordFormat format, const gchar *path, GVariant *value, const gchar *expected, gsize length) {
+    GString *buffer = g_string_new("prefix");
+
+    if (value) {
+        g_variant_ref_sink(value);
+    }
+    svdb_record_append(buffer, format, path, value);
+
+    // Records are appended, buffer content is kept.
+    g_assert(g_str_has_prefix(buffer->str, "prefix"));
+    g_assert_cmpuint(buffer->len - strlen("prefix"), ==, length);
+    g_assert(memcmp(buffer->str + strlen("prefix"), expected, length) == 0);
+
+    g_string_free(buffer, TRUE);
+    if (value) {
+        g_variant_unref(value);
+    }
+}
+
+#define ASSERT_RECORD(format, path, value, expected) \
+    assert_record(format, path, value, expected, sizeof(expected) - 1)
+
+int main() {
+    ASSERT_RECORD(SVDB_RECORD_GVARIANT_TEXT, "/org/a", g_variant_new_int32(5), "/org/a\ti\t5\n");
+    ASSERT_RECORD(SVDB_RECORD_GVARIANT_TEXT, "/org/s", g_variant_new_string("x"), "/org/s\ts\t'x'\n");
+    ASSERT_RECORD(SVDB_RECORD_GVARIANT_TEXT, "/org/dir/", NULL, "/org/dir/\t\t\n");
+
+    ASSERT_RECORD(SVDB_RECORD_NUL, "/org/a", g_variant_new_boolean(TRUE), "/org/a\0b\0true\0");
+    ASSERT_RECORD(SVDB_RECORD_NUL, "/org/dir/", NULL, "/org/dir/\0\0\0");
+
+    ASSERT_RECORD(SVDB_RECORD_JSONL, "/org/a", g_variant_new_uint32(7),
+                  "{\"path\":\"/org/a\",\"type\":\"u\",\"value\":\"7\"}\n");
+    ASSERT_RECORD(SVDB_RECORD_JSONL, "/org/dir/", NULL,
+                  "{\"path\":\"/org/dir/\",\"type\":null,\"value\":null}\n");
+
+    // Quotes, backslashes and control chars (GVariant text keeps non-printable chars escaped itself) are escaped.
+    ASSERT_RECORD(SVDB_RECORD_JSONL, "/org/\"q\"", g_variant_new_string("a\"b\\"),
+                  "{\"path\":\"/org/\\\"q\\\"\",\"type\":\"s\",\"value\":\"'a\\\"b\\\\\\\\'\"}\n");
+    ASSERT_RECORD(SVDB_RECORD_JSONL, "/org/\n\x01", NULL,
+                  "{\"path\":\"/org/\\n\\u0001\",\"type\":null,\"value\":null}\n");
+    ASSERT_RECORD(SVDB_RECORD_JSONL, "/org/as", g_variant_new_strv((const gchar *[]) {"x", "y"}, 2),
+                  "{\"path\":\"/org/as\",\"type\":\"as\",\"value\":\"['x', 'y']\"}\n");
+    return 0;
+}
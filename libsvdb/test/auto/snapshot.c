@@ -0,0 +1,99 @@
+#include <svdb.h>
+
+SvdbTableItem *build(const gchar **paths) {
+    GError *error = NULL;
+    SvdbTreeBuilder *builder = svdb_tree_builder_new();
+
+    for (gint i = 0; paths[i]; ++i) {
+        g_assert(svdb_tree_builder_add(builder, paths[i], g_variant_new_string(paths[i]), &error));
+        g_assert_no_error(error);
+    }
+    return svdb_tree_builder_finish(builder);
+}
+
+void assert_same_bytes(SvdbTableItem *table, SvdbTableItem *expected) {
+    GError *error = NULL;
+    GBytes *bytes, *expected_bytes;
+
+    // Writer uses child counters, so equal bytes mean that counters are right too.
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    expected_bytes = svdb_table_get_raw(expected, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(bytes, expected_bytes));
+
+    g_bytes_unref(bytes);
+    g_bytes_unref(expected_bytes);
+}
+
+SvdbTableItem *get_dir(SvdbTableItem *table, const gchar *dir) {
+    SvdbTableItem *root = svdb_table_get(table, "/");
+    SvdbTableItem *list = svdb_item_list_get_element(root, dir);
+
+    svdb_item_unref(root);
+    return list;
+}
+
+int main() {
+    const gchar *initial[] = {"/a/k1", "/a/b/k2", "/c/k3", "/k4", NULL};
+    const gchar *changed[] = {"/a/k1", "/a/b/k2", "/c/k3", "/c/d/k5", NULL};
+    GError *error = NULL;
+    SvdbTableItem *table, *v1, *v2, *v3, *expected, *first, *second;
+
+    table = build(initial);
+    expected = build(initial);
+    g_assert(!svdb_tree_set(table, "/k4", NULL, &error));
+    g_clear_error(&error);
+
+    v1 = svdb_tree_freeze(table);
+    g_assert(svdb_item_is_frozen(v1));
+    g_assert(!svdb_table_unset(v1, "/"));
+
+    g_assert(!svdb_tree_set(v1, "c/k", NULL, &error));
+    g_clear_error(&error);
+    g_assert(!svdb_tree_set(v1, "/k4/k", g_variant_new_int32(0), &error));
+    g_clear_error(&error);
+
+    // Unset of missing key doesn't copy anything.
+    v2 = svdb_tree_set(v1, "/missing/k", NULL, &error);
+    g_assert_no_error(error);
+    g_assert(v2 == v1);
+    svdb_item_unref(v2);
+
+    v2 = svdb_tree_set(v1, "/c/d/k5", g_variant_new_string("/c/d/k5"), &error);
+    g_assert_no_error(error);
+    v3 = svdb_tree_set(v2, "/k4", NULL, &error);
+    g_assert_no_error(error);
+    g_assert(svdb_item_is_frozen(v3));
+
+    // Old snapshots are unchanged.
+    assert_same_bytes(v1, expected);
+    svdb_item_unref(expected);
+    expected = build(changed);
+    assert_same_bytes(v3, expected);
+    g_assert(svdb_item_equal(v3, expected));
+
+    // Untouched dir is shared, dir on path is copied.
+    first = get_dir(v1, "a/");
+    second = get_dir(v3, "a/");
+    g_assert(first == second);
+    svdb_item_unref(first);
+    svdb_item_unref(second);
+
+    first = get_dir(v1, "c/");
+    second = get_dir(v3, "c/");
+    g_assert(first != second);
+    g_assert(svdb_item_is_frozen(second));
+    g_assert(!svdb_item_list_clear(second));
+    svdb_item_unref(first);
+    svdb_item_unref(second);
+
+    // Snapshots outlive each other in any order.
+    svdb_item_unref(table);
+    svdb_item_unref(v1);
+    svdb_item_unref(v2);
+    assert_same_bytes(v3, expected);
+
+    svdb_item_unref(expected);
+    svdb_item_unref(v3);
+}
@@ -0,0 +1,103 @@
+#include <svdb.h>
+
+void check_sorted_output(const gchar *filename) {
+    GError *error = NULL;
+    SvdbTableItem *table, *copy;
+    GBytes *bytes, *copy_bytes;
+    GString *dump, *copy_dump;
+    gchar **keys;
+    gsize size;
+
+    table = svdb_table_read_from_file(filename, FALSE, &error);
+    g_assert_no_error(error);
+
+    // Parsed copy has other GHashTable order, but output must be the same.
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    copy = svdb_table_read_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    copy_bytes = svdb_table_get_raw(copy, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(bytes, copy_bytes));
+
+    dump = svdb_item_dump(table, "/", FALSE);
+    copy_dump = svdb_item_dump(copy, "/", FALSE);
+    g_assert(g_string_equal(dump, copy_dump));
+
+    keys = svdb_table_list_child(table, &size, &error);
+    g_assert_no_error(error);
+    for (gsize i = 1; i < size; ++i) {
+        g_assert_cmpstr(keys[i - 1], <, keys[i]);
+    }
+
+    g_strfreev(keys);
+    g_string_free(dump, TRUE);
+    g_string_free(copy_dump, TRUE);
+    g_bytes_unref(bytes);
+    g_bytes_unref(copy_bytes);
+    svdb_item_unref(copy);
+    svdb_item_unref(table);
+}
+
+SvdbTableItem *build_table(gboolean reverse) {
+    GError *error = NULL;
+    SvdbTableItem *table = svdb_table_new();
+
+    for (gint i = 0; i < 64; ++i) {
+        gint value = reverse ? 63 - i : i;
+        gchar *key = g_strdup_printf("key%d", value);
+        SvdbTableItem *item = svdb_item_new();
+        GVariant *variant = g_variant_ref_sink(g_variant_new_int32(value));
+
+        svdb_item_set_variant(item, variant);
+        g_variant_unref(variant);
+        svdb_table_set(table, key, item, &error);
+        g_assert_no_error(error);
+
+        svdb_item_unref(item);
+        g_free(key);
+    }
+
+    return table;
+}
+
+int main() {
+    GDir *dir;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+    SvdbTableItem *table, *reversed;
+    GBytes *bytes, *reversed_bytes;
+
+    // Same content, inserted in other order.
+    table = build_table(FALSE);
+    reversed = build_table(TRUE);
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    reversed_bytes = svdb_table_get_raw(reversed, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(bytes, reversed_bytes));
+    g_bytes_unref(bytes);
+    g_bytes_unref(reversed_bytes);
+    svdb_item_unref(table);
+    svdb_item_unref(reversed);
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        check_sorted_output(file_full_path);
+        g_free(file_full_path);
+    }
+
+    g_dir_close(dir);
+}
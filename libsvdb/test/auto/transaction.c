@@ -0,0 +1,126 @@
+#include <svdb.h>
+
+SvdbTableItem *build(const gchar **paths) {
+    GError *error = NULL;
+    SvdbTreeBuilder *builder = svdb_tree_builder_new();
+
+    for (gint i = 0; paths[i]; ++i) {
+        g_assert(svdb_tree_builder_add(builder, paths[i], g_variant_new_string(paths[i]), &error));
+        g_assert_no_error(error);
+    }
+    return svdb_tree_builder_finish(builder);
+}
+
+void assert_same_bytes(SvdbTableItem *table, SvdbTableItem *expected) {
+    GError *error = NULL;
+    GBytes *bytes, *expected_bytes;
+
+    // Writer uses child counters, so equal bytes mean that counters are right too.
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    expected_bytes = svdb_table_get_raw(expected, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(bytes, expected_bytes));
+
+    g_bytes_unref(bytes);
+    g_bytes_unref(expected_bytes);
+}
+
+void check_list_remove(void) {
+    const gchar *removed[] = {"b", "d", "b"};
+    const gchar *missing[] = {"a", "z"};
+    SvdbTableItem *list = svdb_item_new();
+    const SvdbListElement *elements;
+    GError *error = NULL;
+    gsize length;
+
+    for (gint i = 0; i < 5; ++i) {
+        gchar key[] = {'a' + i, '\0'};
+
+        svdb_item_list_append_variant(list, key, g_variant_new_int32(i), &error);
+        g_assert_no_error(error);
+    }
+
+    g_assert(svdb_item_list_remove_element(list, "c"));
+    g_assert(!svdb_item_list_remove_element(list, "c"));
+    elements = svdb_item_get_list(list, &length);
+    g_assert_cmpuint(length, ==, 4);
+    g_assert_cmpstr(elements[2].key, ==, "d");
+
+    g_assert(!svdb_item_list_remove_elements(list, missing, G_N_ELEMENTS(missing), TRUE));
+    g_assert_cmpuint(svdb_item_get_length(list), ==, 4);
+
+    g_assert(svdb_item_list_remove_elements(list, removed, G_N_ELEMENTS(removed), TRUE));
+    elements = svdb_item_get_list(list, &length);
+    g_assert_cmpuint(length, ==, 2);
+    g_assert_cmpstr(elements[0].key, ==, "a");
+    g_assert_cmpstr(elements[1].key, ==, "e");
+
+    svdb_item_unref(list);
+}
+
+int main() {
+    const gchar *initial[] = {"/a/k1", "/a/k2", "/a/b/k3", "/c/k4", "/k5", NULL};
+    const gchar *changed[] = {"/a/k1", "/c/new/k6", "/k5", "/k7", "/b/k8", NULL};
+    GError *error = NULL;
+    SvdbTransaction *transaction;
+    SvdbTableItem *table, *expected, *list;
+
+    check_list_remove();
+
+    table = build(initial);
+    expected = build(changed);
+    transaction = svdb_transaction_new(table);
+
+    g_assert(!svdb_transaction_set(transaction, "a/k", g_variant_new_int32(0), &error));
+    g_clear_error(&error);
+    g_assert(!svdb_transaction_remove(transaction, "/a", &error));
+    g_clear_error(&error);
+
+    g_assert(svdb_transaction_set(transaction, "/a/b/k9", g_variant_new_string("/a/b/k9"), &error));
+    g_assert(svdb_transaction_remove(transaction, "/a/b/", &error));
+    g_assert(svdb_transaction_unset(transaction, "/a/k2", &error));
+    g_assert(svdb_transaction_unset(transaction, "/missing", &error));
+    g_assert(svdb_transaction_remove(transaction, "/c/", &error));
+    g_assert(svdb_transaction_set(transaction, "/c/new/k6", g_variant_new_string("/c/new/k6"), &error));
+    g_assert(svdb_transaction_set(transaction, "/k5", g_variant_new_int32(0), &error));
+    g_assert(svdb_transaction_set(transaction, "/k5", g_variant_new_string("/k5"), &error));
+    g_assert(svdb_transaction_set(transaction, "/k7", g_variant_new_string("/k7"), &error));
+    g_assert(svdb_transaction_set(transaction, "/b/k8", g_variant_new_string("/b/k8"), &error));
+    g_assert_no_error(error);
+
+    g_assert(svdb_transaction_commit(transaction, &error));
+    g_assert_no_error(error);
+    g_assert(svdb_item_equal(table, expected));
+    assert_same_bytes(table, expected);
+
+    // Commit with non-list dir doesn't change anything.
+    list = svdb_table_get(table, "/");
+    svdb_item_list_append_variant(list, "bad/", g_variant_new_int32(0), &error);
+    g_assert_no_error(error);
+    svdb_item_unref(list);
+
+    svdb_item_unref(expected);
+    expected = build(changed);
+    list = svdb_table_get(expected, "/");
+    svdb_item_list_append_variant(list, "bad/", g_variant_new_int32(0), &error);
+    g_assert_no_error(error);
+    svdb_item_unref(list);
+
+    g_assert(svdb_transaction_unset(transaction, "/k7", &error));
+    g_assert(svdb_transaction_set(transaction, "/bad/k", g_variant_new_int32(0), &error));
+    g_assert(!svdb_transaction_commit(transaction, &error));
+    g_assert(error);
+    g_clear_error(&error);
+    assert_same_bytes(table, expected);
+
+    // Rolled back ops are dropped.
+    g_assert(svdb_transaction_unset(transaction, "/k7", &error));
+    svdb_transaction_rollback(transaction);
+    g_assert(svdb_transaction_commit(transaction, &error));
+    assert_same_bytes(table, expected);
+
+    svdb_transaction_free(transaction);
+    svdb_item_unref(expected);
+    svdb_item_unref(table);
+}
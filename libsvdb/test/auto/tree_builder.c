@@ -0,0 +1,119 @@
+#include <svdb.h>
+
+SvdbFile *write_tree(SvdbTableItem *table) {
+    GError *error = NULL;
+    SvdbFile *file;
+    GBytes *bytes;
+
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    file = svdb_file_new_from_bytes(bytes, FALSE, &error);
+    g_assert_no_error(error);
+    g_bytes_unref(bytes);
+    return file;
+}
+
+/// @brief Add value with incremental API (svdb_item_list_append_value on every level).
+void add_incremental(SvdbTableItem *table, const gchar *path, GVariant *value) {
+    GError *error = NULL;
+    gchar **segments = g_strsplit(path + 1, "/", -1);
+    SvdbTableItem *list = svdb_table_get(table, "/");
+
+    if (!list) {
+        list = svdb_item_new();
+        svdb_item_list_append(list, NULL, 0, &error);
+        svdb_table_set(table, "/", list, &error);
+        g_assert_no_error(error);
+    }
+
+    for (gchar **segment = segments; segment[1]; ++segment) {
+        gchar *key = g_strconcat(*segment, "/", NULL);
+        SvdbTableItem *child = svdb_item_list_get_element(list, key);
+
+        if (!child) {
+            child = svdb_item_new();
+            svdb_item_list_append(child, NULL, 0, &error);
+            svdb_item_list_append_value(list, key, child, &error);
+            g_assert_no_error(error);
+        }
+
+        svdb_item_unref(list);
+        list = child;
+        g_free(key);
+    }
+
+    svdb_item_list_append_variant(list, segments[g_strv_length(segments) - 1], value, &error);
+    g_assert_no_error(error);
+
+    svdb_item_unref(list);
+    g_strfreev(segments);
+}
+
+int main() {
+    GError *error = NULL;
+    SvdbTreeBuilder *builder;
+    SvdbTableItem *table, *incremental;
+    GBytes *bytes, *incremental_bytes;
+    SvdbFile *file;
+    GVariant *value;
+
+    builder = svdb_tree_builder_new();
+    g_assert(!svdb_tree_builder_add(builder, "org/key", g_variant_new_int32(0), &error));
+    g_clear_error(&error);
+    g_assert(!svdb_tree_builder_add(builder, "/org/", g_variant_new_int32(0), &error));
+    g_clear_error(&error);
+
+    g_assert(svdb_tree_builder_add(builder, "/org/gnome/a", g_variant_new_int32(1), &error));
+    g_assert(svdb_tree_builder_add(builder, "/org/gnome/b", g_variant_new_int32(2), &error));
+    g_assert(svdb_tree_builder_add(builder, "/org/c", g_variant_new_int32(3), &error));
+    g_assert(svdb_tree_builder_add(builder, "/org/gnome/a", g_variant_new_int32(4), &error));
+    g_assert_no_error(error);
+    table = svdb_tree_builder_finish(builder);
+
+    // Root table has "/", "/" has "org/", "org/" has "gnome/" and "c", "gnome/" has "a" and "b".
+    g_assert_cmpuint(svdb_item_get_length(table), ==, 1);
+
+    file = write_tree(table);
+    value = svdb_file_read(file, "/org/gnome/a", &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(g_variant_get_int32(value), ==, 4);
+    g_variant_unref(value);
+    value = svdb_file_read(file, "/org/c", &error);
+    g_assert_no_error(error);
+    g_assert_cmpint(g_variant_get_int32(value), ==, 3);
+    g_variant_unref(value);
+    svdb_file_unref(file);
+    svdb_item_unref(table);
+
+    // Builder can be dropped without finishing.
+    builder = svdb_tree_builder_new();
+    g_assert(svdb_tree_builder_add(builder, "/a/b/c", g_variant_new_boolean(TRUE), &error));
+    svdb_tree_builder_free(builder);
+
+    // Same tree as incremental API builds, with the same child counters.
+    builder = svdb_tree_builder_new();
+    incremental = svdb_table_new();
+
+    for (gint i = 0; i < 1000; ++i) {
+        gchar *key = g_strdup_printf("/dir%d/subdir%d/key%d", i % 7, i % 13, i);
+
+        g_assert(svdb_tree_builder_add(builder, key, g_variant_new_int32(i), &error));
+        g_assert_no_error(error);
+        add_incremental(incremental, key, g_variant_new_int32(i));
+        g_free(key);
+    }
+
+    table = svdb_tree_builder_finish(builder);
+    g_assert(svdb_item_equal(table, incremental));
+
+    bytes = svdb_table_get_raw(table, FALSE, &error);
+    g_assert_no_error(error);
+    incremental_bytes = svdb_table_get_raw(incremental, FALSE, &error);
+    g_assert_no_error(error);
+    g_assert(g_bytes_equal(bytes, incremental_bytes));
+
+    g_bytes_unref(bytes);
+    g_bytes_unref(incremental_bytes);
+    svdb_item_unref(incremental);
+    svdb_item_unref(table);
+}
@@ -0,0 +1,100 @@
+#include <svdb.h>
+
+void assert_print(GVariant *value) {
+    g_variant_ref_sink(value);
+
+    for (gint annotate = 0; annotate < 2; ++annotate) {
+        gchar *expected = g_variant_print(value, annotate);
+        gchar *actual = svdb_variant_print(value, annotate);
+        GString *buffer = g_string_new("key=");
+
+        g_assert_cmpstr(actual, ==, expected);
+
+        // Value is appended to existing content.
+        svdb_variant_print_string(value, buffer, annotate);
+        g_assert(g_str_has_prefix(buffer->str, "key="));
+        g_assert_cmpstr(buffer->str + strlen("key="), ==, expected);
+
+        g_string_free(buffer, TRUE);
+        g_free(actual);
+        g_free(expected);
+    }
+
+    g_variant_unref(value);
+}
+
+void assert_print_string(const gchar *text) {
+    const gchar *strv[] = {text, "", text};
+
+    assert_print(g_variant_new_string(text));
+    assert_print(g_variant_new_strv(strv, G_N_ELEMENTS(strv)));
+}
+
+int main() {
+    const gchar *strings[] = {
+        "", "plain", "with space", "it's", "\"quoted\"", "both ' and \"", "back\\slash", "'\\",
+        "line\nbreak", "\a\b\f\n\r\t\v", "\x01\x1f\x7f", "caf\xc3\xa9", "\xe4\xb8\xad\xe6\x96\x87",
+        "\xe2\x80\x8b", "\xc2\x85", "\xf0\x9f\x98\x80", "\xf3\xa0\x80\x81", NULL,
+    };
+    const gchar *empty[] = {NULL};
+
+    assert_print(g_variant_new_boolean(TRUE));
+    assert_print(g_variant_new_boolean(FALSE));
+
+    assert_print(g_variant_new_int32(0));
+    assert_print(g_variant_new_int32(-1));
+    assert_print(g_variant_new_int32(G_MAXINT32));
+    assert_print(g_variant_new_int32(G_MININT32));
+    assert_print(g_variant_new_uint32(0));
+    assert_print(g_variant_new_uint32(G_MAXUINT32));
+
+    assert_print(g_variant_new_double(0.0));
+    assert_print(g_variant_new_double(-0.0));
+    assert_print(g_variant_new_double(1.0));
+    assert_print(g_variant_new_double(0.1));
+    assert_print(g_variant_new_double(-2.5e-300));
+    assert_print(g_variant_new_double(1e100));
+    assert_print(g_variant_new_double(G_MAXDOUBLE));
+    assert_print(g_variant_new_double(1.0 / 0.0));
+    assert_print(g_variant_new_double(0.0 / 0.0));
+
+    for (gint i = 0; strings[i]; ++i) {
+        assert_print_string(strings[i]);
+    }
+
+    // Special chars at every position of long strings (vectorized scan works by 16 bytes).
+    for (gsize length = 1; length < 48; ++length) {
+        for (gsize position = 0; position < length; ++position) {
+            static const gchar specials[] = {'\'', '"', '\\', '\n', '\x7f', '\xc3'};
+
+            for (gsize i = 0; i < G_N_ELEMENTS(specials); ++i) {
+                GString *text = g_string_new(NULL);
+
+                for (gsize j = 0; j < length; ++j) {
+                    g_string_append_c(text, 'a' + j % 26);
+                }
+                if (specials[i] == '\xc3') {
+                    text->str[position] = '\xc3';
+                    g_string_insert_c(text, position + 1, '\xa9');
+                } else {
+                    text->str[position] = specials[i];
+                }
+
+                assert_print_string(text->str);
+                g_string_free(text, TRUE);
+            }
+        }
+    }
+
+    assert_print(g_variant_new_strv(empty, 0));
+
+    // Other types are printed by generic path.
+    assert_print(g_variant_new_byte(7));
+    assert_print(g_variant_new_int64(-7));
+    assert_print(g_variant_new_parsed("(1, 'x')"));
+    assert_print(g_variant_new_parsed("{'a': <1>, 'b': <'c'>}"));
+    assert_print(g_variant_new_parsed("[@ms 'x', nothing]"));
+    assert_print(g_variant_new_parsed("b'bytes'"));
+    assert_print(g_variant_new_parsed("[[1, 2], @ai []]"));
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <svdb.h>
+#include <glib/gstdio.h>
+
+void verify_file(const gchar *file_path, const gchar *tmp_dir) {
+    g_assert(file_path && *file_path);
+    GError *error = NULL;
+    GMappedFile *mapped;
+    GBytes *bytes, *truncated;
+    SvdbTableItem *table;
+    // Brackets aren't allowed in key file group names, cache must store such paths too.
+    gchar *copy_path = g_build_filename(tmp_dir, "copy[1].gvdb", NULL);
+    GKeyFile *cache;
+    gchar *cached_path;
+    gchar *cache_path = g_build_filename(tmp_dir, "cache", "verified", NULL);
+
+    mapped = g_mapped_file_new(file_path, FALSE, &error);
+    g_assert_no_error(error);
+    bytes = g_mapped_file_get_bytes(mapped);
+    g_mapped_file_unref(mapped);
+
+    g_assert(svdb_verify_bytes(bytes, &error));
+    g_assert_no_error(error);
+
+    // Last chunk of file is always referenced, so truncated file must be rejected.
+    truncated = g_bytes_new_from_bytes(bytes, 0, g_bytes_get_size(bytes) / 2);
+    g_assert(!svdb_verify_bytes(truncated, &error));
+    g_assert(error);
+    g_clear_error(&error);
+
+    // First load verifies and fills cache, second one is trusted.
+    g_file_set_contents(copy_path, g_bytes_get_data(bytes, NULL), g_bytes_get_size(bytes), &error);
+    g_assert_no_error(error);
+    for (int i = 0; i < 2; ++i) {
+        table = svdb_table_read_from_file_cached(copy_path, cache_path, &error);
+        g_assert_no_error(error);
+        g_assert(table);
+        svdb_item_unref(table);
+    }
+
+    cache = g_key_file_new();
+    g_assert(g_key_file_load_from_file(cache, cache_path, G_KEY_FILE_NONE, &error));
+    g_assert_no_error(error);
+    gchar *group = g_key_file_get_start_group(cache);
+    g_assert(group);
+    cached_path = g_key_file_get_string(cache, group, "path", &error);
+    g_assert_no_error(error);
+    g_assert(g_str_has_suffix(cached_path, "/copy[1].gvdb"));
+    g_free(cached_path);
+    g_free(group);
+    g_key_file_unref(cache);
+
+    // Modified file must be verified again.
+    g_file_set_contents(copy_path, g_bytes_get_data(truncated, NULL), g_bytes_get_size(truncated), &error);
+    g_assert_no_error(error);
+    table = svdb_table_read_from_file_cached(copy_path, cache_path, &error);
+    g_assert(!table);
+    g_assert(error);
+    g_clear_error(&error);
+
+    g_unlink(copy_path);
+    g_unlink(cache_path);
+    g_bytes_unref(truncated);
+    g_bytes_unref(bytes);
+    g_free(cache_path);
+    g_free(copy_path);
+}
+
+int main() {
+    GDir *dir;
+    GError *error = NULL;
+    const gchar *filename;
+    const gchar *path;
+    gchar *tmp_dir;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    tmp_dir = g_dir_make_tmp("svdb-verify-XXXXXX", &error);
+    g_assert_no_error(error);
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        gchar *file_full_path = g_strdup_printf("%s%s", path, filename);
+        verify_file(file_full_path, tmp_dir);
+        g_free(file_full_path);
+    }
+
+    g_dir_close(dir);
+    gchar *cache_dir = g_build_filename(tmp_dir, "cache", NULL);
+    g_rmdir(cache_dir);
+    g_free(cache_dir);
+    g_rmdir(tmp_dir);
+    g_free(tmp_dir);
+}
@@ -0,0 +1,100 @@
+#include <svdb.h>
+
+typedef struct {
+    gsize values;
+    gsize containers;
+    gsize depth;
+    gsize stop_after;
+} VisitCounts;
+
+SvdbVisitResult count_visit(SvdbVisitEvent event, const gchar *name, const gchar *key, SvdbFileValue *value,
+                            gpointer user_data) {
+    VisitCounts *counts = user_data;
+
+    switch (event) {
+        case SVDB_VISIT_ENTER_TABLE:
+        case SVDB_VISIT_ENTER_LIST:
+            g_assert(name && key);
+            g_assert(g_str_has_suffix(name, key));
+            ++counts->containers;
+            ++counts->depth;
+            break;
+        case SVDB_VISIT_VALUE:
+            g_assert(name && key && value);
+            g_assert(g_str_has_suffix(name, key));
+            g_assert(svdb_file_value_get_variant(value));
+            ++counts->values;
+            if (counts->stop_after && counts->values == counts->stop_after) {
+                return SVDB_VISIT_STOP;
+            }
+            break;
+        case SVDB_VISIT_LEAVE:
+            g_assert(counts->depth > 0);
+            --counts->depth;
+            break;
+    }
+
+    return SVDB_VISIT_CONTINUE;
+}
+
+// Count values of all items, including nested tables.
+gsize count_values(const SvdbTableItem *item) {
+    SvdbTableItem *value;
+    SvdbIter iter;
+    gsize count = 0;
+
+    if (svdb_item_get_type(item) == SVDB_TYPE_VARIANT) {
+        return 1;
+    }
+
+    svdb_iter_init(&iter, item);
+    while (svdb_iter_next(&iter, NULL, &value)) {
+        count += count_values(value);
+    }
+    return count;
+}
+
+int main() {
+    GDir *dir;
+    SvdbTableItem *table;
+    SvdbFile *file;
+    const gchar *path;
+    const gchar *filename;
+    GError *error = NULL;
+
+    if (g_file_test("../test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../test/data/";
+    } else if (g_file_test("../../libsvdb/test/data/", G_FILE_TEST_IS_DIR | G_FILE_TEST_EXISTS)) {
+        path = "../../libsvdb/test/data/";
+    } else {
+        g_error("%s", "test data folder doesn't found!");
+    }
+
+    dir = g_dir_open(path, 0, &error);
+    g_assert_no_error(error);
+
+    while ((filename = g_dir_read_name(dir))) {
+        VisitCounts counts = {0};
+        VisitCounts stopped = {0, 0, 0, 1};
+
+        filename = g_strdup_printf("%s/%s", path, filename);
+        table = svdb_table_read_from_file(filename, FALSE, &error);
+        g_assert_no_error(error);
+        file = svdb_file_new(filename, FALSE, &error);
+        g_assert_no_error(error);
+
+        g_assert(svdb_file_visit(file, count_visit, &counts, &error));
+        g_assert_no_error(error);
+        g_assert_cmpuint(counts.values, ==, count_values(table));
+        g_assert_cmpuint(counts.depth, ==, 0);
+
+        g_assert(svdb_file_visit(file, count_visit, &stopped, &error));
+        g_assert_no_error(error);
+        g_assert_cmpuint(stopped.values, ==, MIN(counts.values, 1));
+
+        svdb_file_unref(file);
+        svdb_item_unref(table);
+        g_free((gpointer) filename);
+    }
+    g_dir_close(dir);
+}
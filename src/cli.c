@@ -9,34 +9,123 @@ static const char *DEFAULT_HELP_MESSAGE =
         "  help\t\tShow this information\n"
         "  read\t\tRead the value of a key\n"
         "  list\t\tList the contents of a dir\n"
-        "  dump\t\tDump an entire subpath to stdout\n";
+        "  dump\t\tDump an entire subpath to stdout\n"
+        "  find\t\tFind keys by pattern\n"
+        "  watch\t\tPrint changed keys on every change of file\n"
+        "  diff\t\tPrint differences between two files\n"
+        "  scan\t\tRun query over many files in parallel\n"
+        "  serve\t\tRun daemon, which answers read, list, dump and complete of other runs\n"
+        "  complete\tComplete partial key or dir path (for shell completion)\n";
 
 static const char *READ_HELP_MESSAGE =
         "Usage:\n"
-        "  dbdconf GVDB_PATH read KEY\n"
-        "  dbdconf read GVDB_PATH KEY\n\n"
+        "  dbdconf GVDB_PATH read [OPTIONS...] KEY\n"
+        "  dbdconf read GVDB_PATH [OPTIONS...] KEY\n\n"
         "Read the value of a key\n\n"
         "Arguments:\n"
         " GVDB_PATH\t\tA GVDB layer file path\n"
-        " KEY\t\t\tA key path (starting, but not ending with '/')\n";
+        " KEY\t\t\tA key path (starting, but not ending with '/')\n\n"
+        "Options:\n"
+        " --raw\t\t\tWrite value as serialized GVariant of type 'v' (value bytes, zero byte\n"
+        "\t\t\tand type string, host byte order) instead of text\n"
+        " --format=FORMAT\tPrint record 'jsonl', 'nul' or 'gvariant-text' (see 'dbdconf dump help')\n";
 
 static const char *LIST_HELP_MESSAGE =
         "Usage:\n"
-        "  dbdconf GVDB_PATH list DIR\n"
-        "  dbdconf list GVDB_PATH DIR\n\n"
+        "  dbdconf GVDB_PATH list [OPTIONS...] DIR\n"
+        "  dbdconf list GVDB_PATH [OPTIONS...] DIR\n\n"
         "List the sub-keys and sub-dirs of a dir\n\n"
         "Arguments:\n"
         " GVDB_PATH\t\tA GVDB layer file path\n"
-        " DIR\t\t\tA directory path (starting and ending with '/')\n";
+        " DIR\t\t\tA directory path (starting and ending with '/')\n\n"
+        "Options:\n"
+        " --format=FORMAT\tPrint record of every sub-key and sub-dir 'jsonl', 'nul' or 'gvariant-text'\n"
+        "\t\t\t(see 'dbdconf dump help', sub-dirs have empty type and value)\n";
 
 static const char *DUMP_HELP_MESSAGE =
         "Usage:\n"
-        "  dbdconf GVDB_PATH dump DIR\n"
-        "  dbdconf dump GVDB_PATH DIR\n\n"
+        "  dbdconf GVDB_PATH dump [OPTIONS...] DIR\n"
+        "  dbdconf dump GVDB_PATH [OPTIONS...] DIR\n\n"
         "Dump an entire sub-path to stdout\n\n"
         "Arguments:\n"
         " GVDB_PATH\t\tA GVDB layer file path\n"
-        " DIR\t\t\tA directory path (starting and ending with '/')\n";
+        " DIR\t\t\tA directory path (starting and ending with '/')\n\n"
+        "Options:\n"
+        " --format=FORMAT\tPrint one record per key, in file order, instead of keyfile-like text:\n"
+        "\t\t\t'jsonl' - '{\"path\":PATH,\"type\":TYPE,\"value\":VALUE}' per line\n"
+        "\t\t\t'nul' - 'PATH<NUL>TYPE<NUL>VALUE<NUL>'\n"
+        "\t\t\t'gvariant-text' - 'PATH<TAB>TYPE<TAB>VALUE' per line\n"
+        "\t\t\t(VALUE is GVariant text, like in default output)\n";
+
+static const char *FIND_HELP_MESSAGE =
+        "Usage:\n"
+        "  dbdconf GVDB_PATH find [OPTIONS...] PATTERN\n"
+        "  dbdconf find GVDB_PATH [OPTIONS...] PATTERN\n\n"
+        "Find keys (and their values) by pattern\n\n"
+        "Arguments:\n"
+        " GVDB_PATH\t\tA GVDB layer file path\n"
+        " PATTERN\t\tA key pattern (every key, if not present)\n\n"
+        "Options:\n"
+        " --prefix\t\tKey starts with PATTERN (default)\n"
+        " --glob\t\t\tKey matches glob PATTERN ('*' matches any string, including '/')\n"
+        " --regex\t\tKey contains match of regular expression PATTERN\n"
+        " --type=TYPE\t\tValue has GVariant type TYPE\n"
+        " --value=VALUE\t\tValue is equal to GVariant text VALUE\n";
+
+static const char *WATCH_HELP_MESSAGE =
+        "Usage:\n"
+        "  dbdconf GVDB_PATH watch\n"
+        "  dbdconf watch GVDB_PATH\n\n"
+        "Watch file and print added, removed and changed keys on every change\n"
+        "(one per line: 'added<TAB>KEY<TAB>VALUE', 'removed<TAB>KEY', 'changed<TAB>KEY<TAB>VALUE')\n\n"
+        "Arguments:\n"
+        " GVDB_PATH\t\tA GVDB layer file path\n";
+
+static const char *DIFF_HELP_MESSAGE =
+        "Usage:\n"
+        "  dbdconf GVDB_PATH diff OTHER_GVDB_PATH\n"
+        "  dbdconf diff GVDB_PATH OTHER_GVDB_PATH\n\n"
+        "Print added, removed and changed keys of OTHER_GVDB_PATH relative to GVDB_PATH, sorted by key\n"
+        "(one per line: 'added<TAB>KEY<TAB>VALUE', 'removed<TAB>KEY', 'changed<TAB>KEY<TAB>VALUE').\n"
+        "Exit status is 0 if files are equal, 1 if they differ\n\n"
+        "Arguments:\n"
+        " GVDB_PATH\t\tA GVDB layer file path\n"
+        " OTHER_GVDB_PATH\tA GVDB layer file path\n";
+
+static const char *SCAN_HELP_MESSAGE =
+        "Usage:\n"
+        "  dbdconf scan [OPTIONS...] GVDB_PATH...\n\n"
+        "Run the same query over many files in parallel, print results in order of files, tagged by file\n"
+        "('GVDB_PATH<TAB>VALUE' for read, 'GVDB_PATH<TAB>KEY=VALUE' for find,\n"
+        "'GVDB_PATH<TAB>size=N<TAB>values=N<TAB>dirs=N<TAB>tables=N' for stats). Errors (including globs\n"
+        "without matching files) are printed to stderr, and exit status is non-zero\n\n"
+        "Arguments:\n"
+        " GVDB_PATH\t\tA GVDB layer file path, or glob of paths (like '/home/*/.config/dconf/user')\n\n"
+        "Options:\n"
+        " --stats\t\tPrint size and count of values, dirs and tables (default)\n"
+        " --read=KEY\t\tPrint the value of a key\n"
+        " --find=PATTERN\t\tFind keys by pattern (see 'dbdconf find help' for options)\n"
+        " --jobs=N\t\tProcess N files at once (number of processors, if not present)\n";
+
+static const char *SERVE_HELP_MESSAGE =
+        "Usage:\n"
+        "  dbdconf serve\n\n"
+        "Run daemon, which keeps GVDB files mapped and parsed, and answers read, list, dump and complete commands\n"
+        "of other dbdconf runs (until SIGINT/SIGTERM). Commands are run locally, when daemon isn't running.\n"
+        "Files are reloaded on change\n\n"
+        "Environment:\n"
+        " DBDCONF_SOCKET\t\tSocket path ($XDG_RUNTIME_DIR/dbdconf.sock, if not present)\n"
+        " DBDCONF_NO_DAEMON\tDon't use daemon (if set)\n";
+
+static const char *COMPLETE_HELP_MESSAGE =
+        "Usage:\n"
+        "  dbdconf GVDB_PATH complete PARTIAL\n"
+        "  dbdconf complete GVDB_PATH PARTIAL\n\n"
+        "Print children of dir of PARTIAL, which start with the rest of PARTIAL (one full path per line,\n"
+        "dir paths end with '/'). Only the dir is looked up, so it's fast on large files\n\n"
+        "Arguments:\n"
+        " GVDB_PATH\t\tA GVDB layer file path\n"
+        " PARTIAL\t\tA partial key or dir path ('/' is printed, if it doesn't begin with '/')\n";
 
 const char *dbd_get_help_for(DbdCliInstanceCommand command) {
     switch (command) {
@@ -50,6 +139,18 @@ const char *dbd_get_help_for(DbdCliInstanceCommand command) {
             return LIST_HELP_MESSAGE;
         case DBD_INSTANCE_COMMAND_DUMP:
             return DUMP_HELP_MESSAGE;
+        case DBD_INSTANCE_COMMAND_FIND:
+            return FIND_HELP_MESSAGE;
+        case DBD_INSTANCE_COMMAND_WATCH:
+            return WATCH_HELP_MESSAGE;
+        case DBD_INSTANCE_COMMAND_DIFF:
+            return DIFF_HELP_MESSAGE;
+        case DBD_INSTANCE_COMMAND_SCAN:
+            return SCAN_HELP_MESSAGE;
+        case DBD_INSTANCE_COMMAND_SERVE:
+            return SERVE_HELP_MESSAGE;
+        case DBD_INSTANCE_COMMAND_COMPLETE:
+            return COMPLETE_HELP_MESSAGE;
     }
 }
 
@@ -100,13 +201,54 @@ gboolean dbd_lexing_command(int *argc, const char ***argv, DbdCliInstance *insta
             --(*argc), ++(*argv);
             instance->command = DBD_INSTANCE_COMMAND_LIST;
             break;
+        case 'c':
+            if (strcmp((**argv), "complete") != 0 || instance->command != DBD_INSTANCE_COMMAND_NONE) {
+                goto error_sequence;
+            }
+            --(*argc), ++(*argv);
+            instance->command = DBD_INSTANCE_COMMAND_COMPLETE;
+            break;
         case 'd':
+            if (strcmp((**argv), "diff") == 0 && instance->command == DBD_INSTANCE_COMMAND_NONE) {
+                --(*argc), ++(*argv);
+                instance->command = DBD_INSTANCE_COMMAND_DIFF;
+                break;
+            }
             if (strcmp((**argv), "dump") != 0 || instance->command != DBD_INSTANCE_COMMAND_NONE) {
                 goto error_sequence;
             }
             --(*argc), ++(*argv);
             instance->command = DBD_INSTANCE_COMMAND_DUMP;
             break;
+        case 'f':
+            if (strcmp((**argv), "find") != 0 || instance->command != DBD_INSTANCE_COMMAND_NONE) {
+                goto error_sequence;
+            }
+            --(*argc), ++(*argv);
+            instance->command = DBD_INSTANCE_COMMAND_FIND;
+            break;
+        case 's':
+            if (strcmp((**argv), "serve") == 0 && instance->command == DBD_INSTANCE_COMMAND_NONE
+                && !instance->gvdb_file) {
+                --(*argc), ++(*argv);
+                instance->command = DBD_INSTANCE_COMMAND_SERVE;
+                break;
+            }
+            if (strcmp((**argv), "scan") != 0 || instance->command != DBD_INSTANCE_COMMAND_NONE
+                || instance->gvdb_file) {
+                goto error_sequence;
+            }
+            --(*argc), ++(*argv);
+            instance->command = DBD_INSTANCE_COMMAND_SCAN;
+            instance->scan_files = g_ptr_array_new_with_free_func(&g_free);
+            break;
+        case 'w':
+            if (strcmp((**argv), "watch") != 0 || instance->command != DBD_INSTANCE_COMMAND_NONE) {
+                goto error_sequence;
+            }
+            --(*argc), ++(*argv);
+            instance->command = DBD_INSTANCE_COMMAND_WATCH;
+            break;
         default:
             return FALSE;
     }
@@ -130,6 +272,84 @@ gboolean dbd_lexing_path(int *argc, const char ***argv, gchar **path, gboolean i
     return TRUE;
 }
 
+// Lexing options and pattern of find command (pattern may not begin with a slash).
+gboolean dbd_lexing_find_arg(int *argc, const char ***argv, DbdCliInstance *instance) {
+    const char *lexing = **argv;
+
+    if (strcmp(lexing, "help") == 0) {
+        return dbd_lexing_command(argc, argv, instance);
+    } else if (strcmp(lexing, "--prefix") == 0) {
+        instance->find_mode = DBD_FIND_MODE_PREFIX;
+    } else if (strcmp(lexing, "--glob") == 0) {
+        instance->find_mode = DBD_FIND_MODE_GLOB;
+    } else if (strcmp(lexing, "--regex") == 0) {
+        instance->find_mode = DBD_FIND_MODE_REGEX;
+    } else if (g_str_has_prefix(lexing, "--type=") && !instance->find_type) {
+        instance->find_type = g_strdup(lexing + strlen("--type="));
+    } else if (g_str_has_prefix(lexing, "--value=") && !instance->find_value) {
+        instance->find_value = g_strdup(lexing + strlen("--value="));
+    } else if (!g_str_has_prefix(lexing, "--") && !instance->path) {
+        instance->path = g_strdup(lexing);
+    } else {
+        return FALSE;
+    }
+
+    --(*argc), ++(*argv);
+    return TRUE;
+}
+
+// Lexing value of --format option.
+gboolean dbd_lexing_format(const char *lexing, DbdCliInstance *instance) {
+    if (strcmp(lexing, "gvariant-text") == 0) {
+        instance->format = DBD_FORMAT_GVARIANT_TEXT;
+    } else if (strcmp(lexing, "jsonl") == 0) {
+        instance->format = DBD_FORMAT_JSONL;
+    } else if (strcmp(lexing, "nul") == 0) {
+        instance->format = DBD_FORMAT_NUL;
+    } else {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Lexing options, file paths and globs of scan command.
+gboolean dbd_lexing_scan_arg(int *argc, const char ***argv, DbdCliInstance *instance) {
+    const char *lexing = **argv;
+    guint64 jobs;
+
+    if (strcmp(lexing, "help") == 0) {
+        return dbd_lexing_command(argc, argv, instance);
+    } else if (strcmp(lexing, "--stats") == 0 && !instance->path) {
+        instance->scan_query = DBD_SCAN_QUERY_STATS;
+    } else if (g_str_has_prefix(lexing, "--read=/") && !instance->path) {
+        instance->scan_query = DBD_SCAN_QUERY_READ;
+        instance->path = g_strdup(lexing + strlen("--read="));
+    } else if (g_str_has_prefix(lexing, "--find=") && !instance->path) {
+        instance->scan_query = DBD_SCAN_QUERY_FIND;
+        instance->path = g_strdup(lexing + strlen("--find="));
+    } else if (strcmp(lexing, "--prefix") == 0) {
+        instance->find_mode = DBD_FIND_MODE_PREFIX;
+    } else if (strcmp(lexing, "--glob") == 0) {
+        instance->find_mode = DBD_FIND_MODE_GLOB;
+    } else if (strcmp(lexing, "--regex") == 0) {
+        instance->find_mode = DBD_FIND_MODE_REGEX;
+    } else if (g_str_has_prefix(lexing, "--type=") && !instance->find_type) {
+        instance->find_type = g_strdup(lexing + strlen("--type="));
+    } else if (g_str_has_prefix(lexing, "--value=") && !instance->find_value) {
+        instance->find_value = g_strdup(lexing + strlen("--value="));
+    } else if (g_str_has_prefix(lexing, "--jobs=")
+               && g_ascii_string_to_unsigned(lexing + strlen("--jobs="), 10, 1, 1024, &jobs, NULL)) {
+        instance->scan_jobs = jobs;
+    } else if (!g_str_has_prefix(lexing, "--")) {
+        g_ptr_array_add(instance->scan_files, g_strdup(lexing));
+    } else {
+        return FALSE;
+    }
+
+    --(*argc), ++(*argv);
+    return TRUE;
+}
+
 DbdCliInstance *dbd_parse_args(int argc, const char **argv) {
     DbdCliInstance *instance = g_slice_new0(DbdCliInstance);
     ++argv, --argc;
@@ -138,6 +358,57 @@ DbdCliInstance *dbd_parse_args(int argc, const char **argv) {
         if (instance->command == DBD_INSTANCE_COMMAND_HELP) {
             break;
         }
+        if (instance->command == DBD_INSTANCE_COMMAND_FIND && instance->gvdb_file) {
+            if (!dbd_lexing_find_arg(&argc, &argv, instance)) {
+                g_free((gpointer) instance->gvdb_file);
+                instance->gvdb_file = NULL;
+                instance->command = DBD_INSTANCE_COMMAND_HELP;
+                instance->value = g_strdup_printf("%s: %s\n%s", "error: unknown find argument", *argv,
+                                                  FIND_HELP_MESSAGE);
+                return instance;
+            }
+            continue;
+        }
+        if ((instance->command == DBD_INSTANCE_COMMAND_READ || instance->command == DBD_INSTANCE_COMMAND_LIST
+             || instance->command == DBD_INSTANCE_COMMAND_DUMP) && g_str_has_prefix(*argv, "--format=")) {
+            if (!dbd_lexing_format(*argv + strlen("--format="), instance)) {
+                g_free((gpointer) instance->gvdb_file);
+                instance->gvdb_file = NULL;
+                instance->value = g_strdup_printf("%s: %s\n%s", "error: unknown format", *argv,
+                                                  dbd_get_help_for(instance->command));
+                instance->command = DBD_INSTANCE_COMMAND_HELP;
+                return instance;
+            }
+            --(argc), ++(argv);
+            continue;
+        }
+        if (instance->command == DBD_INSTANCE_COMMAND_READ && !instance->read_raw && strcmp(*argv, "--raw") == 0) {
+            instance->read_raw = TRUE;
+            --(argc), ++(argv);
+            continue;
+        }
+        if (instance->command == DBD_INSTANCE_COMMAND_SCAN) {
+            if (!dbd_lexing_scan_arg(&argc, &argv, instance)) {
+                instance->command = DBD_INSTANCE_COMMAND_HELP;
+                instance->value = g_strdup_printf("%s: %s\n%s", "error: unknown scan argument", *argv,
+                                                  SCAN_HELP_MESSAGE);
+                return instance;
+            }
+            continue;
+        }
+        // Partial path may be empty, or not begin with a slash yet.
+        if (instance->command == DBD_INSTANCE_COMMAND_COMPLETE && instance->gvdb_file && !instance->path
+            && strcmp(*argv, "help") != 0) {
+            instance->path = g_strdup(argv[0]);
+            --(argc), ++(argv);
+            continue;
+        }
+        if (instance->command == DBD_INSTANCE_COMMAND_DIFF && instance->gvdb_file && !instance->path
+            && ((*argv)[0] == '/' || (*argv)[0] == '.')) {
+            instance->path = g_strdup(argv[0]);
+            --(argc), ++(argv);
+            continue;
+        }
         if ((*argv)[0] == '/' || (*argv)[0] == '.') {
             if (!instance->gvdb_file) {
                 instance->gvdb_file = g_strdup(argv[0]);
@@ -183,5 +454,14 @@ void dbd_free_args(DbdCliInstance *instance) {
     if (instance->value) {
         g_free((gpointer) instance->value);
     }
+    if (instance->find_type) {
+        g_free((gpointer) instance->find_type);
+    }
+    if (instance->find_value) {
+        g_free((gpointer) instance->find_value);
+    }
+    if (instance->scan_files) {
+        g_ptr_array_unref(instance->scan_files);
+    }
     g_free_sized(instance, sizeof(DbdCliInstance));
 }
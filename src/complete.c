@@ -0,0 +1,60 @@
+#include <complete.h>
+#include <stdio.h>
+
+GString *dbd_complete(SvdbFile *file, const gchar *partial, GError **error) {
+    GString *output = g_string_new(NULL);
+    const gchar *prefix;
+    gchar **keys;
+    gchar *dir;
+
+    if (!partial || partial[0] != '/') {
+        g_string_append(output, "/\n");
+        return output;
+    }
+
+    // Only dir of partial path is looked up, its children are filtered by the rest.
+    prefix = strrchr(partial, '/') + 1;
+    dir = g_strndup(partial, prefix - partial);
+    keys = svdb_file_list(file, dir, NULL, error);
+
+    for (gchar **key = keys; key && *key; ++key) {
+        if (g_str_has_prefix(*key, prefix)) {
+            g_string_append(output, dir);
+            g_string_append(output, *key);
+            g_string_append_c(output, '\n');
+        }
+    }
+
+    g_strfreev(keys);
+    g_free(dir);
+    return output;
+}
+
+int dbd_complete_path(DbdCliInstance *instance) {
+    GError *error = NULL;
+    GString *output;
+    SvdbFile *file;
+
+    file = svdb_file_new(instance->gvdb_file, FALSE, &error);
+
+    if (error || !file) {
+        printf("%s %s %s", "error while reading ", instance->gvdb_file, "\n");
+        if (error) {
+            g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        }
+        return -2;
+    }
+
+    output = dbd_complete(file, instance->path, &error);
+
+    if (error) {
+        g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        return -3;
+    }
+
+    fputs(output->str, stdout);
+    g_string_free(output, TRUE);
+    svdb_file_unref(file);
+    dbd_free_args(instance);
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <format.h>
+#include <svdb.h>
+#include <stdio.h>
+
+// Records are buffered and written by large blocks.
+#define DBD_FORMAT_FLUSH_SIZE (64 * 1024)
+
+typedef struct DbdRecords_t {
+    GString *buffer;
+    SvdbRecordFormat format;
+} DbdRecords;
+
+static void dbd_records_flush(DbdRecords *records, gboolean force) {
+    if (records->buffer->len >= DBD_FORMAT_FLUSH_SIZE || (force && records->buffer->len)) {
+        fwrite(records->buffer->str, 1, records->buffer->len, stdout);
+        g_string_truncate(records->buffer, 0);
+    }
+}
+
+static gboolean dbd_records_add(const gchar *key, GVariant *value, gpointer user_data) {
+    DbdRecords *records = user_data;
+
+    svdb_record_append(records->buffer, records->format, key, value);
+    dbd_records_flush(records, FALSE);
+    return TRUE;
+}
+
+// List children of dir: dirs as records without value, keys with their values.
+static void dbd_records_list(DbdRecords *records, SvdbFile *file, const gchar *dir, GError **error) {
+    gchar **keys = svdb_file_list(file, dir, NULL, error);
+    GString *path = g_string_new(dir);
+
+    for (gchar **key = keys; key && *key && !*error; ++key) {
+        GVariant *value = NULL;
+
+        g_string_truncate(path, strlen(dir));
+        g_string_append(path, *key);
+
+        if (!g_str_has_suffix(*key, "/")) {
+            value = svdb_file_read(file, path->str, error);
+            if (!value) {
+                continue;
+            }
+        }
+
+        dbd_records_add(path->str, value, records);
+        if (value) {
+            g_variant_unref(value);
+        }
+    }
+
+    g_string_free(path, TRUE);
+    g_strfreev(keys);
+}
+
+int dbd_print_records(DbdCliInstance *instance) {
+    static const SvdbRecordFormat formats[] = {
+        [DBD_FORMAT_GVARIANT_TEXT] = SVDB_RECORD_GVARIANT_TEXT,
+        [DBD_FORMAT_JSONL] = SVDB_RECORD_JSONL,
+        [DBD_FORMAT_NUL] = SVDB_RECORD_NUL,
+    };
+    GError *error = NULL;
+    DbdRecords records;
+    SvdbFile *file;
+
+    file = svdb_file_new(instance->gvdb_file, FALSE, &error);
+
+    if (error || !file) {
+        printf("%s %s %s", "error while reading ", instance->gvdb_file, "\n");
+        if (error) {
+            g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        }
+        return -2;
+    }
+
+    records.buffer = g_string_sized_new(DBD_FORMAT_FLUSH_SIZE + 4096);
+    records.format = formats[instance->format];
+
+    if (instance->path) {
+        switch (instance->command) {
+            case DBD_INSTANCE_COMMAND_READ: {
+                GVariant *value = svdb_file_read(file, instance->path, &error);
+
+                if (value) {
+                    dbd_records_add(instance->path, value, &records);
+                    g_variant_unref(value);
+                }
+                break;
+            }
+            case DBD_INSTANCE_COMMAND_LIST:
+                dbd_records_list(&records, file, instance->path, &error);
+                break;
+            case DBD_INSTANCE_COMMAND_DUMP: {
+                // Path is dir (like in text dump), so prefix doesn't select siblings like `/org/gnome-shell/`.
+                gchar *dir = g_str_has_suffix(instance->path, "/") ? g_strdup(instance->path)
+                                                                   : g_strconcat(instance->path, "/", NULL);
+
+                // Subtrees outside of dir are skipped, records are written in file order.
+                svdb_file_find(file, dir, SVDB_FIND_PREFIX, NULL, NULL, dbd_records_add, &records, &error);
+                g_free(dir);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    dbd_records_flush(&records, TRUE);
+    g_string_free(records.buffer, TRUE);
+
+    if (error) {
+        g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        return -3;
+    }
+
+    svdb_file_unref(file);
+    dbd_free_args(instance);
+    return 0;
+}
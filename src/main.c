@@ -1,6 +1,195 @@
 #include <cli.h>
 #include <svdb.h>
+#include <watch.h>
+#include <scan.h>
+#include <serve.h>
+#include <complete.h>
+#include <format.h>
 #include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+// Write serialized value from file mapping to stdout, without decoding and printing of it.
+static gboolean dbd_write_raw(GBytes *bytes) {
+    gsize size;
+    const gchar *data = g_bytes_get_data(bytes, &size);
+
+    while (size) {
+        gssize written = write(STDOUT_FILENO, data, size);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return FALSE;
+        }
+        data += written;
+        size -= written;
+    }
+    return TRUE;
+}
+
+// Read single key directly from file hash table, without parsing of whole file.
+static int dbd_read_key(DbdCliInstance *instance) {
+    GError *error = NULL;
+    SvdbFile *file;
+    GVariant *value;
+
+    file = svdb_file_new(instance->gvdb_file, FALSE, &error);
+
+    if (error || !file) {
+        printf("%s %s %s", "error while reading ", instance->gvdb_file, "\n");
+        if (error) {
+            g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        }
+        return -2;
+    }
+
+    if (instance->read_raw) {
+        GBytes *bytes = svdb_file_read_raw(file, instance->path, &error);
+
+        if (error) {
+            g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+            return -3;
+        }
+        if (bytes && !dbd_write_raw(bytes)) {
+            g_bytes_unref(bytes);
+            return -4;
+        }
+        if (bytes) {
+            g_bytes_unref(bytes);
+        }
+
+        svdb_file_unref(file);
+        dbd_free_args(instance);
+        return 0;
+    }
+
+    value = svdb_file_read(file, instance->path, &error);
+
+    if (error) {
+        g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        return -3;
+    }
+    if (value) {
+        gchar *output = svdb_variant_print(value, FALSE);
+
+        printf("%s\n", output);
+        g_free(output);
+        g_variant_unref(value);
+    }
+
+    svdb_file_unref(file);
+    dbd_free_args(instance);
+    return 0;
+}
+
+static gboolean dbd_print_found(const gchar *key, GVariant *value, gpointer user_data) {
+    gchar *output = svdb_variant_print(value, FALSE);
+
+    printf("%s=%s\n", key, output);
+    g_free(output);
+    return TRUE;
+}
+
+// Find keys by pattern, walking file hash table without parsing of whole file.
+static int dbd_find_keys(DbdCliInstance *instance) {
+    static const SvdbFindMode modes[] = {
+        [DBD_FIND_MODE_PREFIX] = SVDB_FIND_PREFIX,
+        [DBD_FIND_MODE_GLOB] = SVDB_FIND_GLOB,
+        [DBD_FIND_MODE_REGEX] = SVDB_FIND_REGEX,
+    };
+    GError *error = NULL;
+    const GVariantType *type = NULL;
+    GVariant *value = NULL;
+    SvdbFile *file;
+
+    if (instance->find_type) {
+        if (!g_variant_type_string_is_valid(instance->find_type)) {
+            printf("%s %s\n", "invalid GVariant type:", instance->find_type);
+            return -1;
+        }
+        type = G_VARIANT_TYPE(instance->find_type);
+    }
+
+    if (instance->find_value) {
+        value = g_variant_parse(type, instance->find_value, NULL, NULL, &error);
+        if (!value) {
+            printf("%s %s: %s\n", "invalid GVariant value:", instance->find_value, error->message);
+            g_error_free(error);
+            return -1;
+        }
+    }
+
+    file = svdb_file_new(instance->gvdb_file, FALSE, &error);
+
+    if (error || !file) {
+        printf("%s %s %s", "error while reading ", instance->gvdb_file, "\n");
+        if (error) {
+            g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        }
+        return -2;
+    }
+
+    svdb_file_find(file, instance->path, modes[instance->find_mode], type, value, dbd_print_found, NULL, &error);
+
+    if (error) {
+        g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        return -3;
+    }
+
+    if (value) {
+        g_variant_unref(value);
+    }
+    svdb_file_unref(file);
+    dbd_free_args(instance);
+    return 0;
+}
+
+// Print sorted differences between two files.
+static int dbd_diff_files(DbdCliInstance *instance) {
+    GError *error = NULL;
+    SvdbFile *files[2];
+    GPtrArray *entries;
+    const gchar *filenames[] = {instance->gvdb_file, instance->path};
+    int status;
+
+    if (!instance->path) {
+        printf("%s", dbd_get_help_for(DBD_INSTANCE_COMMAND_DIFF));
+        return -1;
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        files[i] = svdb_file_new(filenames[i], FALSE, &error);
+
+        if (error || !files[i]) {
+            printf("%s %s %s", "error while reading ", filenames[i], "\n");
+            if (error) {
+                g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+            }
+            return -2;
+        }
+    }
+
+    entries = svdb_diff(files[0], files[1], &error);
+
+    if (error) {
+        g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        return -3;
+    }
+
+    for (guint i = 0; i < entries->len; ++i) {
+        const SvdbDiffEntry *entry = g_ptr_array_index(entries, i);
+        dbd_print_change(entry->key, entry->kind, entry->old_value, entry->new_value, NULL);
+    }
+    status = entries->len ? 1 : 0;
+
+    g_ptr_array_unref(entries);
+    svdb_file_unref(files[1]);
+    svdb_file_unref(files[0]);
+    dbd_free_args(instance);
+    return status;
+}
 
 int main(int argc, const char** argv) {
     GError* error = NULL;
@@ -17,12 +206,47 @@ int main(int argc, const char** argv) {
         return -1;
     }
 
+    if (instance->command == DBD_INSTANCE_COMMAND_SCAN) {
+        return dbd_scan(instance);
+    }
+    if (instance->command == DBD_INSTANCE_COMMAND_SERVE) {
+        return dbd_serve(instance);
+    }
+
+    // Daemon answers read, list, dump and complete without loading of file (and reports nothing on errors).
+    if (!g_getenv("DBDCONF_NO_DAEMON")) {
+        int status;
+
+        if (dbd_serve_forward(instance, &status)) {
+            return status;
+        }
+    }
+
     if (!g_file_test(instance->gvdb_file, G_FILE_TEST_IS_REGULAR | G_FILE_TEST_EXISTS)) {
         printf("%s %s %s", "file ", instance->gvdb_file, " not found\n");
         return -2;
     }
 
-    table = svdb_table_read_from_file(instance->gvdb_file, FALSE, &error);
+    if (instance->format != DBD_FORMAT_DEFAULT) {
+        return dbd_print_records(instance);
+    }
+    if (instance->command == DBD_INSTANCE_COMMAND_READ) {
+        return dbd_read_key(instance);
+    }
+    if (instance->command == DBD_INSTANCE_COMMAND_FIND) {
+        return dbd_find_keys(instance);
+    }
+    if (instance->command == DBD_INSTANCE_COMMAND_WATCH) {
+        return dbd_watch(instance);
+    }
+    if (instance->command == DBD_INSTANCE_COMMAND_DIFF) {
+        return dbd_diff_files(instance);
+    }
+    if (instance->command == DBD_INSTANCE_COMMAND_COMPLETE) {
+        return dbd_complete_path(instance);
+    }
+
+    table = svdb_table_read_from_file_cached(instance->gvdb_file, NULL, &error);
 
     if (error || !table) {
         printf("%s %s %s", "error while reading ", instance->gvdb_file, "\n");
@@ -41,10 +265,6 @@ int main(int argc, const char** argv) {
             output = svdb_list_path(table, instance->path, &error);
             break;
         }
-        case DBD_INSTANCE_COMMAND_READ: {
-            output = svdb_read_path(table, instance->path, &error);
-            break;
-        }
     }
 
     if (error) {
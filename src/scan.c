@@ -0,0 +1,244 @@
+#include <scan.h>
+#include <svdb.h>
+#include <stdio.h>
+#include <glob.h>
+#include <glib/gstdio.h>
+
+// Files in flight per worker: bounds memory of buffered results, while workers don't wait for printing.
+#define DBD_SCAN_JOBS_PER_THREAD 4
+
+typedef struct DbdScanJob_t {
+    const gchar *filename;
+    // Result lines (already tagged by file).
+    GString *output;
+    GError *error;
+    // Set by printing thread, when job is popped from done queue.
+    gboolean done;
+} DbdScanJob;
+
+typedef struct DbdScan_t {
+    DbdCliInstance *instance;
+    const GVariantType *type;
+    GVariant *value;
+    // Finished jobs, in order of completion.
+    GAsyncQueue *done;
+} DbdScan;
+
+typedef struct DbdScanStats_t {
+    guint values;
+    guint dirs;
+    guint tables;
+} DbdScanStats;
+
+static gboolean dbd_scan_found(const gchar *key, GVariant *value, gpointer user_data) {
+    DbdScanJob *job = user_data;
+    gchar *output = svdb_variant_print(value, FALSE);
+
+    g_string_append_printf(job->output, "%s\t%s=%s\n", job->filename, key, output);
+    g_free(output);
+    return TRUE;
+}
+
+static SvdbVisitResult dbd_scan_count(SvdbVisitEvent event, const gchar *name, const gchar *key,
+                                      SvdbFileValue *value, gpointer user_data) {
+    DbdScanStats *stats = user_data;
+
+    switch (event) {
+        case SVDB_VISIT_ENTER_TABLE:
+            ++stats->tables;
+            break;
+        case SVDB_VISIT_ENTER_LIST:
+            ++stats->dirs;
+            break;
+        case SVDB_VISIT_VALUE:
+            ++stats->values;
+            break;
+        default:
+            break;
+    }
+    return SVDB_VISIT_CONTINUE;
+}
+
+static void dbd_scan_file(DbdScan *scan, DbdScanJob *job) {
+    static const SvdbFindMode modes[] = {
+        [DBD_FIND_MODE_PREFIX] = SVDB_FIND_PREFIX,
+        [DBD_FIND_MODE_GLOB] = SVDB_FIND_GLOB,
+        [DBD_FIND_MODE_REGEX] = SVDB_FIND_REGEX,
+    };
+    DbdCliInstance *instance = scan->instance;
+    DbdScanStats stats = {0};
+    GStatBuf st;
+    GVariant *value;
+    SvdbFile *file;
+
+    // Stats walk whole file, read and find are point lookups or skip most of it.
+    file = svdb_file_new_full(job->filename, FALSE,
+                              instance->scan_query == DBD_SCAN_QUERY_STATS ? SVDB_LOAD_SEQUENTIAL : SVDB_LOAD_RANDOM,
+                              &job->error);
+    if (!file) {
+        if (!job->error) {
+            g_set_error(&job->error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s: can't open file", job->filename);
+        }
+        return;
+    }
+
+    switch (instance->scan_query) {
+        case DBD_SCAN_QUERY_READ:
+            value = svdb_file_read(file, instance->path, &job->error);
+            if (value) {
+                gchar *output = svdb_variant_print(value, FALSE);
+
+                g_string_append_printf(job->output, "%s\t%s\n", job->filename, output);
+                g_free(output);
+                g_variant_unref(value);
+            }
+            break;
+        case DBD_SCAN_QUERY_FIND:
+            svdb_file_find(file, instance->path, modes[instance->find_mode], scan->type, scan->value,
+                           dbd_scan_found, job, &job->error);
+            break;
+        case DBD_SCAN_QUERY_STATS:
+            if (g_stat(job->filename, &st) == 0 && svdb_file_visit(file, dbd_scan_count, &stats, &job->error)) {
+                g_string_append_printf(job->output, "%s\tsize=%" G_GUINT64_FORMAT "\tvalues=%u\tdirs=%u\ttables=%u\n",
+                                       job->filename, (guint64) st.st_size, stats.values, stats.dirs, stats.tables);
+            }
+            break;
+    }
+
+    if (job->error) {
+        g_prefix_error(&job->error, "%s: ", job->filename);
+    }
+    svdb_file_unref(file);
+}
+
+static void dbd_scan_run(gpointer data, gpointer user_data) {
+    DbdScan *scan = user_data;
+
+    dbd_scan_file(scan, data);
+    g_async_queue_push(scan->done, data);
+}
+
+// Expand globs (patterns can be quoted, so long lists of files don't have to fit into command line).
+// Patterns without matched files are reported like unreadable files, and set failed.
+static GPtrArray *dbd_scan_expand(GPtrArray *patterns, gboolean *failed) {
+    GPtrArray *files = g_ptr_array_new_with_free_func(g_free);
+
+    for (guint i = 0; i < patterns->len; ++i) {
+        const gchar *pattern = g_ptr_array_index(patterns, i);
+        guint matched = files->len;
+        glob_t matches;
+        int status;
+
+        if (!strpbrk(pattern, "*?[")) {
+            g_ptr_array_add(files, g_strdup(pattern));
+            continue;
+        }
+
+        status = glob(pattern, 0, NULL, &matches);
+        if (status == 0) {
+            for (gsize j = 0; j < matches.gl_pathc; ++j) {
+                if (g_file_test(matches.gl_pathv[j], G_FILE_TEST_IS_REGULAR)) {
+                    g_ptr_array_add(files, g_strdup(matches.gl_pathv[j]));
+                }
+            }
+        }
+        globfree(&matches);
+
+        if (status != 0 && status != GLOB_NOMATCH) {
+            fprintf(stderr, "%s: %s\n", pattern, status == GLOB_NOSPACE ? "out of memory" : "read error");
+            *failed = TRUE;
+        } else if (files->len == matched) {
+            fprintf(stderr, "%s: %s\n", pattern, "no matching files");
+            *failed = TRUE;
+        }
+    }
+
+    return files;
+}
+
+static void dbd_scan_print(DbdScanJob *job) {
+    fputs(job->output->str, stdout);
+    if (job->error) {
+        fprintf(stderr, "%s\n", job->error->message);
+    }
+}
+
+int dbd_scan(DbdCliInstance *instance) {
+    DbdScan scan = {instance};
+    GError *error = NULL;
+    GThreadPool *pool;
+    GPtrArray *files;
+    DbdScanJob **window;
+    guint window_size, jobs, submitted = 0, printed = 0;
+    gboolean failed = FALSE;
+
+    if (!instance->scan_files || !instance->scan_files->len) {
+        printf("%s", dbd_get_help_for(DBD_INSTANCE_COMMAND_SCAN));
+        return -1;
+    }
+
+    if (instance->find_type) {
+        if (!g_variant_type_string_is_valid(instance->find_type)) {
+            printf("%s %s\n", "invalid GVariant type:", instance->find_type);
+            return -1;
+        }
+        scan.type = G_VARIANT_TYPE(instance->find_type);
+    }
+
+    if (instance->find_value) {
+        scan.value = g_variant_parse(scan.type, instance->find_value, NULL, NULL, &error);
+        if (!scan.value) {
+            printf("%s %s: %s\n", "invalid GVariant value:", instance->find_value, error->message);
+            g_error_free(error);
+            return -1;
+        }
+    }
+
+    files = dbd_scan_expand(instance->scan_files, &failed);
+    jobs = instance->scan_jobs ? instance->scan_jobs : g_get_num_processors();
+    window_size = jobs * DBD_SCAN_JOBS_PER_THREAD;
+    window = g_new0(DbdScanJob *, window_size);
+
+    scan.done = g_async_queue_new();
+    pool = g_thread_pool_new(dbd_scan_run, &scan, jobs, FALSE, NULL);
+
+    // Files are processed in pipeline: at most window_size files are in flight, and results are printed in order
+    // of files, so output doesn't depend on scheduling.
+    while (printed < files->len) {
+        DbdScanJob *job;
+
+        while (submitted < files->len && submitted - printed < window_size) {
+            job = g_new0(DbdScanJob, 1);
+            job->filename = g_ptr_array_index(files, submitted);
+            job->output = g_string_new(NULL);
+            window[submitted % window_size] = job;
+            g_thread_pool_push(pool, job, NULL);
+            ++submitted;
+        }
+
+        job = g_async_queue_pop(scan.done);
+        job->done = TRUE;
+
+        while (printed < submitted && window[printed % window_size]->done) {
+            job = window[printed % window_size];
+            dbd_scan_print(job);
+            failed |= job->error != NULL;
+
+            g_string_free(job->output, TRUE);
+            g_clear_error(&job->error);
+            g_free(job);
+            window[printed % window_size] = NULL;
+            ++printed;
+        }
+    }
+
+    g_thread_pool_free(pool, FALSE, TRUE);
+    g_async_queue_unref(scan.done);
+    g_free(window);
+    g_ptr_array_unref(files);
+    if (scan.value) {
+        g_variant_unref(scan.value);
+    }
+    dbd_free_args(instance);
+    return failed ? -2 : 0;
+}
@@ -0,0 +1,462 @@
+#include <serve.h>
+#include <complete.h>
+#include <svdb.h>
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <gio/gio.h>
+#include <glib-unix.h>
+#include <glib/gstdio.h>
+
+// Request is 'COMMAND\0ABSOLUTE_GVDB_PATH\0PATH\0' (client shuts down writing after it).
+// Response is 'STATUS\n' and then output of command, or '-\n', if client must run command locally.
+#define DBD_SERVE_FALLBACK "-\n"
+#define DBD_SERVE_MAX_REQUEST (PATH_MAX * 2 + 16)
+// Max count of cached files, cache is dropped at once on overflow.
+#define DBD_SERVE_MAX_ENTRIES 64
+#define DBD_SERVE_MAX_THREADS 8
+
+typedef struct DbdServeEntry_t {
+    gint refcount;
+    // File identity at load time, entry is reloaded when file is replaced or changed.
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    struct timespec ctime;
+    goffset size;
+    // For read (point lookups).
+    SvdbFile *file;
+    // Frozen table for list and dump (loaded on first request), so it can be read by many threads at once.
+    SvdbTableItem *table;
+} DbdServeEntry;
+
+typedef struct DbdServe_t {
+    GMainLoop *loop;
+    GMutex lock;
+    // Absolute file path => entry.
+    GHashTable *entries;
+} DbdServe;
+
+static const char *const dbd_serve_commands[] = {
+    [DBD_INSTANCE_COMMAND_READ] = "read",
+    [DBD_INSTANCE_COMMAND_LIST] = "list",
+    [DBD_INSTANCE_COMMAND_DUMP] = "dump",
+    [DBD_INSTANCE_COMMAND_COMPLETE] = "complete",
+};
+
+gchar *dbd_serve_socket_path(void) {
+    const gchar *path = g_getenv("DBDCONF_SOCKET");
+
+    if (path && *path) {
+        return g_strdup(path);
+    }
+    return g_build_filename(g_get_user_runtime_dir(), "dbdconf.sock", NULL);
+}
+
+static void dbd_serve_entry_unref(DbdServeEntry *entry) {
+    if (!g_atomic_int_dec_and_test(&entry->refcount)) {
+        return;
+    }
+    svdb_file_unref(entry->file);
+    svdb_item_unref(entry->table);
+    g_free(entry);
+}
+
+// Check if entry was loaded from file with this identity (times are compared in nanoseconds, so same-size rewrites
+// within one second are noticed).
+static gboolean dbd_serve_entry_is_actual(const DbdServeEntry *entry, const GStatBuf *st) {
+    return entry->dev == st->st_dev && entry->ino == st->st_ino && entry->size == st->st_size
+           && entry->mtime.tv_sec == st->st_mtim.tv_sec && entry->mtime.tv_nsec == st->st_mtim.tv_nsec
+           && entry->ctime.tv_sec == st->st_ctim.tv_sec && entry->ctime.tv_nsec == st->st_ctim.tv_nsec;
+}
+
+// Get actual entry of file (load or reload it, if needed).
+// Files are loaded without lock, so slow loads don't block requests to other (or already cached) files.
+static DbdServeEntry *dbd_serve_lookup(DbdServe *serve, const gchar *filename, gboolean need_table,
+                                       GError **error) {
+    DbdServeEntry *entry;
+    SvdbTableItem *table;
+    GStatBuf st;
+
+    if (g_stat(filename, &st) != 0 || !S_ISREG(st.st_mode)) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_NOENT, "%s: not a regular file", filename);
+        return NULL;
+    }
+
+    g_mutex_lock(&serve->lock);
+    entry = g_hash_table_lookup(serve->entries, filename);
+    if (entry && dbd_serve_entry_is_actual(entry, &st)) {
+        g_atomic_int_inc(&entry->refcount);
+    } else {
+        entry = NULL;
+    }
+    g_mutex_unlock(&serve->lock);
+
+    if (!entry) {
+        DbdServeEntry *cached;
+        SvdbFile *file = svdb_file_new(filename, FALSE, error);
+
+        if (!file) {
+            return NULL;
+        }
+
+        entry = g_new0(DbdServeEntry, 1);
+        entry->refcount = 1;
+        entry->dev = st.st_dev;
+        entry->ino = st.st_ino;
+        entry->mtime = st.st_mtim;
+        entry->ctime = st.st_ctim;
+        entry->size = st.st_size;
+        entry->file = file;
+
+        g_mutex_lock(&serve->lock);
+        cached = g_hash_table_lookup(serve->entries, filename);
+
+        // Other request could load the same file meanwhile.
+        if (cached && dbd_serve_entry_is_actual(cached, &st)) {
+            g_atomic_int_inc(&cached->refcount);
+            g_mutex_unlock(&serve->lock);
+            dbd_serve_entry_unref(entry);
+            entry = cached;
+        } else {
+            if (g_hash_table_size(serve->entries) >= DBD_SERVE_MAX_ENTRIES) {
+                g_hash_table_remove_all(serve->entries);
+            }
+            g_atomic_int_inc(&entry->refcount);
+            g_hash_table_insert(serve->entries, g_strdup(filename), entry);
+            g_mutex_unlock(&serve->lock);
+        }
+    }
+
+    if (!need_table) {
+        return entry;
+    }
+
+    g_mutex_lock(&serve->lock);
+    table = entry->table;
+    g_mutex_unlock(&serve->lock);
+
+    if (!table) {
+        SvdbTableItem *loaded = svdb_table_read_from_file_cached(filename, NULL, error);
+
+        if (!loaded) {
+            dbd_serve_entry_unref(entry);
+            return NULL;
+        }
+        table = svdb_tree_freeze(loaded);
+        svdb_item_unref(loaded);
+
+        g_mutex_lock(&serve->lock);
+        if (!entry->table) {
+            entry->table = table;
+            table = NULL;
+        }
+        g_mutex_unlock(&serve->lock);
+
+        if (table) {
+            svdb_item_unref(table);
+        }
+    }
+
+    return entry;
+}
+
+// Run command like local dbdconf does. Return output, or NULL if client must run command itself
+// (any error: local run prints it the usual way).
+static GString *dbd_serve_handle(DbdServe *serve, const gchar *command, const gchar *filename, const gchar *path) {
+    GError *error = NULL;
+    DbdServeEntry *entry;
+    GString *output = NULL;
+    GString *response;
+    gboolean is_read = strcmp(command, "read") == 0;
+    gboolean is_complete = strcmp(command, "complete") == 0;
+
+    if (!is_read && !is_complete && strcmp(command, "list") != 0 && strcmp(command, "dump") != 0) {
+        return NULL;
+    }
+
+    entry = dbd_serve_lookup(serve, filename, !is_read && !is_complete, &error);
+    if (!entry) {
+        g_clear_error(&error);
+        return NULL;
+    }
+
+    if (is_complete) {
+        output = dbd_complete(entry->file, path, &error);
+    } else if (is_read) {
+        GVariant *value = svdb_file_read(entry->file, path, &error);
+
+        if (value) {
+            gchar *printed = svdb_variant_print(value, FALSE);
+
+            output = g_string_new(printed);
+            g_free(printed);
+            g_variant_unref(value);
+        }
+    } else if (strcmp(command, "list") == 0) {
+        output = svdb_list_path(entry->table, path, &error);
+    } else {
+        output = svdb_dump_path(entry->table, path, &error);
+    }
+    dbd_serve_entry_unref(entry);
+
+    if (error) {
+        g_error_free(error);
+        if (output) {
+            g_string_free(output, TRUE);
+        }
+        return NULL;
+    }
+
+    response = g_string_new("0\n");
+    if (output) {
+        g_string_append_len(response, output->str, output->len);
+        // Completions are already one per line.
+        if (!is_complete) {
+            g_string_append_c(response, '\n');
+        }
+        g_string_free(output, TRUE);
+    }
+    return response;
+}
+
+static gboolean dbd_serve_run(GThreadedSocketService *service, GSocketConnection *connection,
+                              GObject *source_object, gpointer user_data) {
+    DbdServe *serve = user_data;
+    GSocket *socket = g_socket_connection_get_socket(connection);
+    GInputStream *input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
+    GOutputStream *output = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+    GCredentials *credentials;
+    GByteArray *request;
+    GString *response = NULL;
+    gchar buffer[4096];
+    gssize size;
+
+    // Socket directory is private, but requests of other users are rejected anyway: daemon reads files with its
+    // own permissions.
+    credentials = g_socket_get_credentials(socket, NULL);
+    if (!credentials || g_credentials_get_unix_user(credentials, NULL) != getuid()) {
+        g_clear_object(&credentials);
+        return TRUE;
+    }
+    g_object_unref(credentials);
+
+    request = g_byte_array_new();
+    while ((size = g_input_stream_read(input, buffer, sizeof buffer, NULL, NULL)) > 0
+           && request->len + size <= DBD_SERVE_MAX_REQUEST) {
+        g_byte_array_append(request, (const guint8 *) buffer, size);
+    }
+
+    if (size == 0 && request->len && request->data[request->len - 1] == '\0') {
+        const gchar *fields[3] = {NULL};
+        const gchar *end = (const gchar *) request->data + request->len;
+        const gchar *field = (const gchar *) request->data;
+        guint count = 0;
+
+        for (; field < end && count < G_N_ELEMENTS(fields); field += strlen(field) + 1) {
+            fields[count++] = field;
+        }
+
+        if (count == G_N_ELEMENTS(fields) && field == end && g_path_is_absolute(fields[1])) {
+            response = dbd_serve_handle(serve, fields[0], fields[1], *fields[2] ? fields[2] : NULL);
+        }
+    }
+    g_byte_array_unref(request);
+
+    if (response) {
+        g_output_stream_write_all(output, response->str, response->len, NULL, NULL, NULL);
+        g_string_free(response, TRUE);
+    } else {
+        g_output_stream_write_all(output, DBD_SERVE_FALLBACK, strlen(DBD_SERVE_FALLBACK), NULL, NULL, NULL);
+    }
+
+    return TRUE;
+}
+
+static gboolean dbd_serve_stop(gpointer user_data) {
+    g_main_loop_quit(user_data);
+    return G_SOURCE_REMOVE;
+}
+
+// Check, that some daemon answers on socket (else socket file is stale).
+static gboolean dbd_serve_is_running(const gchar *socket_path) {
+    GSocketClient *client = g_socket_client_new();
+    GSocketAddress *address = g_unix_socket_address_new(socket_path);
+    GSocketConnection *connection;
+
+    connection = g_socket_client_connect(client, G_SOCKET_CONNECTABLE(address), NULL, NULL);
+    g_object_unref(address);
+    g_object_unref(client);
+
+    if (!connection) {
+        return FALSE;
+    }
+    g_object_unref(connection);
+    return TRUE;
+}
+
+int dbd_serve(DbdCliInstance *instance) {
+    GError *error = NULL;
+    GSocketService *service;
+    GSocketAddress *address;
+    static DbdServe serve;
+    gchar *socket_path = dbd_serve_socket_path();
+    GStatBuf st;
+
+    if (dbd_serve_is_running(socket_path)) {
+        printf("%s %s\n", "daemon is already running on", socket_path);
+        g_free(socket_path);
+        return -1;
+    }
+
+    // Socket path can come from environment, so only stale socket is removed, never other files.
+    if (g_lstat(socket_path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            printf("%s %s\n", "not a socket, refusing to replace:", socket_path);
+            g_free(socket_path);
+            return -1;
+        }
+        g_unlink(socket_path);
+    }
+
+    service = g_threaded_socket_service_new(DBD_SERVE_MAX_THREADS);
+    address = g_unix_socket_address_new(socket_path);
+
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service), address, G_SOCKET_TYPE_STREAM,
+                                       G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &error)) {
+        printf("%s %s: %s\n", "can't listen on", socket_path, error->message);
+        g_error_free(error);
+        g_object_unref(address);
+        g_object_unref(service);
+        g_free(socket_path);
+        return -2;
+    }
+    g_object_unref(address);
+    g_chmod(socket_path, 0600);
+
+    g_mutex_init(&serve.lock);
+    serve.entries = g_hash_table_new_full(&g_str_hash, &g_str_equal, &g_free,
+                                          (GDestroyNotify) &dbd_serve_entry_unref);
+    serve.loop = g_main_loop_new(NULL, FALSE);
+
+    g_signal_connect(service, "run", G_CALLBACK(dbd_serve_run), &serve);
+    g_unix_signal_add(SIGINT, dbd_serve_stop, serve.loop);
+    g_unix_signal_add(SIGTERM, dbd_serve_stop, serve.loop);
+
+    g_socket_service_start(service);
+    g_main_loop_run(serve.loop);
+    g_socket_service_stop(service);
+    g_socket_listener_close(G_SOCKET_LISTENER(service));
+    g_object_unref(service);
+
+    // Handlers, which are still queued or running in thread pool, may use state, so it isn't freed (it's static,
+    // and process exits right after).
+    g_unlink(socket_path);
+    g_free(socket_path);
+    dbd_free_args(instance);
+    return 0;
+}
+
+static gboolean dbd_serve_write_all(int fd, const gchar *data, gsize size) {
+    while (size) {
+        gssize written = write(fd, data, size);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return FALSE;
+        }
+        data += written;
+        size -= written;
+    }
+    return TRUE;
+}
+
+// Client uses plain syscalls: it runs for every command, so it doesn't initialize GObject types.
+gboolean dbd_serve_forward(DbdCliInstance *instance, int *status) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    char filename[PATH_MAX];
+    char header[16];
+    char buffer[65536];
+    gchar *socket_path;
+    GString *request;
+    gsize header_length = 0;
+    gssize size;
+    gboolean sent;
+    int fd;
+
+    // Raw values and records are written right from local mapping, daemon would only add copy through socket.
+    if (instance->command >= G_N_ELEMENTS(dbd_serve_commands) || !dbd_serve_commands[instance->command]
+        || instance->read_raw || instance->format != DBD_FORMAT_DEFAULT || !instance->gvdb_file || !realpath(instance->gvdb_file, filename)) {
+        return FALSE;
+    }
+
+    socket_path = dbd_serve_socket_path();
+    if (strlen(socket_path) >= sizeof address.sun_path) {
+        g_free(socket_path);
+        return FALSE;
+    }
+    strcpy(address.sun_path, socket_path);
+    g_free(socket_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return FALSE;
+    }
+    if (connect(fd, (struct sockaddr *) &address, sizeof address) != 0) {
+        close(fd);
+        return FALSE;
+    }
+
+    request = g_string_new(dbd_serve_commands[instance->command]);
+    g_string_append_c(request, '\0');
+    g_string_append(request, filename);
+    g_string_append_c(request, '\0');
+    g_string_append(request, instance->path ? instance->path : "");
+    g_string_append_c(request, '\0');
+
+    sent = dbd_serve_write_all(fd, request->str, request->len);
+    g_string_free(request, TRUE);
+    if (!sent || shutdown(fd, SHUT_WR) != 0) {
+        close(fd);
+        return FALSE;
+    }
+
+    // Nothing is printed until status is received, so client can still fall back to local run.
+    while (header_length < sizeof header - 1) {
+        size = read(fd, header + header_length, 1);
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0 || header[header_length] == '\n') {
+            break;
+        }
+        ++header_length;
+    }
+    header[header_length] = '\0';
+
+    if (size <= 0 || header_length == 0 || header[0] == '-') {
+        close(fd);
+        return FALSE;
+    }
+    *status = atoi(header);
+
+    while ((size = read(fd, buffer, sizeof buffer)) != 0) {
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        fwrite(buffer, 1, size, stdout);
+    }
+
+    close(fd);
+    dbd_free_args(instance);
+    return TRUE;
+}
@@ -0,0 +1,160 @@
+#include <watch.h>
+#include <svdb.h>
+#include <stdio.h>
+#include <glib-unix.h>
+
+// Writers replace file by several events (create temp, write, rename), so reload after events settle.
+#define DBD_WATCH_SETTLE_MS 50
+
+typedef struct DbdWatch_t {
+    const gchar *filename;
+    GMainLoop *loop;
+    SvdbFile *current;
+    guint reload_source;
+} DbdWatch;
+
+gboolean dbd_print_change(const gchar *key, SvdbDiffKind kind, GVariant *old_value, GVariant *new_value,
+                          gpointer user_data) {
+    gchar *output;
+
+    switch (kind) {
+        case SVDB_DIFF_ADDED:
+            output = svdb_variant_print(new_value, FALSE);
+            printf("added\t%s\t%s\n", key, output);
+            g_free(output);
+            break;
+        case SVDB_DIFF_REMOVED:
+            printf("removed\t%s\n", key);
+            break;
+        case SVDB_DIFF_CHANGED:
+            output = svdb_variant_print(new_value, FALSE);
+            printf("changed\t%s\t%s\n", key, output);
+            g_free(output);
+            break;
+    }
+
+    return TRUE;
+}
+
+// Load file content into memory: file can be rewritten in place, so mapping of old file isn't stable.
+static SvdbFile *dbd_watch_load(const gchar *filename, GError **error) {
+    gchar *contents;
+    gsize length;
+    SvdbFile *file;
+    GBytes *bytes;
+
+    if (!g_file_get_contents(filename, &contents, &length, error)) {
+        return NULL;
+    }
+
+    bytes = g_bytes_new_take(contents, length);
+    file = svdb_file_new_from_bytes(bytes, FALSE, error);
+    g_bytes_unref(bytes);
+
+    return file;
+}
+
+static gboolean dbd_watch_reload(gpointer user_data) {
+    DbdWatch *watch = user_data;
+    GError *error = NULL;
+    SvdbFile *file = NULL;
+
+    watch->reload_source = 0;
+
+    // Missing file is empty database: all keys are removed.
+    if (g_file_test(watch->filename, G_FILE_TEST_EXISTS)) {
+        file = dbd_watch_load(watch->filename, &error);
+
+        if (!file) {
+            // File is partially written or corrupted, wait for next change.
+            fprintf(stderr, "%s\n", error ? error->message : "error while reading file");
+            g_clear_error(&error);
+            return G_SOURCE_REMOVE;
+        }
+    }
+
+    if (!svdb_file_diff(watch->current, file, dbd_print_change, NULL, &error)) {
+        fprintf(stderr, "%s\n", error ? error->message : "error while comparing files");
+        g_clear_error(&error);
+    }
+    fflush(stdout);
+
+    if (watch->current) {
+        svdb_file_unref(watch->current);
+    }
+    watch->current = file;
+
+    return G_SOURCE_REMOVE;
+}
+
+static void dbd_watch_changed(GFileMonitor *monitor, GFile *file, GFile *other_file, GFileMonitorEvent event_type,
+                              gpointer user_data) {
+    DbdWatch *watch = user_data;
+
+    switch (event_type) {
+        // CHANGED is followed by CHANGES_DONE_HINT, ATTRIBUTE_CHANGED doesn't change content.
+        case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+        case G_FILE_MONITOR_EVENT_CREATED:
+        case G_FILE_MONITOR_EVENT_DELETED:
+        // With G_FILE_MONITOR_WATCH_MOVES rename of temp file over watched one (dconf way of writing) is reported
+        // as RENAMED/MOVED_IN, and not as DELETED + CREATED.
+        case G_FILE_MONITOR_EVENT_RENAMED:
+        case G_FILE_MONITOR_EVENT_MOVED_IN:
+        case G_FILE_MONITOR_EVENT_MOVED_OUT:
+            if (!watch->reload_source) {
+                watch->reload_source = g_timeout_add(DBD_WATCH_SETTLE_MS, dbd_watch_reload, watch);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static gboolean dbd_watch_quit(gpointer user_data) {
+    g_main_loop_quit(user_data);
+    return G_SOURCE_CONTINUE;
+}
+
+int dbd_watch(DbdCliInstance *instance) {
+    DbdWatch watch = {0};
+    GError *error = NULL;
+    GFileMonitor *monitor;
+    GFile *file;
+
+    watch.filename = instance->gvdb_file;
+    watch.current = dbd_watch_load(instance->gvdb_file, &error);
+
+    if (error || !watch.current) {
+        printf("%s %s %s", "error while reading ", instance->gvdb_file, "\n");
+        if (error) {
+            g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        }
+        return -2;
+    }
+
+    file = g_file_new_for_path(instance->gvdb_file);
+    monitor = g_file_monitor_file(file, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+    g_object_unref(file);
+
+    if (!monitor) {
+        g_log (G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s", error->message);
+        return -3;
+    }
+
+    watch.loop = g_main_loop_new(NULL, FALSE);
+    g_signal_connect(monitor, "changed", G_CALLBACK(dbd_watch_changed), &watch);
+    g_unix_signal_add(SIGINT, dbd_watch_quit, watch.loop);
+    g_unix_signal_add(SIGTERM, dbd_watch_quit, watch.loop);
+
+    g_main_loop_run(watch.loop);
+
+    if (watch.reload_source) {
+        g_source_remove(watch.reload_source);
+    }
+    g_file_monitor_cancel(monitor);
+    g_object_unref(monitor);
+    g_main_loop_unref(watch.loop);
+    svdb_file_unref(watch.current);
+    dbd_free_args(instance);
+    return 0;
+}